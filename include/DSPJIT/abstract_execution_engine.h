@@ -2,8 +2,14 @@
 #define DSPJIT_ABSTRACT_EXECUTION_ENGINE_H_
 
 #include <memory>
+#include <vector>
 
+#include <llvm/ExecutionEngine/ObjectCache.h>
 #include <llvm/IR/Module.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Target/TargetMachine.h>
+
+#include "code_memory_pool.h"
 
 namespace DSPJIT
 {
@@ -16,6 +22,24 @@ namespace DSPJIT
         virtual ~abstract_execution_engine() noexcept = default;
 
         virtual void add_module(std::unique_ptr<llvm::Module>&& module) = 0;
+
+        /**
+         * \brief Add a module whose external symbols can be used by the modules added afterward
+         * \note Shared modules must not define the same symbols. They are deleted using delete_module
+         */
+        virtual void add_shared_module(std::unique_ptr<llvm::Module>&& module) = 0;
+
+        /**
+         * \brief Add a module whose native code was generated out of the engine
+         * \details The module is not compiled : it only identifies its native code for get_function_pointer,
+         * add_global_mapping and delete_module. The objects are loaded by emit_native_code
+         * \param module the module from which the objects were generated
+         * \param objects the module native code, as object files which can reference each other symbols
+         */
+        virtual void add_compiled_module(
+            std::unique_ptr<llvm::Module>&& module,
+            std::vector<std::unique_ptr<llvm::MemoryBuffer>>&& objects) = 0;
+
         virtual void delete_module(llvm::Module* module) = 0;
 
         /**
@@ -29,6 +53,35 @@ namespace DSPJIT
          * \param function the function to look for
          */
         virtual void* get_function_pointer(llvm::Function* function) =0;
+
+        /**
+         * \brief Bind an external global symbol to an address
+         * \param global the global declaration, whose module was added to the engine and is not yet emitted
+         * \param address the address the symbol must resolve to
+         */
+        virtual void add_global_mapping(llvm::GlobalValue* global, void *address) = 0;
+
+        /**
+         * \brief Set the object cache used to reuse previously generated native code
+         * \details Objects are looked up and stored using the modules identifiers
+         * \param cache the cache, null to disable caching. Must outlive the engine
+         */
+        virtual void set_object_cache(llvm::ObjectCache *cache) = 0;
+
+        /**
+         * \brief Return the target machine used to generate native code, which also describes the target to the IR optimizations
+         */
+        virtual llvm::TargetMachine& get_target_machine() = 0;
+
+        /**
+         * \brief Return the total size of the native code and data sections loaded by the engine since its creation
+         */
+        virtual std::size_t get_native_code_size() const noexcept = 0;
+
+        /**
+         * \brief Return the memory currently used to store the native code and data
+         */
+        virtual code_memory_pool::usage get_native_memory_usage() const = 0;
     };
 }
 
@@ -1,6 +1,11 @@
 #ifndef DSPJIT_ABSTRACT_MEMORY_MANAGER_H_
 #define DSPJIT_ABSTRACT_MEMORY_MANAGER_H_
 
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include <DSPJIT/compile_node_class.h>
 #include <DSPJIT/abstract_node_state.h>
 #include <DSPJIT/abstract_execution_engine.h>
@@ -11,11 +16,13 @@ namespace DSPJIT
     {
     public:
         using compile_sequence_t = uint32_t;
+        using symbol_map = std::map<std::string, void*>;
 
         virtual ~abstract_graph_memory_manager() noexcept = default;
 
         /**
          * \brief Functions used to initialize nodes states
+         * \details signature = void _(int64 instance_num, int8 **region_table)
          */
         struct initialize_functions
         {
@@ -23,6 +30,15 @@ namespace DSPJIT
             llvm::Function* initialize_new_nodes{nullptr};
         };
 
+        /**
+         * \brief Node states changes of a finished sequence
+         */
+        struct sequence_statistics
+        {
+            std::size_t new_state_count{0u};        ///< states created for the nodes added in the sequence
+            std::size_t deleted_state_count{0u};    ///< states of the nodes removed in the sequence, deleted once the sequence is used
+        };
+
         /**
          * \brief notify the state manager that a new compilation sequence begins
          * \param seq the new sequence number. Must be greater than the previous ones
@@ -43,6 +59,45 @@ namespace DSPJIT
             abstract_execution_engine& execution_engine,
             llvm::Module& module) = 0;
 
+        /**
+         * \brief Bind the symbols referenced by the finished sequence code (states, static memory) to their addresses
+         * \note must be called once the sequence module was added to the execution engine, before native code emission
+         * \param execution_engine the execution engine on which the sequence module was added
+         */
+        virtual void resolve_sequence_symbols(abstract_execution_engine& execution_engine) = 0;
+
+        /**
+         * \brief Return the symbols referenced by the finished sequence code, with their addresses
+         * \note Used to compile the sequence code again, in another module
+         */
+        virtual symbol_map get_sequence_symbols() const = 0;
+
+        /**
+         * \brief Return the addresses of the memory regions referenced by the finished sequence code through its region table,
+         * in table order. Empty if the sequence code references them through symbols
+         * \note The table must be given to the sequence functions, and must live as long as they are used
+         */
+        virtual std::vector<void*> get_sequence_region_table() const = 0;
+
+        /**
+         * \brief Return the node states changes of the finished sequence
+         */
+        virtual sequence_statistics get_sequence_statistics() const = 0;
+
+        /**
+         * \brief Define the symbols referenced by the finished sequence code in its module, as internal globals,
+         * so that the module does not depend on the memory manager anymore : states are zero initialized
+         * and static memory chunks are copied
+         * \note The sequence symbols can not be resolved anymore
+         */
+        virtual void define_sequence_symbols(llvm::Module& module) = 0;
+
+        /**
+         * \brief Create a memory manager with the same settings and a copy of the static memory chunks, but without node state
+         * \note The clone references the memory through symbols, so that they can be defined (see define_sequence_symbols)
+         */
+        virtual std::unique_ptr<abstract_graph_memory_manager> clone_without_states() const = 0;
+
         /**
          * \brief notify the state manager that the program generated at a given sequence is now being executed.
          * \note the state manager will free all unused nodes states. Can only be called on a finished compilation sequence
@@ -50,6 +105,42 @@ namespace DSPJIT
          */
         virtual void using_sequence(const compile_sequence_t seq) = 0;
 
+        /**
+         * \brief notify the state manager that the program generated at a given sequence will never be executed
+         * \details The sequence program is deleted. The states it stopped using are kept until a newer program is executed,
+         * as the running program can still use them
+         * \param seq a finished sequence, newer than the running one
+         */
+        virtual void discard_sequence(const compile_sequence_t seq) = 0;
+
+        /**
+         * \brief notify the state manager that the current sequence was cancelled before its program was emitted
+         * \details The states created by the sequence are deleted, as they were never initialized. The states it
+         * stopped using are kept until a newer program is executed
+         * \note Can only be called on a finished sequence whose module was not added to the execution engine
+         */
+        virtual void cancel_sequence() = 0;
+
+        /**
+         * \brief Keep the states used by the current sequence, even when the nodes are not used anymore
+         * \details Used to keep a program which can be published again without being compiled
+         * \note Can only be called on a finished compilation sequence
+         * \return the nodes whose states are pinned, to be given to unpin_states
+         */
+        virtual std::vector<const compile_node_class*> pin_sequence_states() = 0;
+
+        /**
+         * \brief Release the states pinned by pin_sequence_states
+         * \details The states of the nodes which are not used anymore are deleted as if they stopped being used by the next sequence
+         */
+        virtual void unpin_states(const std::vector<const compile_node_class*>& nodes) = 0;
+
+        /**
+         * \brief Do not delete the current sequence module with the sequence, as it is owned by the caller
+         * \note Can only be called on a finished compilation sequence
+         */
+        virtual void release_sequence_module() = 0;
+
         /**
          * \brief return a reference to the stored node's state. State is created if it doesn't exist
          * \param node the node whose state is needed
@@ -61,6 +152,8 @@ namespace DSPJIT
 
         /**
          * \brief Set data used for static memory
+         * \note Static memory chunks are not changed while a graph is translated to IR code, but can be changed from
+         * another thread while the sequence is finished and published (see compile_service)
          */
         virtual void register_static_memory_chunk(const compile_node_class& node, std::vector<uint8_t>&& chunk) = 0;
 
@@ -75,6 +168,39 @@ namespace DSPJIT
          */
         virtual llvm::Value *get_static_memory_ref(llvm::IRBuilder<>& builder, const compile_node_class& node) = 0;
 
+        /**
+         * \brief Return a pointer to a memory area which is not owned by the manager, such as a parameter block.
+         * It is referenced like the states, so that the generated code does not depend on its address
+         * \param address the area address, which must stay valid while a program using it can run
+         * \param size the area size, in bytes
+         */
+        virtual llvm::Value *get_memory_region_ref(llvm::IRBuilder<>& builder, const void *address, std::size_t size) = 0;
+
+        /**
+         * \brief Start a memory region scope : until the scope is popped, states and static memory are referenced
+         * through a table of pointers instead of symbols. This is used to compile code which does not depend on
+         * the memory location, in a separate function
+         * \param region_table the table (i8**) value in the function being compiled. Regions are indexed
+         * in their order of first use in the scope
+         */
+        virtual void push_memory_region_scope(llvm::Value *region_table) = 0;
+
+        /**
+         * \brief Set the region table (i8**) argument of the sequence function being compiled
+         * \details If the memory manager uses a sequence region table, states and static memory are referenced through
+         * this table in the function code, at the index given by get_sequence_region_table. Else this does nothing.
+         * \note Must be called before compiling a sequence function, outside of any memory region scope.
+         * The initialize functions set their own table
+         */
+        virtual void set_sequence_region_table(llvm::Value *region_table) = 0;
+
+        /**
+         * \brief End the current memory region scope
+         * \param builder the builder used to emit the caller code, after the scope was pushed
+         * \return the table to be given to the function compiled in the scope, as a value in the caller code
+         */
+        virtual llvm::Value *pop_memory_region_scope(llvm::IRBuilder<>& builder) = 0;
+
         virtual llvm::LLVMContext& get_llvm_context() const noexcept = 0;
         virtual std::size_t get_instance_count() const noexcept = 0;
     };
@@ -20,6 +20,8 @@ namespace DSPJIT
 
         /**
          * \brief Return a pointer to the node cycle resolving state as a llvm::Value
+         * \note The cycle states of consecutive instances are contiguous floats, so that several
+         * instances can be accessed at once with a vector load/store from the first instance state.
          */
         virtual llvm::Value *get_cycle_state_ptr(
             llvm::IRBuilder<> &builder,
@@ -28,6 +30,7 @@ namespace DSPJIT
 
         /**
          * \brief Return a pointer to the node mutable state, null if the node is stateless
+         * \note The mutable states of consecutive instances are contiguous (stride = state size)
          */
         virtual llvm::Value *get_mutable_state_ptr(
             llvm::IRBuilder<> &builder,
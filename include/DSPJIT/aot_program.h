@@ -0,0 +1,183 @@
+#ifndef DSPJIT_AOT_PROGRAM_H_
+#define DSPJIT_AOT_PROGRAM_H_
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+namespace DSPJIT {
+
+    /**
+     * \class aot_program
+     * \brief Load and run a program exported as a shared library by graph_execution_context::export_program
+     * \details The program can be run with the same semantic than a graph_execution_context program :
+     * in particular, the inputs and outputs arrays must not overlap.
+     * This loader is header only and does not depend on llvm, so that it can be used by applications
+     * which do not embed the JIT compiler.
+     * On x86-64, the best process function variant supported by the cpu is run
+     * (see graph_execution_context::set_process_variants).
+     */
+    class aot_program {
+
+        using native_process_func = void (*)(std::size_t instance_num, const float *inputs, float *outputs, std::size_t frame_count);
+        using native_initialize_func = void (*)(std::size_t instance_num);
+        using native_count_func = std::size_t (*)();
+
+    public:
+        /**
+         * \brief Load a program and initialize the states of all its instances
+         * \param path the shared library path
+         * \throw std::runtime_error if the library cannot be loaded or is not an exported program
+         */
+        explicit aot_program(const std::string& path)
+        {
+#ifdef _WIN32
+            _handle = LoadLibraryA(path.c_str());
+#else
+            _handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+#endif
+            if (_handle == nullptr)
+                throw std::runtime_error("aot_program: Failed to load " + path);
+
+            try {
+                _process_func = _get_process_symbol();
+                _initialize_func = _get_symbol<native_initialize_func>("graph__initialize");
+                _instance_count = _get_symbol<native_count_func>("graph__get_instance_count")();
+                _input_count = _get_symbol<native_count_func>("graph__get_input_count")();
+                _output_count = _get_symbol<native_count_func>("graph__get_output_count")();
+            }
+            catch (...) {
+                _close();
+                throw;
+            }
+
+            for (auto i = 0u; i < _instance_count; ++i)
+                _initialize_func(i);
+        }
+
+        aot_program(const aot_program&) = delete;
+        aot_program(aot_program&&) = delete;
+
+        ~aot_program() noexcept { _close(); }
+
+        /**
+         * \brief Return the number of instance this program can run
+         */
+        std::size_t get_instance_count() const noexcept { return _instance_count; }
+
+        /**
+         * \brief Return the number of input values of a frame
+         */
+        std::size_t get_input_count() const noexcept { return _input_count; }
+
+        /**
+         * \brief Return the number of output values of a frame
+         */
+        std::size_t get_output_count() const noexcept { return _output_count; }
+
+        /**
+         * \brief Run the program using the graph state indexed by instance_num
+         * \param instance_num state instance to be used
+         * \param inputs input values
+         * \param outputs output values
+         */
+        void process(std::size_t instance_num, const float *inputs, float *outputs) noexcept
+        {
+            _process_func(instance_num, inputs, outputs, 1u);
+        }
+
+        /**
+         * \brief Run the program using the default graph state
+         * \param inputs input values
+         * \param outputs output values
+         */
+        void process(const float *inputs, float *outputs) noexcept {   process(0u, inputs, outputs);   }
+
+        /**
+         * \brief Run the program on several consecutive frames using the graph state indexed by instance_num
+         * \param instance_num state instance to be used
+         * \param inputs input values, frame by frame : inputs of frame n start at inputs + n * input_count
+         * \param outputs output values, frame by frame : outputs of frame n start at outputs + n * output_count
+         * \param frame_count number of frames to be processed
+         */
+        void process_block(std::size_t instance_num, const float *inputs, float *outputs, std::size_t frame_count) noexcept
+        {
+            _process_func(instance_num, inputs, outputs, frame_count);
+        }
+
+        /**
+         * \brief Initialize the graph state indexed by instance_num
+         * \param instance_num state instance to be used
+         */
+        void initialize_state(std::size_t instance_num = 0u) noexcept
+        {
+            _initialize_func(instance_num);
+        }
+
+    private:
+        void *_find_symbol(const char *symbol) const noexcept
+        {
+#ifdef _WIN32
+            return reinterpret_cast<void*>(GetProcAddress(static_cast<HMODULE>(_handle), symbol));
+#else
+            return dlsym(_handle, symbol);
+#endif
+        }
+
+        template <typename TFunc>
+        TFunc _get_symbol(const char *symbol)
+        {
+            auto address = _find_symbol(symbol);
+            if (address == nullptr)
+                throw std::runtime_error(std::string{"aot_program: Missing symbol "} + symbol);
+
+            return reinterpret_cast<TFunc>(address);
+        }
+
+        native_process_func _get_process_symbol()
+        {
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+            //  From the most specific variant to the most generic one
+            const std::pair<const char*, bool> variants[] = {
+                {"graph__process__x86_64_v4", __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+                                              __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl")},
+                {"graph__process__x86_64_v3", __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") &&
+                                              __builtin_cpu_supports("bmi2")},
+                {"graph__process__x86_64_v2", __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt")}
+            };
+
+            for (const auto& variant : variants) {
+                auto address = variant.second ? _find_symbol(variant.first) : nullptr;
+                if (address != nullptr)
+                    return reinterpret_cast<native_process_func>(address);
+            }
+#endif
+            return _get_symbol<native_process_func>("graph__process");
+        }
+
+        void _close() noexcept
+        {
+#ifdef _WIN32
+            FreeLibrary(static_cast<HMODULE>(_handle));
+#else
+            dlclose(_handle);
+#endif
+        }
+
+        void *_handle{nullptr};
+        native_process_func _process_func{nullptr};
+        native_initialize_func _initialize_func{nullptr};
+        std::size_t _instance_count{0u};
+        std::size_t _input_count{0u};
+        std::size_t _output_count{0u};
+    };
+}
+
+#endif /* DSPJIT_AOT_PROGRAM_H_ */
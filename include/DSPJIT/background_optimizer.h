@@ -0,0 +1,127 @@
+#ifndef DSPJIT_BACKGROUND_OPTIMIZER_H_
+#define DSPJIT_BACKGROUND_OPTIMIZER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "abstract_execution_engine.h"
+#include "abstract_graph_memory_manager.h"
+#include "lock_free_queue.h"
+#include "optimization_pipeline.h"
+
+namespace DSPJIT {
+
+    /**
+     * \class background_optimizer
+     * \brief Optimize and compile programs to native code on a background thread (second compilation tier)
+     * \details The compile thread submits the unoptimized IR code of each program it publishes. The background thread
+     * compiles it again with full optimization, in its own llvm context and execution engine, and publishes the
+     * optimized program to the process thread, which swaps it in if it is still running the same sequence.
+     * A job is cancelled as soon as a newer sequence starts.
+     */
+    class background_optimizer {
+
+    public:
+        using compile_sequence_t = abstract_graph_memory_manager::compile_sequence_t;
+        using execution_engine_builder = std::function<std::unique_ptr<abstract_execution_engine>(llvm::LLVMContext&)>;
+
+        /**
+         * \brief A program to be optimized
+         */
+        struct job {
+            compile_sequence_t seq;
+            std::string bitcode;                            ///< the program module bitcode
+            abstract_graph_memory_manager::symbol_map symbols;  ///< addresses of the module external symbols (states, ...)
+            std::string process_symbol;
+            std::string process_vector_symbol;              ///< empty if there is no vector process function
+            std::string initialize_symbol;
+            optimization_pipeline pipeline;
+        };
+
+        /**
+         * \brief An optimized program
+         */
+        struct program {
+            compile_sequence_t seq;
+            void *process_func;
+            void *process_vector_func;                      ///< null if there is no vector process function
+            void *initialize_func;
+        };
+
+        /**
+         * \param engine_builder create the execution engine used for optimized programs, in the background thread llvm context
+         */
+        explicit background_optimizer(execution_engine_builder engine_builder);
+
+        background_optimizer(const background_optimizer&) = delete;
+        background_optimizer(background_optimizer&&) = delete;
+        ~background_optimizer() noexcept;
+
+        /*********************************************
+         *   Compile Thread API
+         *********************************************/
+
+        /**
+         * \brief Notify that a new sequence begins : jobs of previous sequences are cancelled
+         */
+        void begin_sequence(compile_sequence_t seq) noexcept;
+
+        /**
+         * \brief Submit a program to be optimized. Replace the pending job, if any
+         */
+        void submit(job&& job);
+
+        /*********************************************
+         *   Process Thread API
+         *********************************************/
+
+        /**
+         * \brief Get the optimized version of the running program, if available
+         * \param running_seq the sequence of the program being run
+         * \param program the optimized program
+         * \return true if an optimized program was available for running_seq
+         */
+        bool get_optimized_program(compile_sequence_t running_seq, program& program) noexcept;
+
+        /**
+         * \brief Notify that the program generated at a given sequence is now being executed :
+         * optimized programs of older sequences can be deleted
+         */
+        void using_sequence(compile_sequence_t seq) noexcept;
+
+    private:
+        void _thread_main();
+        std::optional<program> _compile(const job& job);
+        bool _is_cancelled(const job& job) const noexcept;
+
+        //  Compile thread -> background thread
+        std::mutex _job_mutex{};
+        std::condition_variable _job_condition{};
+        std::optional<job> _pending_job{};
+        bool _running{true};
+        std::atomic<compile_sequence_t> _latest_sequence{0u};
+
+        //  Background thread -> process thread
+        lock_free_queue<program> _program_queue;
+        std::optional<program> _available_program{};       ///< only used by the process thread
+
+        //  Process thread -> background thread
+        lock_free_queue<compile_sequence_t> _ack_queue;
+
+        //  Only used by the background thread
+        std::unique_ptr<llvm::LLVMContext> _llvm_context;
+        std::unique_ptr<abstract_execution_engine> _execution_engine;
+        std::map<compile_sequence_t, llvm::Module*> _modules{};   ///< optimized programs modules, by sequence
+
+        std::thread _thread{};
+    };
+}
+
+#endif /* DSPJIT_BACKGROUND_OPTIMIZER_H_ */
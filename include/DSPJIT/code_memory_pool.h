@@ -0,0 +1,98 @@
+#ifndef DSPJIT_CODE_MEMORY_POOL_H_
+#define DSPJIT_CODE_MEMORY_POOL_H_
+
+#include <array>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include <llvm/Support/Memory.h>
+
+namespace DSPJIT
+{
+
+    /**
+     * \class code_memory_pool
+     * \brief Memory pool from which the native code and data sections are allocated
+     * \details Memory is reserved by large regions, which are kept until the pool is destroyed. The blocks
+     * released when a module is deleted are reused by the next allocations, so that the code of the successive
+     * sequences stays packed in a few regions instead of being scattered accross the address space.
+     * Code can be backed by (transparent) huge pages : as changing the protection of a part of a huge page splits it,
+     * code regions are then mapped readable, writable and executable once for all.
+     * \note Thread safe
+     */
+    class code_memory_pool
+    {
+    public:
+        enum class section_kind {
+            code,
+            read_only_data,
+            read_write_data
+        };
+
+        /**
+         * \brief Memory used by the pool
+         */
+        struct usage {
+            std::size_t reserved_size{0u};  ///< size of the regions reserved from the system
+            std::size_t used_size{0u};      ///< size of the allocated blocks
+        };
+
+        /**
+         * \param use_huge_pages back code regions with 2MB huge pages (only supported on linux, ignored elsewhere)
+         */
+        explicit code_memory_pool(bool use_huge_pages = false);
+
+        code_memory_pool(const code_memory_pool&) = delete;
+        code_memory_pool(code_memory_pool&&) = delete;
+        ~code_memory_pool() noexcept;
+
+        /**
+         * \brief Allocate a writable page aligned block
+         * \param kind the kind of the sections that will be stored in the block
+         * \param size the minimum block size
+         */
+        llvm::sys::MemoryBlock allocate(section_kind kind, std::size_t size);
+
+        /**
+         * \brief Apply the final protection of a block, once its content was written
+         */
+        void protect(section_kind kind, const llvm::sys::MemoryBlock& block);
+
+        /**
+         * \brief Release a block, which can be reused by the next allocations
+         */
+        void release(section_kind kind, const llvm::sys::MemoryBlock& block);
+
+        usage get_usage() const;
+
+        bool use_huge_pages() const noexcept { return _use_huge_pages; }
+
+    private:
+        using free_block_map = std::map<std::uint8_t*, std::size_t>;
+
+        struct kind_pool {
+            std::vector<llvm::sys::MemoryBlock> regions{};
+            free_block_map free_blocks{};   ///< by address, adjacent free blocks are merged
+        };
+
+        bool _uses_huge_pages(section_kind kind) const noexcept;
+
+        /**
+         * \brief Reserve a new region from the system
+         * \return the free block covering the region
+         */
+        free_block_map::iterator _reserve_region(section_kind kind, std::size_t min_size);
+        static unsigned int _protection_flags(section_kind kind) noexcept;
+
+        const bool _use_huge_pages;
+        const std::size_t _page_size;
+        mutable std::mutex _mutex{};
+        std::array<kind_pool, 3u> _pools{};
+        usage _usage{};
+    };
+
+} // namespace DSPJIT
+
+#endif /* DSPJIT_CODE_MEMORY_POOL_H_ */
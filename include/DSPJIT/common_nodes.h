@@ -2,6 +2,7 @@
 #define DSPJIT_COMMON_NODES_H_
 
 #include "compile_node_class.h"
+#include "parameter_block.h"
 
 #include <math.h>
 
@@ -20,6 +21,10 @@ namespace DSPJIT {
         float get_value() const noexcept { return _value; }
         void set_value(float value) noexcept  { _value = value; }
 
+        bool supports_vector_processing() const noexcept override { return true; }
+        bool is_pure() const noexcept override { return true; }
+        bool is_equivalent(const compile_node_class& other) const noexcept override;
+
         std::vector<llvm::Value*> emit_outputs(
                 graph_compiler& compiler,
                 const std::vector<llvm::Value*>& inputs,
@@ -37,6 +42,8 @@ namespace DSPJIT {
             _ref{ref}
         {}
 
+        bool supports_vector_processing() const noexcept override { return true; }
+
         std::vector<llvm::Value*> emit_outputs(
                 graph_compiler& compiler,
                 const std::vector<llvm::Value*>& inputs,
@@ -46,6 +53,43 @@ namespace DSPJIT {
         const float* _ref;
     };
 
+    //  Parameter node
+
+    /**
+     * \brief Output a value which can be changed while the program is running, without compiling it again
+     * \details The value is stored in a slot of a parameter block, which is reserved as long as the node exists
+     */
+    class parameter_node : public compile_node_class {
+    public:
+        /**
+         * \param parameters the parameter block of the context the node is compiled in. Must outlive the node
+         * \param value the initial value
+         * \throw std::runtime_error if no parameter slot is available
+         */
+        parameter_node(parameter_block& parameters, float value);
+        ~parameter_node() noexcept override;
+
+        float get_value() const noexcept { return _parameters.get(_slot); }
+
+        /**
+         * \brief Set the node output value. Can be called from any thread, while a program using it is running
+         */
+        void set_value(float value) noexcept { _parameters.set(_slot, value); }
+
+        parameter_block::slot_t get_slot() const noexcept { return _slot; }
+
+        bool supports_vector_processing() const noexcept override { return true; }
+
+        std::vector<llvm::Value*> emit_outputs(
+                graph_compiler& compiler,
+                const std::vector<llvm::Value*>& inputs,
+                llvm::Value*, llvm::Value*) const override;
+
+    private:
+        parameter_block& _parameters;
+        const parameter_block::slot_t _slot;
+    };
+
     //  Reference multiply node
 
     class reference_multiply_node : public compile_node_class {
@@ -55,6 +99,8 @@ namespace DSPJIT {
             _ref{ref}
         {}
 
+        bool supports_vector_processing() const noexcept override { return true; }
+
         std::vector<llvm::Value*> emit_outputs(
                 graph_compiler& compiler,
                 const std::vector<llvm::Value*>& inputs,
@@ -72,6 +118,9 @@ namespace DSPJIT {
             compile_node_class{2u, 1u}
         {}
 
+        bool supports_vector_processing() const noexcept override { return true; }
+        bool is_pure() const noexcept override { return true; }
+
         std::vector<llvm::Value*> emit_outputs(
                 graph_compiler& compiler,
                 const std::vector<llvm::Value*>& inputs,
@@ -85,6 +134,9 @@ namespace DSPJIT {
             compile_node_class{ 2u, 1u }
         {}
 
+        bool supports_vector_processing() const noexcept override { return true; }
+        bool is_pure() const noexcept override { return true; }
+
         std::vector<llvm::Value*> emit_outputs(
             graph_compiler& compiler,
             const std::vector<llvm::Value*>& inputs,
@@ -99,6 +151,9 @@ namespace DSPJIT {
         :   compile_node_class{2u, 1u}
         {}
 
+        bool supports_vector_processing() const noexcept override { return true; }
+        bool is_pure() const noexcept override { return true; }
+
         std::vector<llvm::Value*> emit_outputs(
                 graph_compiler& compiler,
                 const std::vector<llvm::Value*>& inputs,
@@ -113,6 +168,8 @@ namespace DSPJIT {
         :   compile_node_class{1u, 1u, sizeof(float), false, false}
         {}
 
+        bool supports_vector_processing() const noexcept override { return true; }
+
         void initialize_mutable_state(
                 llvm::IRBuilder<>& builder,
                 llvm::Value *mutable_state, llvm::Value*) const override;
@@ -137,6 +194,9 @@ namespace DSPJIT {
         :   compile_node_class{1u, 1u}
         {}
 
+        bool supports_vector_processing() const noexcept override { return true; }
+        bool is_pure() const noexcept override { return true; }
+
         std::vector<llvm::Value*> emit_outputs(
                 graph_compiler& compiler,
                 const std::vector<llvm::Value*>& inputs,
@@ -151,6 +211,9 @@ namespace DSPJIT {
         :   compile_node_class{1u, 1u}
         {}
 
+        bool supports_vector_processing() const noexcept override { return true; }
+        bool is_pure() const noexcept override { return true; }
+
         std::vector<llvm::Value*> emit_outputs(
                 graph_compiler& compiler,
                 const std::vector<llvm::Value*>& inputs,
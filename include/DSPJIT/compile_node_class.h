@@ -9,6 +9,7 @@
 #include <vector>
 #include <map>
 #include <set>
+#include <typeinfo>
 
 #include "node.h"
 
@@ -38,6 +39,31 @@ namespace DSPJIT {
         compile_node_class(compile_node_class&&) = delete;
         virtual ~compile_node_class() = default;
 
+        /**
+         * \brief Return true if the node emitted code can process several instances at once.
+         * \details When processing several instances at once, node values are <N x float> vectors
+         * (see graph_compiler::vector_width) and the mutable state pointer is the state of the first lane
+         * instance, followed by the other lanes states (stride = mutable_state_size).
+         * Nodes which do not support it are scalarized : their code is emitted once per lane.
+         */
+        virtual bool supports_vector_processing() const noexcept { return false; }
+
+        /**
+         * \brief Return true if the node outputs only depend on its input values : the node must be a dependant
+         * process node without mutable state nor static memory, and its code must have no side effect.
+         * \details Pure nodes are not given a state unless they are part of a cycle. A pure node equivalent to an
+         * already compiled node with the same input values reuses its output values instead of being compiled again
+         * (see graph_compiler).
+         */
+        virtual bool is_pure() const noexcept { return false; }
+
+        /**
+         * \brief Return true if this node computes the same outputs than another node from the same input values
+         * \note Only called on pure nodes. The default implementation compares the nodes types, nodes
+         * having parameters must override it.
+         */
+        virtual bool is_equivalent(const compile_node_class& other) const noexcept { return typeid(*this) == typeid(other); }
+
         /**
          * \brief Emit the initialization code for the mutable state
          * \note Implement this if the node use a mutable_state (mutable_state_size > 0)
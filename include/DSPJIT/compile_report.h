@@ -0,0 +1,54 @@
+#ifndef DSPJIT_COMPILE_REPORT_H_
+#define DSPJIT_COMPILE_REPORT_H_
+
+#include <chrono>
+#include <cstddef>
+
+#include "abstract_graph_memory_manager.h"
+
+namespace DSPJIT {
+
+    /**
+     * \brief Measures of a graph compilation, returned by graph_execution_context::compile
+     */
+    struct compile_report {
+        using duration = std::chrono::microseconds;
+
+        abstract_graph_memory_manager::compile_sequence_t seq{0u};
+
+        //  Phases durations
+        duration library_link_time{};           ///< library declaration, and linking of the library code used by the program
+        duration graph_compilation_time{};      ///< graph traversal and process functions IR code generation (including composite functions)
+        duration initialize_compilation_time{}; ///< state initialize functions IR code generation (finish_sequence)
+        duration optimization_time{};           ///< IR optimization, zero if it was skipped
+        duration verification_time{};           ///< IR code verification
+        duration native_code_generation_time{}; ///< native code generation and loading
+        duration total_time{};
+
+        //  Code sizes
+        std::size_t instruction_count_before_optimization{0u};
+        std::size_t instruction_count_after_optimization{0u};
+        std::size_t native_code_size{0u};       ///< size of the native code and data sections loaded by this compilation, in bytes
+
+        //  Native code memory of the execution engine, once the compilation is done
+        std::size_t native_memory_used{0u};
+        std::size_t native_memory_reserved{0u};
+
+        //  Graph level optimization of the process function (see graph_compiler)
+        std::size_t compiled_node_count{0u};    ///< nodes whose code was emitted
+        std::size_t folded_node_count{0u};      ///< pure nodes folded into constants
+        std::size_t merged_node_count{0u};      ///< pure nodes merged with an equivalent node
+
+        //  Node states
+        std::size_t new_state_count{0u};
+        std::size_t deleted_state_count{0u};
+
+        bool object_cache_hit{false};           ///< the native code was loaded from the object cache
+        bool program_cache_hit{false};          ///< the program was found in the program cache and published again without being compiled
+        std::size_t partition_count{0u};        ///< partitions compiled in parallel, 0 if the program was not split.
+                                                ///< The optimization time then includes the partitions native code generation
+        bool cancelled{false};                  ///< the compilation was cancelled at a phase boundary : no program was published
+    };
+}
+
+#endif /* DSPJIT_COMPILE_REPORT_H_ */
@@ -0,0 +1,98 @@
+#ifndef DSPJIT_COMPILE_SERVICE_H_
+#define DSPJIT_COMPILE_SERVICE_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "graph_execution_context.h"
+
+namespace DSPJIT {
+
+    /**
+     * \class compile_service
+     * \brief Compile the graph of a context on a background thread, coalescing the requests made by fast edits
+     * \details A compilation starts once no request was made for the debounce delay, and covers every request made
+     * until then. When a newer request arrives, the running compilation is cancelled at its next phase boundary and
+     * its requests are covered by the newer one.
+     * The graph must be edited under the lock returned by lock_graph. The service only holds it while the graph is
+     * translated to IR code : the optimization and the native code generation run on this snapshot of the graph.
+     * \note The service thread is the context compile thread : the context compile thread API must not be used
+     * while the service exists, except register_static_memory_chunk and free_static_memory_chunk which must be called
+     * under the graph lock
+     */
+    class compile_service {
+
+    public:
+        using node_ref_vector = std::vector<std::reference_wrapper<compile_node_class>>;
+
+        /**
+         * \param context the context whose compile thread API is used by the service thread
+         * \param debounce_delay the time without request after which a compilation starts
+         */
+        explicit compile_service(
+            graph_execution_context& context,
+            std::chrono::microseconds debounce_delay = std::chrono::milliseconds{20});
+
+        compile_service(const compile_service&) = delete;
+        compile_service(compile_service&&) = delete;
+
+        /**
+         * \brief Stop the service thread. The running compilation is cancelled, and the pending requests are abandoned
+         */
+        ~compile_service() noexcept;
+
+        /**
+         * \brief Lock the graph before editing it : the service does not read the graph while the lock is held
+         * \details The nodes static memory chunks are registered and freed under this lock too
+         */
+        std::unique_lock<std::mutex> lock_graph();
+
+        /**
+         * \brief Request a compilation of the graph
+         * \param input_nodes the nodes which represents the graph inputs
+         * \param output_nodes the nodes which represents the graph outputs
+         * \return the report of the compilation which published a program covering the request. Its seq member is
+         * the published sequence. It holds the compilation exception, if it failed, or a std::future_error if the
+         * service was stopped before
+         */
+        std::future<compile_report> request(node_ref_vector input_nodes, node_ref_vector output_nodes);
+
+    private:
+        /**
+         * \brief The newest request, and the promises of the requests it covers
+         */
+        struct pending_request {
+            std::size_t id;
+            node_ref_vector input_nodes;
+            node_ref_vector output_nodes;
+            std::vector<std::promise<compile_report>> promises;
+        };
+
+        void _thread_main();
+        void _compile(pending_request&& request);
+
+        graph_execution_context& _context;
+        const std::chrono::microseconds _debounce_delay;
+
+        std::mutex _graph_mutex{};
+
+        //  Requester threads -> service thread
+        std::mutex _request_mutex{};
+        std::condition_variable _request_condition{};
+        std::optional<pending_request> _pending_request{};
+        std::chrono::steady_clock::time_point _last_request_time{};
+        std::atomic<std::size_t> _last_request_id{0u};      ///< read by the cancellation check, without lock
+        std::atomic<bool> _running{true};
+
+        std::thread _thread{};
+    };
+}
+
+#endif /* DSPJIT_COMPILE_SERVICE_H_ */
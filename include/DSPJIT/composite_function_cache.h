@@ -0,0 +1,127 @@
+#ifndef DSPJIT_COMPOSITE_FUNCTION_CACHE_H_
+#define DSPJIT_COMPOSITE_FUNCTION_CACHE_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "abstract_execution_engine.h"
+#include "abstract_graph_memory_manager.h"
+
+namespace DSPJIT {
+
+    class composite_node;
+    class graph_compiler;
+    class ir_optimizer;
+    class object_cache;
+
+    /**
+     * \class composite_function_cache
+     * \brief Compile composite nodes into separate functions, which are reused accross compilations
+     * \details Each composite node internal graph is compiled in its own module, where states and static memory
+     * are referenced through a table given by the caller (see abstract_graph_memory_manager::push_memory_region_scope).
+     * The function code thus only depends on the internal graph, and is named after a hash of its IR code :
+     * composites whose code did not change since a previous compilation, or which are identical to another composite,
+     * are not optimized nor compiled to native code again.
+     * With an object cache, the functions modules are named after their cache key : their native code is then reused
+     * across sessions, but they are still optimized once per session.
+     * \note composite internal nodes must only be connected to the composite input and output nodes
+     */
+    class composite_function_cache {
+
+    public:
+        using compile_sequence_t = abstract_graph_memory_manager::compile_sequence_t;
+
+        /**
+         * \param execution_engine engine on which the functions modules are compiled
+         * \param memory_manager the graph memory manager
+         * \param library the library module, linked in every function module
+         * \param optimizer the optimizer run on the functions modules
+         */
+        composite_function_cache(
+            abstract_execution_engine& execution_engine,
+            abstract_graph_memory_manager& memory_manager,
+            const llvm::Module& library,
+            ir_optimizer& optimizer);
+
+        composite_function_cache(const composite_function_cache&) = delete;
+        composite_function_cache(composite_function_cache&&) = delete;
+
+        /**
+         * \brief Notify that a new compilation sequence begins
+         */
+        void begin_sequence(compile_sequence_t seq) noexcept { _current_sequence = seq; }
+
+        /**
+         * \brief Set the object cache in which the functions native code is stored by the execution engine. May be null
+         */
+        void set_object_cache(const object_cache *cache) noexcept { _object_cache = cache; }
+
+        /**
+         * \brief Emit a call to the function computing a composite node outputs, compiling it if needed
+         * \param compiler the caller graph compiler
+         * \param node the composite node
+         * \param inputs the composite node input values
+         * \return the composite node output values
+         */
+        std::vector<llvm::Value*> emit_call(
+            graph_compiler& compiler,
+            const composite_node& node,
+            const std::vector<llvm::Value*>& inputs);
+
+        /**
+         * \brief Notify that the program generated at a given sequence is now being executed :
+         * the functions which were not used since are deleted
+         */
+        void using_sequence(compile_sequence_t seq);
+
+        /**
+         * \brief Keep a function, even if it is not used anymore, until it is unpinned as many times
+         * \param symbol the function symbol, as used by the callers
+         * \return false if the function is unknown
+         */
+        bool pin_function(const std::string& symbol);
+
+        /**
+         * \brief Release a function pinned by pin_function
+         */
+        void unpin_function(const std::string& symbol);
+
+        /**
+         * \brief Return a pointer to a compiled function native code, null if the function is unknown
+         * \param symbol the function symbol, as used by the callers
+         * \note The native code must have been emitted
+         */
+        void *get_function_pointer(const std::string& symbol) const;
+
+        /**
+         * \brief Return the number of compiled functions
+         */
+        std::size_t get_function_count() const noexcept { return _functions.size(); }
+
+    private:
+        struct function_entry {
+            llvm::Module *module;
+            compile_sequence_t last_used_sequence;
+            std::size_t pin_count{0u};
+        };
+
+        /**
+         * \brief Compile the composite internal graph into a function, in a new module
+         */
+        llvm::Function *_compile_function(
+            graph_compiler& compiler,
+            const composite_node& node,
+            llvm::Module& module);
+
+        abstract_execution_engine& _execution_engine;
+        abstract_graph_memory_manager& _memory_manager;
+        const llvm::Module& _library;
+        ir_optimizer& _optimizer;
+        const object_cache *_object_cache{nullptr};
+        std::map<std::string, function_entry> _functions{};     ///< compiled functions, by symbol
+        compile_sequence_t _current_sequence{0u};
+    };
+}
+
+#endif /* DSPJIT_COMPOSITE_FUNCTION_CACHE_H_ */
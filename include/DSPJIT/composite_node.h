@@ -12,6 +12,8 @@ namespace DSPJIT {
             const unsigned int input_count,
             const unsigned output_count);
 
+        bool supports_vector_processing() const noexcept override { return true; }
+
         std::vector<llvm::Value*> emit_outputs(
             graph_compiler& compiler,
             const std::vector<llvm::Value*>& inputs,
@@ -19,6 +21,8 @@ namespace DSPJIT {
 
         auto& input() noexcept { return _input; }
         auto& output() noexcept { return _output; }
+        const auto& input() const noexcept { return _input; }
+        const auto& output() const noexcept { return _output; }
 
         void add_input() override;
         void remove_input() override;
@@ -3,6 +3,7 @@
 
 #include <filesystem>
 #include <optional>
+#include <set>
 #include <string>
 #include <variant>
 #include <vector>
@@ -59,6 +60,7 @@ namespace DSPJIT {
             unsigned int output_count{0u};
             std::size_t mutable_state_size{0u};
             bool use_static_memory{false};
+            bool pure{false};       ///< the node is a dependant process node whose outputs only depend on its inputs
         };
 
         struct initialization_info
@@ -124,6 +126,13 @@ namespace DSPJIT {
         bool _is_input(const llvm::Argument *arg) const;
         bool _is_output(const llvm::Argument *arg) const;
 
+        /**
+         * \brief Conservative side effect analysis : return true if the function only writes to its arguments
+         * or to its own stack, only reads constant globals, and only calls functions satisfying the same conditions
+         * \param visited the functions being or already analyzed, to handle recursion
+         */
+        bool _is_pure_function(const llvm::Function& function, std::set<const llvm::Function*>& visited) const;
+
         bool _check_consistency(
             const process_info& proc_info,
             const std::optional<initialization_info>& init_info) const;
@@ -1,32 +1,113 @@
 #ifndef DSPJIT_GRAPH_COMPILER_H_
 #define DSPJIT_GRAPH_COMPILER_H_
 
-#include <deque>
-#include <optional>
+#include <limits>
+#include <unordered_map>
+#include <vector>
 
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/IR/IRBuilder.h>
 #include "abstract_graph_memory_manager.h"
+#include "parameter_block.h"
 
 namespace DSPJIT {
 
+    class composite_function_cache;
+
     /**
      * \brief Helper class for graph compilation
      */
     class graph_compiler
     {
-        using value_memoize_map = std::map<const compile_node_class*, std::vector<llvm::Value*>>;
+        static constexpr auto npos = std::numeric_limits<std::size_t>::max();
+
+        /**
+         * \brief A node visited by the compiler, identified by a dense index
+         */
+        struct node_entry {
+            const compile_node_class *node;
+            std::size_t value_offset;               ///< offset of the node output values in _values
+            std::size_t edge_offset;                ///< offset of the node input edges in _edges
+            std::size_t pure_input_offset{npos};    ///< offset of a compiled pure node input values in _pure_inputs
+            std::size_t next_pure_node{npos};       ///< next compiled pure node whose input values have the same key
+        };
+
+        /**
+         * \brief A node input, resolved to the index of the node which is plugged in
+         */
+        struct input_edge {
+            std::size_t index{npos};                ///< the input node index, npos if nothing is plugged in
+            unsigned int output_id{0u};             ///< the input node output
+            bool feedback{false};                   ///< the input value is delayed to break a cycle
+        };
+
+        /**
+         * \brief A node scheduling state during a scheduling pass (Tarjan strongly connected components)
+         */
+        struct schedule_entry {
+            std::size_t order{npos};                ///< discovery order in the pass, npos if the pass did not discover the node
+            std::size_t lowlink{npos};              ///< smallest order of a node reachable from this one in its component
+            bool on_path{false};                    ///< the node inputs are being scanned
+            bool scheduled{false};                  ///< the node component was emitted
+        };
+
+        /**
+         * \brief A node on the depth first search path, whose inputs are being scanned
+         */
+        struct schedule_frame {
+            std::size_t index;                      ///< the node index
+            unsigned int next_input;                ///< the next input to be scanned
+        };
+
+        /**
+         * \brief A scheduling pass state. Passes are local to node_value, as nodes (composite nodes)
+         * can compile their internal graph with this compiler while their code is emitted
+         */
+        struct schedule_pass {
+            explicit schedule_pass(std::size_t first) noexcept : first_index{first} {}
+
+            const std::size_t first_index;          ///< the first node index which can be discovered by the pass
+            std::size_t discovered_count{0u};
+            std::vector<schedule_entry> entries{};  ///< by node index, starting at first_index
+            std::vector<schedule_frame> path{};
+            std::vector<std::size_t> finished{};    ///< nodes whose inputs were scanned, but whose component was not emitted
+            std::vector<std::size_t> deferred_nodes{};  ///< non dependant process nodes whose inputs are to be pushed
+            std::vector<llvm::Value*> inputs{};     ///< input values of the node being emitted
+        };
+
+        using node_index_map = llvm::DenseMap<const compile_node_class*, std::size_t>;
+        using pure_node_map = llvm::DenseMap<std::size_t, std::size_t>;
 
     public:
+        /**
+         * \brief Graph level optimization measures
+         */
+        struct statistics {
+            std::size_t compiled_node_count{0u};    ///< nodes whose code was emitted
+            std::size_t folded_node_count{0u};      ///< pure nodes with constant inputs, folded into constants
+            std::size_t merged_node_count{0u};      ///< pure nodes which reused the outputs of an equivalent node
+        };
+
         /**
          * \brief create a graph compiler
          * \param builder a llvm instrcution builder
          * \param instance_num the llvm value containing the instance number
          * \param state_mgr the graph state manager
+         * \param vector_width the number of consecutive instances processed at once,
+         * starting at instance_num. Values are <vector_width x float> when greater than 1
+         * \param composite_functions if not null, composite nodes are compiled in separate functions
+         * \param parameters the parameters which can be used by the nodes, null if none
+         * \param constant_parameters if true, the parameters are compiled as constants with their current value,
+         * so that the code does not depend on the parameter block address
          */
         graph_compiler(
             llvm::IRBuilder<>& builder,
             llvm::Value *instance_num,
-            abstract_graph_memory_manager& state_mgr);
+            abstract_graph_memory_manager& state_mgr,
+            unsigned int vector_width = 1u,
+            composite_function_cache *composite_functions = nullptr,
+            parameter_block *parameters = nullptr,
+            bool constant_parameters = false);
 
         /**
          * \brief assign values to a node
@@ -53,27 +134,177 @@ namespace DSPJIT {
          */
         auto& builder() noexcept { return _builder; }
 
+        /**
+         * \return the instance number value (first lane instance)
+         */
+        llvm::Value *instance_num() const noexcept { return _instance_num; }
+
+        /**
+         * \return the cache used to compile composite nodes into separate functions, null if disabled
+         */
+        composite_function_cache *composite_functions() const noexcept { return _composite_functions; }
+
+        /**
+         * \return the parameters which can be used by the nodes, null if none
+         */
+        parameter_block *parameters() const noexcept { return _parameters; }
+
+        /**
+         * \return true if the parameters are compiled as constants
+         */
+        bool constant_parameters() const noexcept { return _constant_parameters; }
+
+        /**
+         * \return the number of instances processed at once by the emitted code
+         */
+        unsigned int vector_width() const noexcept { return _vector_width; }
+
+        /**
+         * \return the type of the values flowing between nodes : float or <vector_width x float>
+         */
+        llvm::Type *value_type();
+
+        /**
+         * \brief Create a constant value, broadcasted on every lanes
+         */
+        llvm::Value *create_constant(float value);
+
+        /**
+         * \brief Broadcast a scalar float value on every lanes
+         */
+        llvm::Value *broadcast(llvm::Value *scalar);
+
+        /**
+         * \brief Return a parameter value, broadcasted on every lanes
+         * \details The value is read once, at the beginning of the function being compiled. It is a constant if
+         * the parameters are compiled as constants, or if the parameter was promoted (see parameter_block::promote)
+         * \throw std::invalid_argument if the parameter does not belong to the compiled parameters
+         */
+        llvm::Value *parameter_value(const parameter_block& parameters, parameter_block::slot_t slot);
+
+        /**
+         * \return the graph level optimization measures of the nodes compiled so far
+         */
+        const statistics& get_statistics() const noexcept { return _statistics; }
+
     private:
-        std::optional<std::vector<llvm::Value*>> _scan_inputs(
-            std::deque<const compile_node_class*>& dependency_stack,
-            const compile_node_class& node);
+        /**
+         * \brief Emit a node code, scalarizing it lane by lane if it does not support vector processing
+         * \param state the node state, can be null if the node has no mutable state
+         * \param emit the node code emitter : (inputs, mutable_state, static_memory) -> outputs
+         */
+        template <typename TEmitFunc>
+        std::vector<llvm::Value*> _emit_node_code(
+            const compile_node_class& node,
+            abstract_node_state *state,
+            const std::vector<llvm::Value*>& inputs,
+            llvm::Value *static_memory,
+            TEmitFunc emit);
+
+        llvm::Value *_load_cycle_state(abstract_node_state& state, unsigned int output_id);
+        void _store_cycle_state(abstract_node_state& state, unsigned int output_id, llvm::Value *value);
+
+        /**
+         * \brief Return the index of a visited node, npos if the node was not visited
+         */
+        std::size_t _find_node(const compile_node_class *node) const;
+
+        /**
+         * \brief Record a node as visited, with null output values and unresolved input edges
+         * \return the node index
+         */
+        std::size_t _add_node(const compile_node_class& node);
+
+        llvm::Value *&_node_output(std::size_t index, unsigned int output_id) { return _values[_nodes[index].value_offset + output_id]; }
+
+        /**
+         * \brief Emit the code of a node and of all its dependencies which were never visited
+         * \details Tarjan's algorithm runs on the dependency graph : a dependant process node depends on its
+         * inputs, while a non dependant process node depends on nothing. Each strongly connected component
+         * is emitted once it is complete, so that the components are emitted in topological order.
+         * Cycles only exist inside a component : they are broken with an additional delay on the back edges
+         * of the depth first search, the component nodes being emitted in the search finishing order.
+         */
+        void _schedule(schedule_pass& pass, const compile_node_class& root);
+
+        /**
+         * \brief Record a node discovered by a pass and start to scan its inputs
+         * \return the node index
+         */
+        std::size_t _discover(schedule_pass& pass, const compile_node_class& node);
+
+        /**
+         * \brief Resolve the next input edge of the node on top of the search path, discovering the input node
+         * if it was never visited
+         * \return false if all the node inputs were already scanned
+         */
+        bool _scan_next_input(schedule_pass& pass);
+
+        /**
+         * \brief Complete the node on top of the search path, and emit its component if it is the root
+         */
+        void _finish_node(schedule_pass& pass);
+
+        /**
+         * \brief Emit the nodes of a complete component, in finishing order
+         */
+        void _emit_component(schedule_pass& pass, std::size_t root_index);
+
+        /**
+         * \brief Push the inputs of a non dependant process node, once its dependencies have been emitted
+         */
+        void _push_deferred_node_inputs(schedule_pass& pass, std::size_t index);
+
+        /**
+         * \brief Return the scheduling state of a node discovered by a pass, null for nodes which were
+         * visited before or by another pass
+         */
+        schedule_entry *_schedule_entry(schedule_pass& pass, std::size_t index);
+
+        /**
+         * \brief Gather a node input values from its resolved input edges
+         * \details A delayed (feedback) input value is loaded from the input node cycle state. The load is kept as
+         * the input node output value, until the input node code is emitted and the cycle state stored.
+         */
+        void _gather_input_values(std::size_t index, std::vector<llvm::Value*>& inputs);
 
         void _push_node_input_values(
             const compile_node_class& node,
             const std::vector<llvm::Value*>& inputs);
 
         void _compute_node_output_values(
-            const compile_node_class& node,
+            std::size_t index,
             const std::vector<llvm::Value*>& inputs);
 
-        std::vector<llvm::Value*>& _assign_null_values(const compile_node_class&);
+        /**
+         * \brief Compute a pure node outputs, reusing the outputs of an equivalent node with the same inputs if any
+         */
+        std::vector<llvm::Value*> _compute_pure_node_output_values(
+            std::size_t index,
+            const std::vector<llvm::Value*>& inputs);
+
+        /**
+         * \brief Return the key of a pure node input values in _pure_nodes
+         */
+        static std::size_t _pure_node_key(const std::vector<llvm::Value*>& inputs) noexcept;
 
         llvm::Value *_create_zero();
 
-        value_memoize_map _nodes_value{};             ///< Used to record the output values produced by nodes during compilation
+        node_index_map _node_indices{};               ///< visited nodes indices
+        std::vector<node_entry> _nodes{};             ///< visited nodes, by index
+        std::vector<llvm::Value*> _values{};          ///< output values produced by the nodes during compilation, null while being computed
+        std::vector<input_edge> _edges{};             ///< visited nodes input edges
+        pure_node_map _pure_nodes{};                  ///< first compiled pure node index, by input values key (hash consing)
+        std::vector<llvm::Value*> _pure_inputs{};     ///< compiled pure nodes input values
+        statistics _statistics{};
         llvm::IRBuilder<>& _builder;                  ///< builder used to emit ir code at relevant insert point
-        llvm::Value *const _instance_num;             ///< used instance number value
+        llvm::Value *_instance_num;                   ///< used instance number value (first lane instance)
         abstract_graph_memory_manager& _memory_mgr;   ///< graph memory manager used accros compilations
+        unsigned int _vector_width;                   ///< number of instances processed at once
+        composite_function_cache *_composite_functions;
+        parameter_block *_parameters;
+        bool _constant_parameters;
+        std::unordered_map<parameter_block::slot_t, llvm::Value*> _parameter_values{};   ///< scalar values read by the function
     };
 
 }
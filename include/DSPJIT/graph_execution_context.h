@@ -1,28 +1,48 @@
 #ifndef DSPJIT_GRAPH_EXECUTION_CONTEXT_H_
 #define DSPJIT_GRAPH_EXECUTION_CONTEXT_H_
 
+#include <atomic>
 #include <cstdint>
+#include <functional>
+#include <list>
 #include <vector>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include <llvm/ADT/ArrayRef.h>
 
 #include <DSPJIT/abstract_execution_engine.h>
 #include <DSPJIT/abstract_graph_memory_manager.h>
+#include <DSPJIT/background_optimizer.h>
+#include <DSPJIT/compile_report.h>
+#include <DSPJIT/composite_function_cache.h>
 #include <DSPJIT/lock_free_queue.h>
+#include <DSPJIT/object_cache.h>
+#include <DSPJIT/optimization_pipeline.h>
+#include <DSPJIT/parameter_block.h>
+#include <DSPJIT/triple_buffer.h>
 
 namespace DSPJIT {
 
+    class ir_optimizer;
+    class partition_compiler;
+
     /**
      * \brief graph_execution_context
      */
     class graph_execution_context {
 
         /* Native compiled function types */
-        using native_process_func = void (*)(std::size_t instance_num, const float *inputs, float *outputs);
-        using native_initialize_func = void (*)(std::size_t instance_num);
+        using region_table = void * const *;
+        using native_process_func = void (*)(std::size_t instance_num, const float *inputs, float *outputs, std::size_t frame_count, region_table regions);
+        using native_initialize_func = void (*)(std::size_t instance_num, region_table regions);
 
         /* Default functions implementation */
-        static constexpr auto default_process_func = [](std::size_t, const float*, float*) {};
-        static constexpr auto default_initialize_func = [](std::size_t) {};
+        static constexpr auto default_process_func = [](std::size_t, const float*, float*, std::size_t, region_table) {};
+        static constexpr auto default_initialize_func = [](std::size_t, region_table) {};
 
         /** ack_msg are sent from process thread to compile thread */
         using ack_msg = abstract_graph_memory_manager::compile_sequence_t;
@@ -31,12 +51,39 @@ namespace DSPJIT {
         struct compile_done_msg {
             abstract_graph_memory_manager::compile_sequence_t seq;
             native_process_func process_func;
+            native_process_func process_vector_func;
             native_initialize_func initialize_func;
+            region_table regions;
         };
 
     public:
         using opt_level = llvm::CodeGenOpt::Level;
         using node_ref_list = std::initializer_list<std::reference_wrapper<compile_node_class>>;
+        using node_ref_range = llvm::ArrayRef<std::reference_wrapper<compile_node_class>>;
+
+        /**
+         * \brief Callbacks run by compile at its phase boundaries
+         */
+        struct compile_hooks {
+            std::function<void()> graph_compiled{};     ///< called once the graph nodes are not read anymore
+            std::function<bool()> cancelled{};          ///< the compilation is cancelled, before its program is emitted, if it returns true
+        };
+
+        /**
+         * \brief Ahead of time export file formats
+         */
+        enum class export_format {
+            object_file,        ///< relocatable object file, to be linked in an application
+            shared_library      ///< shared library, which can be loaded with aot_program
+        };
+
+        /**
+         * \brief How compiled programs are handed to the process thread
+         */
+        enum class publication_mode {
+            queued,             ///< every compiled program is run, in order, one per update_program call
+            latest              ///< update_program jumps to the newest program, the programs it skips are deleted at once
+        };
 
         /**
          * \brief initialize a new graph execution context
@@ -44,15 +91,20 @@ namespace DSPJIT {
          * \param instance_count the number of graph state instance that must be managed
          * \param level Native code generation optimization level
          * \param options Native code generation options
+         * \param pipeline IR optimization pipeline
+         * \param optimized_engine_builder if set, enable tiered compilation : programs are published without optimization,
+         * and are then optimized by a background_optimizer whose execution engine is created by optimized_engine_builder
          */
         graph_execution_context(
             std::unique_ptr<abstract_execution_engine>&&,
-            std::unique_ptr<abstract_graph_memory_manager>&&);
+            std::unique_ptr<abstract_graph_memory_manager>&&,
+            const optimization_pipeline& pipeline = {},
+            background_optimizer::execution_engine_builder optimized_engine_builder = {});
 
         graph_execution_context(const graph_execution_context&) = delete;
         graph_execution_context(graph_execution_context&&) = delete;
 
-        ~graph_execution_context() noexcept = default;
+        ~graph_execution_context() noexcept;
 
         /*********************************************
          *   Compile Thread API
@@ -67,11 +119,46 @@ namespace DSPJIT {
          * \brief Compile the current graph into executable code
          * \param input_nodes the nodes which represents the graph inputs
          * \param output_nodes the nodes which represents the graph outputs
+         * \return the compilation phases durations and code sizes
          */
-        void compile(
+        compile_report compile(
             node_ref_list input_nodes,
             node_ref_list output_nodes);
 
+        /**
+         * \brief Compile the current graph into executable code, with callbacks at the phase boundaries
+         * \param input_nodes the nodes which represents the graph inputs
+         * \param output_nodes the nodes which represents the graph outputs
+         * \param hooks the callbacks. The cancellation is checked before the graph is compiled, before the
+         * optimization and before the native code generation
+         * \return the compilation phases durations and code sizes, with the cancelled flag set if the compilation was cancelled
+         */
+        compile_report compile(
+            node_ref_range input_nodes,
+            node_ref_range output_nodes,
+            const compile_hooks& hooks);
+
+        /**
+         * \brief Compile the current graph ahead of time into a standalone object file or shared library
+         * \param input_nodes the nodes which represents the graph inputs
+         * \param output_nodes the nodes which represents the graph outputs
+         * \param path the exported file path
+         * \param format the exported file format
+         * \details The exported code is position independent and does not depend on this context : the states
+         * of all instances are allocated in the exported file and static memory chunks are copied into it.
+         * It exports the functions graph__process, graph__process_vector (if the vector width is greater than 1)
+         * and graph__initialize, with the same signatures than the JIT compiled ones, as well as
+         * graph__get_instance_count, graph__get_input_count and graph__get_output_count.
+         * The running program and the states of this context are not modified.
+         * \throw std::runtime_error if the code cannot be emitted or linked
+         * \note Shared libraries are linked with the system C compiler driver (cc, or $CC)
+         */
+        void export_program(
+            node_ref_list input_nodes,
+            node_ref_list output_nodes,
+            const std::string& path,
+            export_format format = export_format::shared_library);
+
         /**
          * \brief Enable/disable printing of IR code
          * \param enable Print IR if true
@@ -84,29 +171,170 @@ namespace DSPJIT {
          */
         void set_global_constant(const std::string& name, float value);
 
+        /**
+         * \brief Return the parameter block used by the parameter nodes compiled by this context
+         * \details Parameters values can be changed while the program is running, without compiling it again
+         */
+        parameter_block& get_parameter_block() noexcept { return _parameters; }
+
         /**
          * \brief Register a memory chunk available as static memory for the given node
          * \note This chunk is not automatically deallocated when the node is not anymore in
-         * the compiled circuit.
+         * the compiled circuit. When the graph is compiled by a compile_service, this must be called under its graph lock
          */
         void register_static_memory_chunk(const compile_node_class& node, std::vector<uint8_t>&& data);
 
         /**
          * \brief Free the static memory chunk registered for the given node
+         * \note When the graph is compiled by a compile_service, this must be called under its graph lock
          */
         void free_static_memory_chunk(const compile_node_class& node);
 
+        /**
+         * \brief Set the IR optimization pipeline
+         * \throw std::invalid_argument if the custom pipeline cannot be parsed
+         * \note Take effect at next compilation
+         */
+        void set_optimization_pipeline(const optimization_pipeline& pipeline);
+
+        /**
+         * \brief Return the IR optimization pipeline
+         */
+        const optimization_pipeline& get_optimization_pipeline() const noexcept { return _optimization_pipeline; }
+
+        /**
+         * \brief Enable the persistent native code cache : compiling a graph whose code is in the cache
+         * skips optimization and native code generation
+         * \param directory the cache directory, created if needed
+         * \note Take effect at next compilation
+         */
+        void enable_object_cache(const std::string& directory);
+
+        /**
+         * \brief Return the object cache, null if it is not enabled
+         */
+        const object_cache *get_object_cache() const noexcept { return _object_cache.get(); }
+
+        /**
+         * \brief Enable/disable incremental compilation : composite nodes are compiled into separate functions
+         * whose native code is reused by the next compilations, as long as their internal graph does not change
+         * (see composite_function_cache)
+         * \param enable Compile composite nodes separately if true, inline them otherwise
+         * \note Take effect at next compilation
+         */
+        void enable_incremental_compilation(bool enable = true);
+
+        /**
+         * \brief Return the composite function cache, null if incremental compilation is not enabled
+         */
+        const composite_function_cache *get_composite_function_cache() const noexcept { return _composite_functions.get(); }
+
+        /**
+         * \brief Return true if programs are optimized on a background thread (see background_optimizer)
+         */
+        bool is_tiered_compilation_enabled() const noexcept { return static_cast<bool>(_optimizer); }
+
         /**
          * \brief Return the number of instance this context can run
          */
         std::size_t get_instance_count() const noexcept { return _instance_count; }
 
+        /**
+         * \brief Promise that the inputs and outputs given to the process functions never overlap
+         * \details The compiled code can then keep input values in registers across output stores.
+         * In place processing (inputs == outputs) is not allowed anymore when enabled
+         * \param enable Inputs and outputs may overlap if false (default)
+         * \note Take effect at next compilation
+         */
+        void enable_non_overlapping_io(bool enable = true) noexcept { _non_overlapping_io = enable; }
+
+        /**
+         * \brief Return true if the process functions inputs and outputs must not overlap
+         */
+        bool is_non_overlapping_io_enabled() const noexcept { return _non_overlapping_io; }
+
+        /**
+         * \brief Enable the compilation of a vector process program which process
+         * several consecutive instances at once (see process_vector_block)
+         * \param vector_width the number of instances processed at once. Must divide the instance count.
+         * 1 disable the vector program.
+         * \note Take effect at next compilation
+         */
+        void set_vector_width(std::size_t vector_width);
+
+        /**
+         * \brief Return the number of instances processed at once by the vector program
+         */
+        std::size_t get_vector_width() const noexcept { return _vector_width; }
+
+        /**
+         * \brief Compile variants of the process functions for several cpus, in addition to the default ones
+         * \param cpus the variants cpus, from the most generic to the most specific (e.g. x86-64-v2, x86-64-v3, x86-64-v4)
+         * \details The JIT runs the last variant supported by the host cpu, or the default process functions if none is.
+         * Exported programs contain every variant (e.g. graph__process__x86_64_v3), which aot_program
+         * dispatches at load time on x86-64.
+         * An empty list disables the variants.
+         * \throw std::invalid_argument if a cpu is unknown for the execution engine target
+         * \note Take effect at next compilation
+         */
+        void set_process_variants(const std::vector<std::string>& cpus);
+
+        /**
+         * \brief Return the cpus of the process functions variants
+         */
+        const std::vector<std::string>& get_process_variants() const noexcept { return _process_variants; }
+
+        /**
+         * \brief Enable the parallel compilation of large programs : their process functions are split into
+         * partitions which are optimized and compiled to native code on several threads
+         * \param thread_count the maximum number of partitions, and of threads compiling them. 0 or 1 disable it
+         * \param min_instruction_count programs whose process functions are smaller are not split
+         * \details The values used accross partitions are passed through memory, which makes the program slightly slower.
+         * Split programs are not stored in the object cache, and programs are not split with tiered compilation.
+         * The worker threads are created by this call, and kept by the next compilations.
+         * \note Take effect at next compilation
+         */
+        void enable_parallel_compilation(std::size_t thread_count, std::size_t min_instruction_count = 20000u);
+
+        /**
+         * \brief Return the maximum number of threads compiling a program, 0 if parallel compilation is disabled
+         */
+        std::size_t get_parallel_compilation_thread_count() const noexcept;
+
+        /**
+         * \brief Keep the most recently compiled programs, so that compiling one of their graphs again publishes
+         * its program without optimizing it nor generating its native code
+         * \details A program is found again when the graph IR code and the states it uses did not change.
+         * A cached program keeps its native code, its composite functions and the states of its nodes, even when they
+         * are not used by the running program anymore : the nodes used by a cached program must not be destroyed
+         * before the cache is disabled.
+         * \param capacity the maximum number of cached programs, the least recently used are deleted first. 0 disables the cache
+         */
+        void enable_program_cache(std::size_t capacity);
+
+        /**
+         * \brief Return the maximum number of cached programs, 0 if the program cache is disabled
+         */
+        std::size_t get_program_cache_capacity() const noexcept { return _program_cache_capacity; }
+
+        /**
+         * \brief Set how the compiled programs are handed to the process thread
+         * \details With the latest mode, a burst of compilations does not delay the switch to the newest program, and the
+         * superseded programs which were never run are deleted as soon as a newer program is published
+         * \note Take effect at next compilation
+         */
+        void set_publication_mode(publication_mode mode) noexcept { _publication_mode = mode; }
+
+        publication_mode get_publication_mode() const noexcept { return _publication_mode; }
+
         /*********************************************
          *   Process Thread API
          *********************************************/
 
         /**
-         * \brief Update current process program to the latests available compiled program
+         * \brief Update current process program to the latests available compiled program.
+         * With tiered compilation, swap in the optimized version of the running program when it is available
+         * \return true if the process program was changed
          */
         bool update_program() noexcept;
 
@@ -115,6 +343,7 @@ namespace DSPJIT {
          * \param instance_num state instance to be used
          * \param inputs input values
          * \param outputs output values
+         * \note inputs and outputs may be the same buffer, unless non overlapping I/O is enabled
          */
         void process(std::size_t instance_num, const float * inputs, float *outputs) noexcept;
 
@@ -125,12 +354,108 @@ namespace DSPJIT {
          */
         void process(const float *inputs, float *outputs) noexcept {   process(0u, inputs, outputs);   }
 
+        /**
+         * \brief Run the current process program on several consecutive frames using the graph state indexed by instance_num
+         * \param instance_num state instance to be used
+         * \param inputs input values, frame by frame : inputs of frame n start at inputs + n * input_count
+         * \param outputs output values, frame by frame : outputs of frame n start at outputs + n * output_count
+         * \param frame_count number of frames to be processed
+         * \note inputs and outputs may be the same buffer if the graph has as many inputs as outputs,
+         * unless non overlapping I/O is enabled
+         */
+        void process_block(std::size_t instance_num, const float *inputs, float *outputs, std::size_t frame_count) noexcept;
+
+        /**
+         * \brief Run the current vector process program on several consecutive frames, using
+         * the graph states from instance_num to instance_num + vector_width - 1
+         * \param instance_num first state instance to be used. Must be a multiple of the vector width
+         * \param inputs input values, frame by frame and lane by lane : the value of input i for the lane l
+         * of frame n is inputs[(n * input_count + i) * vector_width + l]
+         * \param outputs output values, with the same layout than inputs
+         * \param frame_count number of frames to be processed
+         * \note Does nothing if no vector program was compiled (see set_vector_width). inputs and outputs may be
+         * the same buffer if the graph has as many inputs as outputs,
+         * unless non overlapping I/O is enabled
+         */
+        void process_vector_block(std::size_t instance_num, const float *inputs, float *outputs, std::size_t frame_count) noexcept;
+
         /**
          * \brief Initialize the graph state indexed by instance_num
          * \param instance_num state instance to be used
          */
         void initialize_state(std::size_t instance_num = 0u) noexcept;
 
+        /*********************************************
+         *   Additional Process Threads
+         *********************************************/
+
+        /**
+         * \class process_thread
+         * \brief A thread running the context programs besides the context own process thread
+         * \details Each registered thread swaps in the newest program on its own, without waiting for the other threads.
+         * It publishes the sequence of the program it is running, and a program is deleted only once every registered
+         * thread, and the context own process thread, have moved past it. The threads must run different instances.
+         * \note The optimized programs of tiered compilation are only run by the context own process thread
+         */
+        class process_thread {
+            friend class graph_execution_context;
+
+        public:
+            process_thread(const process_thread&) = delete;
+            process_thread(process_thread&&) = delete;
+
+            /**
+             * \brief Unregister the thread : the programs it was running can be deleted
+             */
+            ~process_thread() noexcept;
+
+            /**
+             * \brief Jump to the newest compiled program. Wait-free
+             * \return true if the program was changed
+             */
+            bool update_program() noexcept;
+
+            /**
+             * \brief Run the current program using the graph state indexed by instance_num
+             * \note see graph_execution_context::process
+             */
+            void process(std::size_t instance_num, const float *inputs, float *outputs) noexcept;
+
+            /**
+             * \brief Run the current program on several consecutive frames using the graph state indexed by instance_num
+             * \note see graph_execution_context::process_block
+             */
+            void process_block(std::size_t instance_num, const float *inputs, float *outputs, std::size_t frame_count) noexcept;
+
+            /**
+             * \brief Run the current vector program on several consecutive frames
+             * \note see graph_execution_context::process_vector_block
+             */
+            void process_vector_block(std::size_t instance_num, const float *inputs, float *outputs, std::size_t frame_count) noexcept;
+
+            /**
+             * \brief Initialize the graph state indexed by instance_num
+             * \param instance_num state instance to be used
+             */
+            void initialize_state(std::size_t instance_num) noexcept;
+
+        private:
+            explicit process_thread(graph_execution_context& context) noexcept;
+
+            graph_execution_context& _context;
+            compile_done_msg _program{0u, default_process_func, default_process_func, default_initialize_func, nullptr};
+            std::atomic<abstract_graph_memory_manager::compile_sequence_t> _running_sequence;   ///< read by the compile thread
+        };
+
+        /**
+         * \brief Register a thread which runs the context programs
+         * \details The thread starts with an empty program, until its first update_program call.
+         * The programs are deleted once every registered thread has moved past them :
+         * a registered thread must keep updating its program, as the context own process thread.
+         * \note Can be called from any thread, the thread is unregistered when the returned object is destroyed
+         */
+        std::unique_ptr<process_thread> register_process_thread();
+
     private:
 
         /*********************************************
@@ -143,10 +468,46 @@ namespace DSPJIT {
         const std::size_t _instance_count;                           ///< Number of state instances ready for execution
         std::unique_ptr<llvm::Module> _library{};                    ///< code available for execution from graph node
 
+        std::unique_ptr<object_cache> _object_cache{};                ///< must outlive the execution engine
         std::unique_ptr<abstract_execution_engine> _execution_engine{};
         std::unique_ptr<abstract_graph_memory_manager> _state_manager{};
+        std::unique_ptr<composite_function_cache> _composite_functions{};
+        std::unique_ptr<background_optimizer> _optimizer{};          ///< null if tiered compilation is disabled
+        std::unique_ptr<ir_optimizer> _ir_optimizer{};               ///< run the optimization pipeline on the compile thread
+        std::unique_ptr<partition_compiler> _partition_compiler{};   ///< null if programs are not split
+        parameter_block _parameters{};                               ///< read by the running programs
 
         abstract_graph_memory_manager::compile_sequence_t _current_sequence;  ///< current compilation sequence number
+        std::map<abstract_graph_memory_manager::compile_sequence_t, std::vector<void*>> _region_tables{};   ///< region table of each program which can be running
+        abstract_graph_memory_manager::compile_sequence_t _acknowledged_sequence{0u};    ///< newest program run by the context own process thread
+        std::map<abstract_graph_memory_manager::compile_sequence_t, compile_done_msg> _published_programs{};   ///< programs which can be loaded by registered threads
+        std::size_t _vector_width{1u};                              ///< instances processed at once by the vector program
+        bool _non_overlapping_io{false};                            ///< process functions I/O arrays are noalias
+        optimization_pipeline _optimization_pipeline{};
+        std::vector<std::string> _process_variants{};              ///< cpus of the process functions variants
+        std::optional<std::size_t> _host_process_variant{};         ///< index of the variant run by the JIT, if any
+        std::size_t _parallel_compilation_min_instruction_count{0u}; ///< process functions size from which programs are split
+        publication_mode _publication_mode{publication_mode::queued};
+
+        /**
+         * \brief A compiled program kept by the program cache
+         */
+        struct cached_program {
+            std::size_t key;                                        ///< hash of the graph IR code and of the states addresses
+            llvm::Module *module;                                   ///< owned by the cache, deleted from the execution engine with the program
+            native_process_func process_func;
+            native_process_func process_vector_func;
+            native_initialize_func initialize_func;
+            std::vector<void*> region_table;
+            std::vector<const compile_node_class*> nodes;           ///< nodes whose states are pinned
+            std::vector<std::string> composite_functions;           ///< pinned composite functions
+            abstract_graph_memory_manager::compile_sequence_t last_used_sequence;  ///< newest sequence which published the program
+            std::optional<background_optimizer::job> optimization_job;  ///< with tiered compilation, submitted again each time the program is published
+        };
+
+        std::size_t _program_cache_capacity{0u};
+        std::list<cached_program> _cached_programs{};               ///< most recently used first
+        std::vector<cached_program> _evicted_programs{};            ///< deleted once they are not running anymore
 
         // debug:
         bool _ir_dump{false};                                       ///< print IR on logs if enabled
@@ -155,48 +516,142 @@ namespace DSPJIT {
          * \brief Compile the process function
          * \param input_nodes the nodes which represents the graph inputs
          * \param output_nodes the nodes which represents the graph outputs
+         * \param symbol the process function symbol
+         * \param vector_width the number of instances processed at once
+         * \param memory_manager the memory manager providing the states
+         * \param composite_functions the composite function cache, null if composite nodes are inlined
+         * \param report if not null, the graph level optimization measures are set in the report
+         * \param region_table_argument if true, the function takes the sequence region table as last argument
+         * \param constant_parameters if true, the parameters are compiled as constants with their current value
          * \return the IR process function
          */
         llvm::Function *_compile_process_function(
-            node_ref_list input_nodes,
-            node_ref_list output_nodes,
-            llvm::Module& graph_module);
+            node_ref_range input_nodes,
+            node_ref_range output_nodes,
+            llvm::Module& graph_module,
+            const std::string& symbol,
+            unsigned int vector_width,
+            abstract_graph_memory_manager& memory_manager,
+            composite_function_cache *composite_functions,
+            compile_report *report,
+            bool region_table_argument,
+            bool constant_parameters);
+
+        /**
+         *  \brief Return the number of values of a frame
+         *  \param nodes the graph input or output nodes
+         *  \param input true if nodes are input nodes (their outputs are counted), false for output nodes
+         */
+        static std::size_t _io_count(node_ref_range nodes, bool input);
 
         /**
          *  \brief Load all nodes from the graph input array and associate them to the inputs nodes
          *  \param builder instruction builder
          *  \param input_nodes input nodes
-         *  \param input_array input value array (process function argument)
+         *  \param input_array input value array of the current frame
          */
         void _load_graph_input_values(
             graph_compiler& compiler,
-            node_ref_list input_nodes,
-            llvm::Argument *input_array);
+            node_ref_range input_nodes,
+            llvm::Value *input_array);
 
         /**
          *  \brief compute all output nodes dependencies and store the result to the graph output array
          *  \param context compilation context
          *  \param output_nodes output nodes
-         *  \param output_array output value array (process function argument)
-         *  \param instance_num the instance number value (process function parameter)
-         *  \param value the value memoize map
+         *  \param output_array output value array of the current frame
          */
         void _compile_and_store_graph_output_values(
             graph_compiler& compiler,
-            node_ref_list output_nodes,
-            llvm::Argument *output_array,
-            llvm::Value *instance_num);
+            node_ref_range output_nodes,
+            llvm::Value *output_array);
 
         /**
          * \brief the last compilation step : native code jit generation
          * \param graph_module the new module in which the graph functions have been compiled
          * \param process_func the compiled IR process function
+         * \param process_vector_func the compiled IR vector process function, can be null
          * \param initialize_func the compiled IR initialize function
+         * \param objects the module native code if it was already generated (see enable_parallel_compilation), or empty
+         * \param report the verification and native code generation measures are set in the report
+         * \return the published program
          */
-        void _emit_native_code(
+        compile_done_msg _emit_native_code(
             std::unique_ptr<llvm::Module>&& graph_module,
             llvm::Function* process_funcs,
-            initialize_functions initialize_func);
+            llvm::Function* process_vector_func,
+            initialize_functions initialize_func,
+            std::vector<std::unique_ptr<llvm::MemoryBuffer>>&& objects,
+            compile_report& report);
+
+        /**
+         * \brief Hand a program to the process threads, according to the publication mode
+         */
+        void _publish_program(const compile_done_msg& msg);
+
+        /**
+         * \brief Compute the program cache key of the current sequence, once its process functions were compiled
+         */
+        std::size_t _compute_program_key(const llvm::Module& graph_module) const;
+
+        /**
+         * \brief Keep the program published by the current sequence in the program cache
+         * \param key the program key (see _compute_program_key)
+         * \param graph_module the program module, which is now owned by the cache
+         * \param program the published program
+         * \param symbols the external symbols of the program module, before its native code was emitted
+         * \param optimization_job the program background optimizer job, with its symbols resolved. Null without tiered compilation
+         */
+        void _cache_program(
+            std::size_t key,
+            llvm::Module *graph_module,
+            const compile_done_msg& program,
+            const std::vector<std::string>& symbols,
+            const background_optimizer::job *optimization_job);
+
+        /**
+         * \brief Publish a cached program again, as the program of the current sequence
+         */
+        void _publish_cached_program(std::list<cached_program>::iterator program);
+
+        /**
+         * \brief Move the least recently used programs out of the cache, until it fits its capacity
+         */
+        void _evict_cached_programs();
+
+        /**
+         * \brief Release the native code, states and composite functions kept by a cached program
+         */
+        void _delete_cached_program(cached_program& program);
+
+        /**
+         * \brief Create the background optimizer job of a program, from its unoptimized IR code
+         * \param graph_module the graph module, before its native code is emitted
+         * \param process_func the compiled IR process function
+         * \param process_vector_func the compiled IR vector process function, can be null
+         * \param initialize_func the compiled IR initialize function
+         */
+        background_optimizer::job _create_optimization_job(
+            const llvm::Module& graph_module,
+            llvm::Function* process_func,
+            llvm::Function* process_vector_func,
+            initialize_functions initialize_funcs);
+
+        /**
+         * \brief Resolve the job external symbols : the composite functions and the states addresses
+         * \note Must be called once the program native code was emitted
+         */
+        void _resolve_optimization_job_symbols(background_optimizer::job& job);
+
+        /**
+         * \brief Submit a job, whose symbols are resolved, to the background optimizer
+         */
+        void _submit_optimization_job(background_optimizer::job&& job);
+
+        /**
+         *  \brief Cancel the current sequence, whose program was not emitted
+         */
+        void _cancel_sequence(compile_report& report);
 
         /**
          *  \brief Process an acknowledgment message
@@ -206,6 +661,18 @@ namespace DSPJIT {
          */
         void _process_ack_msg(const ack_msg msg);
 
+        /**
+         *  \brief Delete the data which is not used by any process thread anymore
+         *  \details The oldest program in use is the oldest one among the programs run by the context own process thread
+         *      and by the registered threads
+         */
+        void _free_unused_programs();
+
+        /**
+         *  \brief Delete a program which was superseded before being run by the process thread
+         */
+        void _discard_program(const compile_done_msg& msg);
+
         /*********************************************
          *   Used by Process Thread
          *********************************************/
@@ -218,7 +685,10 @@ namespace DSPJIT {
         void _process_compile_done_msg(const compile_done_msg msg);
 
         native_process_func _process_func{default_process_func};
+        native_process_func _process_vector_func{default_process_func};
         native_initialize_func _initialize_func{default_initialize_func};
+        region_table _regions{nullptr};                                 ///< region table of the running program
+        abstract_graph_memory_manager::compile_sequence_t _running_sequence{0u};   ///< sequence of the running program
 
 
         /*********************************************
@@ -227,6 +697,11 @@ namespace DSPJIT {
 
         lock_free_queue<ack_msg> _ack_msg_queue;
         lock_free_queue<compile_done_msg> _compile_done_msg_queue;
+        triple_buffer<compile_done_msg> _latest_program{};          ///< newest program, with the latest publication mode
+
+        std::atomic<const compile_done_msg*> _newest_program{nullptr};  ///< newest of the published programs
+        std::vector<process_thread*> _process_threads{};                ///< registered threads
+        std::mutex _process_threads_mutex{};                            ///< never locked by the process threads
     };
 }
 
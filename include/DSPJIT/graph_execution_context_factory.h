@@ -2,11 +2,36 @@
 #define DSPJIT_GRAPH_EXECUTION_CONTEXT_FACTORY_H_
 
 #include "llvm_legacy_execution_engine.h"
+#include "orc_execution_engine.h"
 #include "graph_memory_manager.h"
 #include "graph_execution_context.h"
 
 namespace DSPJIT
 {
+    /**
+     * \brief The native code generation backend
+     */
+    enum class execution_engine_kind {
+        llvm_legacy,    ///< MCJIT based execution engine
+        orc             ///< ORC LLJIT based execution engine
+    };
+
+    /**
+     * \brief Graph execution context construction options
+     */
+    struct graph_execution_context_options {
+        execution_engine_kind engine_kind{execution_engine_kind::llvm_legacy};
+        llvm::CodeGenOpt::Level opt_level{llvm::CodeGenOpt::Level::Default};   ///< native code generation optimization level
+        optimization_pipeline pipeline{};                                       ///< IR optimization pipeline
+        llvm::TargetOptions target_options{};
+        std::string target_cpu{};               ///< native code target cpu (x86-64, x86-64-v3, ...), the host cpu if empty
+        std::size_t instance_count{1u};
+        unsigned int compile_thread_count{0u};  ///< only used by the orc execution engine
+        bool huge_page_code_memory{false};      ///< back native code with huge pages (see code_memory_pool)
+        bool tiered_compilation{false};         ///< publish unoptimized programs first, then optimize them with opt_level in background
+        bool relocatable_states{false};         ///< reference the states through a region table given to the native code, instead of their addresses
+    };
+
     class graph_execution_context_factory
     {
         public:
@@ -15,7 +40,15 @@ namespace DSPJIT
                 llvm::CodeGenOpt::Level opt_level = llvm::CodeGenOpt::Level::Default,
                 const llvm::TargetOptions& target_options = {},
                 const std::size_t instance_count = 1u);
+
+            static graph_execution_context build(
+                llvm::LLVMContext& llvm_context,
+                const graph_execution_context_options& options);
+
+            static std::unique_ptr<abstract_execution_engine> build_execution_engine(
+                llvm::LLVMContext& llvm_context,
+                const graph_execution_context_options& options);
     };
 }
 
-#endif
\ No newline at end of file
+#endif
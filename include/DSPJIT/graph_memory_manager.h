@@ -2,7 +2,10 @@
 #define DSPJIT_GRAPH_STATE_MANAGER_H_
 
 #include <map>
+#include <mutex>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "abstract_graph_memory_manager.h"
@@ -17,6 +20,11 @@ namespace DSPJIT {
     /**
      * \class
      * \brief manage the state of a graph program accross recompilations
+     * \details States and static memory chunks are not referenced by address in the generated code,
+     * but through external symbols named after their order of first use in the sequence.
+     * This keeps the generated code relocatable : the same graph always lead to the same code.
+     * With a sequence region table, they are referenced through a table of pointers given to the sequence functions
+     * instead : the native code then does not depend on any address, and can run against the states of several managers.
      */
     class graph_memory_manager : public abstract_graph_memory_manager {
 
@@ -29,22 +37,40 @@ namespace DSPJIT {
          * \param llvm_context LLVM context used for ir code generation
          * \param instance_count The number of graph state instances to be managed
          * \param initial_sequence_number The initial compilation sequence number
+         * \param use_region_table reference states and static memory through a sequence region table instead of symbols
          */
         graph_memory_manager(
             llvm::LLVMContext& llvm_context,
             std::size_t instance_count,
-            compile_sequence_t initial_sequence_number);
+            compile_sequence_t initial_sequence_number,
+            bool use_region_table = false);
 
         void begin_sequence(const compile_sequence_t seq) override;
         initialize_functions finish_sequence(abstract_execution_engine& engine, llvm::Module& module) override;
+        void resolve_sequence_symbols(abstract_execution_engine& engine) override;
+        symbol_map get_sequence_symbols() const override;
+        std::vector<void*> get_sequence_region_table() const override;
+        sequence_statistics get_sequence_statistics() const override;
+        void define_sequence_symbols(llvm::Module& module) override;
+        std::unique_ptr<abstract_graph_memory_manager> clone_without_states() const override;
 
         void using_sequence(const compile_sequence_t seq) override;
+        void discard_sequence(const compile_sequence_t seq) override;
+        void cancel_sequence() override;
+        std::vector<const compile_node_class*> pin_sequence_states() override;
+        void unpin_states(const std::vector<const compile_node_class*>& nodes) override;
+        void release_sequence_module() override;
 
         node_state& get_or_create(const compile_node_class& node) override;
 
         void register_static_memory_chunk(const compile_node_class& node, std::vector<uint8_t>&& chunk) override;
         void free_static_memory_chunk(const compile_node_class& node) override;
         llvm::Value *get_static_memory_ref(llvm::IRBuilder<>& builder, const compile_node_class& node) override;
+        llvm::Value *get_memory_region_ref(llvm::IRBuilder<>& builder, const void *address, std::size_t size) override;
+
+        void push_memory_region_scope(llvm::Value *region_table) override;
+        void set_sequence_region_table(llvm::Value *region_table) override;
+        llvm::Value *pop_memory_region_scope(llvm::IRBuilder<>& builder) override;
 
         llvm::LLVMContext& get_llvm_context() const noexcept override;
         std::size_t get_instance_count() const noexcept override;
@@ -67,6 +93,16 @@ namespace DSPJIT {
             void add_deleted_node(node_state && state);
             void add_deleted_static_data(std::vector<uint8_t>&& data);
 
+            /**
+             * \brief Take the states and static memory chunks to be removed by another delete sequence
+             */
+            void take_deleted_data(delete_sequence& other);
+
+            /**
+             * \brief Do not delete the module from the execution engine : it is not owned by the engine anymore
+             */
+            void release_module() noexcept { _module = nullptr; }
+
         private:
             abstract_execution_engine* _engine;
             llvm::Module *_module{nullptr};
@@ -74,14 +110,48 @@ namespace DSPJIT {
             std::vector<std::vector<uint8_t>> _static_data_chunks{};    //< Static memory chunk to be removed when the sequence is over
         };
 
+        /**
+         * \brief Order cycle states by first use in the sequence, to keep the generated code deterministic
+         */
+        struct cycle_state_order {
+            bool operator()(
+                const std::pair<node_state*, unsigned int>& a,
+                const std::pair<node_state*, unsigned int>& b) const noexcept;
+        };
+
         using node_list = std::vector<const compile_node_class*>;
-        using node_set = std::set<const compile_node_class*>;
-        using cycle_state_set = std::set<std::pair<node_state*, unsigned int>>;
-        using state_map = std::map<const compile_node_class*, node_state>;
+        using node_set = std::unordered_set<const compile_node_class*>;
+        using cycle_state_set = std::set<std::pair<node_state*, unsigned int>, cycle_state_order>;
+        using state_map = std::unordered_map<const compile_node_class*, node_state>;   ///< looked up for every compiled node
         using static_memory_map = std::map<const compile_node_class*, std::vector<uint8_t>>;
         using delete_sequence_map = std::map<compile_sequence_t, delete_sequence>;
+        /**
+         * \brief A memory area referenced by the generated code
+         */
+        struct memory_region {
+            const void *address;
+            std::size_t size;
+            bool static_memory;     ///< static memory content is copied when the region is defined in a module
+        };
+
+        struct memory_region_symbol {
+            memory_region region;
+            llvm::GlobalVariable *symbol;
+        };
+
+        using memory_region_map = std::map<const void*, memory_region_symbol>;
+
+        /**
+         * \brief Memory regions referenced through a table
+         */
+        struct memory_region_scope {
+            llvm::Value *table;
+            std::map<const void*, std::size_t> indexes{};
+            std::vector<memory_region> regions{};
+        };
 
         void _trash_static_memory_chunk(static_memory_map::iterator chunk_it);
+        void _discard_sequence(const compile_sequence_t seq);
 
         llvm::Function* _compile_initialize_function(
             const std::string& symbol,
@@ -91,14 +161,25 @@ namespace DSPJIT {
 
         void _declare_used_cycle_state(node_state* state, unsigned int output_id);
 
+        /**
+         * \brief Return a reference to a memory region through the current sequence symbol bound to its address
+         */
+        llvm::Value *_get_memory_region_ref(llvm::IRBuilder<>& builder, const memory_region& region);
+
         llvm::LLVMContext& _llvm_context;
         state_map _state{};
         static_memory_map _static_memory{};
         node_list _sequence_new_nodes{};
         node_set _sequence_used_nodes{};
         cycle_state_set _sequence_used_cycle_states{};
+        memory_region_map _sequence_memory_regions{};
+        std::size_t _sequence_deleted_state_count{0u};
+        std::vector<memory_region_scope> _memory_region_scopes{};
         delete_sequence_map _delete_sequence{};
+        std::mutex _delete_sequence_mutex{};    ///< static memory chunks can be trashed while a sequence is published
+        std::map<const compile_node_class*, std::size_t> _pinned_nodes{};  ///< nodes whose state is kept, with their pin count
         const std::size_t _instance_count;
+        const bool _use_region_table;       ///< if true, the first memory region scope is the sequence region table
         compile_sequence_t _current_sequence_number;
     };
 }
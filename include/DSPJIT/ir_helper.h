@@ -2,6 +2,7 @@
 #define DSPJIT_IR_HELPER_H_
 
 #include <llvm/IR/Module.h>
+#include <llvm/IR/IRBuilder.h>
 
 namespace DSPJIT {
 
@@ -9,6 +10,27 @@ namespace DSPJIT {
     void log_function(const llvm::Function& function);
     bool check_module(const llvm::Module& module, std::string& error_string);
 
+    /**
+     * \brief Create an alloca instruction in the entry block of the function being built
+     * \note allocas must not be created inside loops as they would make the stack grow at each iteration
+     */
+    llvm::AllocaInst *create_entry_block_alloca(llvm::IRBuilder<>& builder, llvm::Type *type);
+
+    /**
+     * \brief Compute a hash of the module IR code, stable across executions
+     * \note The module identifier is not part of the hash, but its source file name is
+     */
+    std::uint64_t compute_module_hash(const llvm::Module& module);
+
+    /**
+     * \brief Give each memory object accessed by a function its own TBAA type, so that accesses to different objects
+     * are known not to alias
+     * \details Objects are the globals, the noalias arguments and the memory pointed by invariant loads (such as
+     * memory region tables entries). Accesses whose underlying object is unknown are not annotated.
+     * \note The memory pointed by different invariant loads, or by different table entries, must not overlap
+     */
+    void annotate_memory_accesses(llvm::Function& function);
+
 }
 
 #endif
\ No newline at end of file
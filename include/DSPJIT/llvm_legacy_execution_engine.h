@@ -1,30 +1,68 @@
 
 
+#include <atomic>
+#include <map>
+#include <vector>
+
 #include <llvm/ExecutionEngine/ExecutionEngine.h>
 
 #include "abstract_execution_engine.h"
 
 namespace DSPJIT
 {
+    class native_code_generator;
+    class native_code_memory_manager;
 
+    /**
+     * \class llvm_legacy_execution_engine
+     * \brief Execution engine based on LLVM MCJIT
+     * \details The modules are compiled by a code generation pipeline kept by the engine, and their objects are
+     * loaded in MCJIT. As MCJIT binds references to the newest loaded symbol of a name, functions are looked up
+     * by name right after their module is emitted.
+     */
     class llvm_legacy_execution_engine : public abstract_execution_engine
     {
     public:
         llvm_legacy_execution_engine(
             std::unique_ptr<llvm::ExecutionEngine>&& execution_engine);
 
+        /**
+         * \param llvm_context llvm context used by the modules
+         * \param opt_level native code generation optimization level
+         * \param target_options native code generation options
+         * \param memory_pool the pool from which native code memory is allocated. A new pool is created if null
+         * \param target_cpu the target cpu name (x86-64, x86-64-v3, ...). If empty, the host cpu and its features are detected
+         */
         llvm_legacy_execution_engine(
             llvm::LLVMContext& llvm_context,
             llvm::CodeGenOpt::Level opt_level,
-            const llvm::TargetOptions& target_options);
+            const llvm::TargetOptions& target_options,
+            std::shared_ptr<code_memory_pool> memory_pool = {},
+            const std::string& target_cpu = {});
+        ~llvm_legacy_execution_engine() noexcept override;
 
         void add_module(std::unique_ptr<llvm::Module>&&) override;
+        void add_shared_module(std::unique_ptr<llvm::Module>&&) override;
+        void add_compiled_module(std::unique_ptr<llvm::Module>&&, std::vector<std::unique_ptr<llvm::MemoryBuffer>>&&) override;
         void delete_module(llvm::Module*) override;
         void emit_native_code() override;
         void* get_function_pointer(llvm::Function*) override;
+        void add_global_mapping(llvm::GlobalValue*, void*) override;
+        void set_object_cache(llvm::ObjectCache*) override;
+        llvm::TargetMachine& get_target_machine() override;
+        std::size_t get_native_code_size() const noexcept override;
+        code_memory_pool::usage get_native_memory_usage() const override;
 
     private:
+        //  Not used if the engine was given to the constructor
+        std::atomic<std::size_t> _native_code_size{0u};
+        std::shared_ptr<code_memory_pool> _memory_pool{};
+        native_code_memory_manager *_memory_manager{nullptr};   ///< owned by the execution engine
+
         std::unique_ptr<llvm::ExecutionEngine> _execution_engine;
+        std::unique_ptr<native_code_generator> _code_generator{};
+        std::map<const llvm::Module*, std::unique_ptr<llvm::Module>> _modules{};    ///< not given to MCJIT
+        std::vector<std::pair<llvm::Module*, std::vector<std::unique_ptr<llvm::MemoryBuffer>>>> _pending_modules{};   ///< modules added since the last emit_native_code, with their objects if any
     };
 
 } // namespace DSPJIT
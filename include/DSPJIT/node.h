@@ -1,12 +1,17 @@
 #ifndef JITTEST_NODE_H
 #define JITTEST_NODE_H
 
+#include <cstddef>
+#include <stdexcept>
 #include <vector>
-#include <set>
-#include <functional>
 
 namespace DSPJIT {
 
+    /**
+     * \brief A graph node, with inputs connected to other nodes outputs
+     * \details Inputs are stored contiguously in the node. Each connected input is linked in the intrusive list
+     * of its source node users, so that connecting and disconnecting are O(1) and do not allocate memory.
+     */
     template <typename Derived>
     class node {
 
@@ -26,6 +31,23 @@ namespace DSPJIT {
                         plug(i._source, i._output_id);
                 }
 
+                //  Assigned inputs are re-plugged to the same source : the users list links are never copied
+                input& operator=(const input& i) noexcept
+                {
+                    if (&i != this) {
+                        if (i._source)
+                            plug(i._source, i._output_id);
+                        else
+                            unplug();
+                    }
+                    return *this;
+                }
+
+                input& operator=(input&& i) noexcept
+                {
+                    return *this = static_cast<const input&>(i);
+                }
+
                 ~input()
                 {
                     unplug();
@@ -35,8 +57,15 @@ namespace DSPJIT {
                 {
                     unplug();
                     _source = n;
-                    _source->_users.insert(std::make_pair(this, output_id));
                     _output_id = output_id;
+
+                    //  Insert at the front of the source users list
+                    auto& first_user = _source->_first_user;
+                    _next_user = first_user;
+                    if (first_user != nullptr)
+                        first_user->_previous_user = this;
+                    first_user = this;
+                    _source->_user_count++;
                 }
 
                 void unplug()
@@ -44,16 +73,29 @@ namespace DSPJIT {
                     if (_source == nullptr)
                         return;
 
-                    _source->_users.erase(std::make_pair(this, _output_id));
+                    if (_previous_user != nullptr)
+                        _previous_user->_next_user = _next_user;
+                    else
+                        _source->_first_user = _next_user;
+
+                    if (_next_user != nullptr)
+                        _next_user->_previous_user = _previous_user;
+
+                    _source->_user_count--;
                     _source = nullptr;
+                    _previous_user = nullptr;
+                    _next_user = nullptr;
                 }
 
                 auto get_output_id() const noexcept { return _output_id;   };
                 auto get_source() const noexcept { return _source;      };
+                auto get_next_user() const noexcept { return _next_user; }
 
             private:
                 Derived *_source{nullptr};
                 unsigned int _output_id{0u};
+                input *_previous_user{nullptr};     ///< users list of the source node
+                input *_next_user{nullptr};
         };
 
 
@@ -63,10 +105,13 @@ namespace DSPJIT {
             _output_count(output_count)
         {}
 
+        //  The users list links the users inputs to this node : a copy would not be linked
+        node(const node&) = delete;
+        node& operator=(const node&) = delete;
+
         virtual ~node()
         {
-            //  this avoid iterators invalidation hazard
-            for (auto it = _users.begin(); it != _users.end(); (*it++).first->unplug());
+            disconnect_users();
         }
 
         void connect(Derived& target, unsigned int target_input_id)
@@ -89,6 +134,42 @@ namespace DSPJIT {
             _input[input_id].unplug();
         }
 
+        /**
+         * \brief Disconnect all inputs
+         */
+        void disconnect_inputs() noexcept
+        {
+            for (auto& input : _input)
+                input.unplug();
+        }
+
+        /**
+         * \brief Disconnect all the inputs connected to this node outputs
+         */
+        void disconnect_users() noexcept
+        {
+            while (_first_user != nullptr)
+                _first_user->unplug();
+        }
+
+        /**
+         * \brief Connect all the inputs connected to this node outputs to the same outputs of another node
+         * \note The graph is not modified if the replacement node has less outputs than a used output
+         */
+        void replace_users(Derived& replacement)
+        {
+            if (&replacement == this)
+                return;
+
+            for (auto user = _first_user; user != nullptr; user = user->get_next_user()) {
+                if (user->get_output_id() >= replacement.get_output_count())
+                    throw std::runtime_error("Node : replace_users : invalid I/O");
+            }
+
+            while (_first_user != nullptr)
+                _first_user->plug(&replacement, _first_user->get_output_id());
+        }
+
         Derived *get_input(unsigned int input_id) const
         {
             if (input_id >= get_input_count())
@@ -129,12 +210,11 @@ namespace DSPJIT {
             if (get_output_count() > 0u) {
                 const auto removed_output_id = _output_count - 1u;
 
-                for (auto it = _users.begin(); it != _users.end();)
-                {
-                    if (it->second == removed_output_id)
-                        (*it++).first->unplug();
-                    else
-                        it++;
+                for (auto user = _first_user; user != nullptr;) {
+                    const auto next_user = user->get_next_user();
+                    if (user->get_output_id() == removed_output_id)
+                        user->unplug();
+                    user = next_user;
                 }
 
                 _output_count--;
@@ -144,8 +224,14 @@ namespace DSPJIT {
         const unsigned int get_input_count() const noexcept { return _input.size(); }
         const unsigned int get_output_count() const noexcept { return _output_count; }
 
+        /**
+         * \brief Return the number of inputs connected to this node outputs
+         */
+        std::size_t get_user_count() const noexcept { return _user_count; }
+
     private:
-        std::set<std::pair<input*, unsigned int>> _users{}; // user input, output id
+        input *_first_user{nullptr};        ///< intrusive list of the inputs connected to this node outputs
+        std::size_t _user_count{0u};
         std::vector<input> _input;
         unsigned int _output_count;
     };
@@ -40,6 +40,7 @@ namespace DSPJIT
         std::size_t _node_output_count;
         std::size_t _instance_count;
         std::size_t _size;
+        std::size_t _sequence_rank{0u};     ///< order of first use in the current sequence
     };
 }
 
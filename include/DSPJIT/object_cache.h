@@ -0,0 +1,63 @@
+#ifndef DSPJIT_OBJECT_CACHE_H_
+#define DSPJIT_OBJECT_CACHE_H_
+
+#include <string>
+
+#include <llvm/ExecutionEngine/ObjectCache.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Target/TargetMachine.h>
+
+#include "optimization_pipeline.h"
+
+namespace DSPJIT
+{
+
+    /**
+     * \class object_cache
+     * \brief Persistent on-disk cache of native code objects
+     * \details Objects are stored in a directory, one file per key. Only the modules whose identifier
+     * is a key created by compute_key are cached.
+     */
+    class object_cache : public llvm::ObjectCache
+    {
+    public:
+        /**
+         * \param directory the cache directory, created if needed
+         */
+        explicit object_cache(const std::string& directory);
+
+        /**
+         * \brief Compute the cache key of a module, from its unoptimized IR code and the code generation settings
+         * \param module the module, before optimization
+         * \param target_machine the target machine used for native code generation
+         * \param pipeline the optimization pipeline which will be run on the module
+         * \note The module source file name is part of the key, so it must not depend on the compilation sequence
+         */
+        static std::string compute_key(
+            const llvm::Module& module,
+            const llvm::TargetMachine& target_machine,
+            const optimization_pipeline& pipeline);
+
+        /**
+         * \brief Return true if an object is available for the given key
+         */
+        bool contains(const std::string& key) const;
+
+        void notifyObjectCompiled(const llvm::Module *module, llvm::MemoryBufferRef object) override;
+        std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module *module) override;
+
+        std::size_t get_hit_count() const noexcept { return _hit_count; }
+        std::size_t get_miss_count() const noexcept { return _miss_count; }
+
+    private:
+        static bool _is_key(llvm::StringRef identifier);
+        std::string _object_path(llvm::StringRef key) const;
+
+        std::string _directory;
+        std::size_t _hit_count{0u};
+        std::size_t _miss_count{0u};
+    };
+
+} // namespace DSPJIT
+
+#endif /* DSPJIT_OBJECT_CACHE_H_ */
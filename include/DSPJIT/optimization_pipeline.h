@@ -0,0 +1,38 @@
+#ifndef DSPJIT_OPTIMIZATION_PIPELINE_H_
+#define DSPJIT_OPTIMIZATION_PIPELINE_H_
+
+#include <string>
+
+namespace DSPJIT {
+
+    /**
+     * \brief The IR optimization pipeline run on the graph code before native code generation
+     */
+    struct optimization_pipeline {
+
+        /**
+         * \brief Standard optimization pipelines, as in clang/opt
+         */
+        enum class level {
+            O1,     ///< scalar cleanups, no vectorization
+            O2,     ///< O1 + loop and SLP vectorization
+            O3,     ///< O2 + aggressive inlining and loop transformations
+            Os      ///< O2 without code size increasing transformations
+        };
+
+        level preset{level::O2};
+
+        /**
+         * \brief Custom pipeline, in the textual format of the llvm PassBuilder (as with opt -passes=...)
+         * \details e.g. "function(sroa,instcombine,gvn,slp-vectorizer),globaldce". If not empty, replaces the preset.
+         */
+        std::string custom_pipeline{};
+
+        /**
+         * \brief Return the pipeline name, which identifies the generated code : the preset name or the custom pipeline
+         */
+        std::string name() const;
+    };
+}
+
+#endif /* DSPJIT_OPTIMIZATION_PIPELINE_H_ */
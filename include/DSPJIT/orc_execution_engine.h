@@ -0,0 +1,83 @@
+#ifndef DSPJIT_ORC_EXECUTION_ENGINE_H_
+#define DSPJIT_ORC_EXECUTION_ENGINE_H_
+
+#include <atomic>
+#include <map>
+#include <vector>
+
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/Target/TargetMachine.h>
+
+#include "abstract_execution_engine.h"
+
+namespace DSPJIT
+{
+    class native_code_generator;
+
+    /**
+     * \class orc_execution_engine
+     * \brief Execution engine based on LLVM ORC LLJIT
+     * \details Each module is loaded in its own JITDylib, whose code and data are owned by a resource tracker :
+     * deleting a module releases its native code memory. Symbols which are not defined by the module
+     * (libm functions, plugins symbols, ...) are lazily resolved from the current process on first lookup.
+     * Shared modules are loaded together in a dylib which is visible from every modules.
+     */
+    class orc_execution_engine : public abstract_execution_engine
+    {
+    public:
+        /**
+         * \param opt_level native code generation optimization level
+         * \param target_options native code generation options
+         * \param compile_thread_count number of threads used by the JIT to materialize (link) the native code.
+         * If zero, materialization is done on the thread calling emit_native_code
+         * \param memory_pool the pool from which native code memory is allocated. A new pool is created if null
+         * \param target_cpu the target cpu name (x86-64, x86-64-v3, ...). If empty, the host cpu and its features are detected
+         */
+        orc_execution_engine(
+            llvm::CodeGenOpt::Level opt_level,
+            const llvm::TargetOptions& target_options,
+            unsigned int compile_thread_count = 0u,
+            std::shared_ptr<code_memory_pool> memory_pool = {},
+            const std::string& target_cpu = {});
+        ~orc_execution_engine() noexcept override;
+
+        void add_module(std::unique_ptr<llvm::Module>&&) override;
+        void add_shared_module(std::unique_ptr<llvm::Module>&&) override;
+        void add_compiled_module(std::unique_ptr<llvm::Module>&&, std::vector<std::unique_ptr<llvm::MemoryBuffer>>&&) override;
+        void delete_module(llvm::Module*) override;
+        void emit_native_code() override;
+        void* get_function_pointer(llvm::Function*) override;
+        void add_global_mapping(llvm::GlobalValue*, void*) override;
+        void set_object_cache(llvm::ObjectCache*) override;
+        llvm::TargetMachine& get_target_machine() override;
+        std::size_t get_native_code_size() const noexcept override;
+        code_memory_pool::usage get_native_memory_usage() const override;
+
+    private:
+        struct loaded_module {
+            std::unique_ptr<llvm::Module> module{};
+            llvm::orc::JITDylib *dylib{nullptr};
+            llvm::orc::ResourceTrackerSP tracker{};
+            bool shared{false};
+            std::map<const llvm::Function*, void*> functions{};   ///< filled by emit_native_code
+            std::vector<std::unique_ptr<llvm::MemoryBuffer>> objects{};   ///< native code generated out of the engine, if any
+        };
+
+        llvm::orc::JITDylib& _create_module_dylib();
+        void _add_module(std::unique_ptr<llvm::Module>&& module, llvm::orc::JITDylib& dylib, bool shared);
+        void _emit_module(loaded_module& loaded);
+
+        std::atomic<std::size_t> _native_code_size{0u};   ///< updated by the jit compile threads
+        std::shared_ptr<code_memory_pool> _memory_pool;
+        std::unique_ptr<llvm::orc::LLJIT> _jit{};
+        std::unique_ptr<llvm::TargetMachine> _target_machine{};
+        std::unique_ptr<native_code_generator> _code_generator{};   ///< generates code for _target_machine
+        llvm::orc::JITDylib *_shared_dylib{nullptr};
+        std::map<const llvm::Module*, loaded_module> _modules{};
+        std::vector<llvm::Module*> _pending_modules{};      ///< modules added since the last emit_native_code
+        unsigned int _dylib_count{0u};
+    };
+
+} // namespace DSPJIT
+
+#endif /* DSPJIT_ORC_EXECUTION_ENGINE_H_ */
@@ -0,0 +1,116 @@
+#ifndef DSPJIT_PARALLEL_EXECUTOR_H_
+#define DSPJIT_PARALLEL_EXECUTOR_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "graph_execution_context.h"
+
+namespace DSPJIT {
+
+    /**
+     * \class parallel_executor
+     * \brief Process all the instances of a graph execution context on a pool of worker threads
+     * \details Instances share the same program but own separate states, so they can be processed in parallel.
+     * Each participant (the workers and the calling thread) is given a range of instances, and steals
+     * instances from the other ranges when it is done with its own. Dispatching a block and waiting for its
+     * completion neither allocate nor take locks : idle workers spin for a while, then sleep on the job epoch
+     * until the next dispatch wakes them up. The spin duration should cover the period between two blocks, so that
+     * workers are still awake when the next block is dispatched.
+     * \note process_block must be called from the context process thread, which remains the only one to call
+     * graph_execution_context::update_program
+     */
+    class parallel_executor {
+
+    public:
+        /**
+         * \brief Default idle spin duration : about a 128 frames block period at 48 kHz
+         */
+        static constexpr std::chrono::microseconds default_spin_duration{3000};
+
+        /**
+         * \param context the context whose instances are processed
+         * \param worker_count the number of worker threads. The calling thread also processes instances
+         * \param pin_threads pin each worker thread on its own cpu core
+         * \param spin_duration how long an idle worker polls for the next job before going to sleep
+         */
+        parallel_executor(
+            graph_execution_context& context,
+            std::size_t worker_count,
+            bool pin_threads = true,
+            std::chrono::microseconds spin_duration = default_spin_duration);
+
+        parallel_executor(const parallel_executor&) = delete;
+        parallel_executor(parallel_executor&&) = delete;
+        ~parallel_executor() noexcept;
+
+        /**
+         * \brief Run the current process program on a block for every instances and wait for completion
+         * \param inputs instances input blocks : the block of instance i starts at inputs + i * input_stride
+         * \param input_stride distance between two instances input blocks, in floats
+         * \param outputs instances output blocks : the block of instance i starts at outputs + i * output_stride
+         * \param output_stride distance between two instances output blocks, in floats
+         * \param frame_count number of frames to be processed
+         * \note blocks layout is the one used by graph_execution_context::process_block
+         */
+        void process_block(
+            const float *inputs, std::size_t input_stride,
+            float *outputs, std::size_t output_stride,
+            std::size_t frame_count) noexcept;
+
+        /**
+         * \brief Return the number of worker threads
+         */
+        std::size_t get_worker_count() const noexcept { return _workers.size(); }
+
+    private:
+        /**
+         * \brief A participant instance range. Cache line aligned to avoid false sharing between cursors
+         */
+        struct alignas(64) instance_range {
+            std::atomic<std::size_t> next{0u};
+            std::size_t end{0u};
+        };
+
+        struct job {
+            const float *inputs{nullptr};
+            std::size_t input_stride{0u};
+            float *outputs{nullptr};
+            std::size_t output_stride{0u};
+            std::size_t frame_count{0u};
+        };
+
+        void _worker_main(std::size_t participant);
+        void _wait_for_job(std::uint32_t epoch) noexcept;
+        void _wake_workers() noexcept;
+        void _sleep_on_epoch(std::uint32_t epoch) noexcept;
+        void _notify_epoch() noexcept;
+        void _run_job(std::size_t participant) noexcept;
+        void _process_range(instance_range& range) noexcept;
+        static void _pin_current_thread(std::size_t cpu);
+
+        graph_execution_context& _context;
+        std::unique_ptr<instance_range[]> _ranges;          ///< one range per participant, the last one is the caller's
+        const bool _pin_threads;
+        const std::chrono::microseconds _spin_duration;
+        std::vector<std::thread> _workers{};
+        job _job{};                                         ///< written by the caller before each dispatch
+
+        alignas(64) std::atomic<std::uint32_t> _job_epoch{0u};  ///< incremented at each dispatch, workers sleep on it
+        alignas(64) std::atomic<std::size_t> _pending_workers{0u};
+        alignas(64) std::atomic<std::size_t> _sleeping_workers{0u};
+        std::atomic<bool> _running{true};
+
+        //  Only used on platforms without an address wait primitive
+        std::mutex _sleep_mutex{};
+        std::condition_variable _sleep_condition{};
+    };
+}
+
+#endif /* DSPJIT_PARALLEL_EXECUTOR_H_ */
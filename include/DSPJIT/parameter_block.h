@@ -0,0 +1,132 @@
+#ifndef DSPJIT_PARAMETER_BLOCK_H_
+#define DSPJIT_PARAMETER_BLOCK_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace DSPJIT {
+
+    /**
+     * \class parameter_block
+     * \brief Float values which can be changed while a program is running, without compiling it again
+     * \details The values are stored in cache line aligned memory, owned by a graph_execution_context.
+     * The program reads the values it uses once at the beginning of each process call. The values can be
+     * written from any thread, without locking.
+     * Optionally, a value which did not change for a given delay is compiled as a constant (see enable_promotion).
+     */
+    class parameter_block {
+
+        static constexpr auto cache_line_size = 64u;
+        static constexpr auto values_per_line = cache_line_size / sizeof(float);
+
+        static_assert(std::atomic<float>::is_always_lock_free);
+        static_assert(sizeof(std::atomic<float>) == sizeof(float));
+
+        struct alignas(cache_line_size) cache_line {
+            std::atomic<float> values[values_per_line];
+        };
+
+        struct slot_state {
+            std::atomic<std::chrono::steady_clock::rep> last_change{0};
+            std::atomic<bool> promoted{false};
+            bool allocated{false};
+        };
+
+    public:
+        using slot_t = std::size_t;
+        using duration = std::chrono::steady_clock::duration;
+
+        static constexpr std::size_t default_capacity = 256u;
+
+        /**
+         * \param capacity the maximum number of parameters
+         */
+        explicit parameter_block(std::size_t capacity = default_capacity);
+
+        parameter_block(const parameter_block&) = delete;
+        parameter_block(parameter_block&&) = delete;
+
+        /**
+         * \brief Reserve a slot for a new parameter
+         * \param value the parameter initial value
+         * \throw std::runtime_error if every slot is used
+         * \note Slots are allocated and released by the parameter nodes, on the thread editing the graph.
+         * They must not be allocated or released by several threads at the same time, but a compilation can be running.
+         */
+        slot_t allocate(float value);
+
+        /**
+         * \brief Release a slot, which can then be reused by another parameter
+         * \note The slot can still be read by a running program until a program which does not use it is compiled
+         */
+        void release(slot_t slot) noexcept;
+
+        /**
+         * \brief Set a parameter value, from any thread
+         */
+        void set(slot_t slot, float value) noexcept;
+
+        /**
+         * \brief Return a parameter value
+         */
+        float get(slot_t slot) const noexcept { return _value(slot).load(std::memory_order_relaxed); }
+
+        /**
+         * \brief Return the address of the values, as read by the programs. The value of slot i is at data()[i]
+         */
+        const void *data() const noexcept { return _lines.data(); }
+
+        std::size_t capacity() const noexcept { return _capacity; }
+
+        /**
+         * \brief Compile the values which did not change for a delay as constants
+         * \details A program must then be compiled again to use the new value of a promoted parameter (see promoted_value_changed)
+         * \param delay the delay after which an unchanged value is promoted to a constant
+         * \note Promotion can be enabled and disabled from any thread, while a compilation is running
+         */
+        void enable_promotion(duration delay) noexcept { _promotion_delay.store(std::max<duration::rep>(delay.count(), 0)); }
+
+        void disable_promotion() noexcept { _promotion_delay.store(promotion_disabled); }
+
+        /**
+         * \brief Return true if a value which was promoted by the last compilation has changed since
+         * \details The program then uses the previous value, until it is compiled again
+         */
+        bool promoted_value_changed() const noexcept { return _promoted_value_changed.load(); }
+
+        /**
+         * \brief Start a compilation : the values promoted by the previous compilation are not promoted anymore
+         * \note Called on the compile thread
+         */
+        void begin_compilation() noexcept;
+
+        /**
+         * \brief Promote a value to a constant if it has not changed for the promotion delay
+         * \return the promoted value, nothing if the value must be read at run time
+         * \note Called on the compile thread
+         */
+        std::optional<float> promote(slot_t slot) noexcept;
+
+    private:
+        std::atomic<float>& _value(slot_t slot) noexcept { return _lines[slot / values_per_line].values[slot % values_per_line]; }
+        const std::atomic<float>& _value(slot_t slot) const noexcept { return _lines[slot / values_per_line].values[slot % values_per_line]; }
+
+        const std::size_t _capacity;
+        std::vector<cache_line> _lines;
+        std::unique_ptr<slot_state[]> _states;
+        std::vector<slot_t> _free_slots{};
+        static constexpr duration::rep promotion_disabled = -1;
+
+        std::atomic<duration::rep> _promotion_delay{promotion_disabled};  ///< written from any thread, read by the compile thread
+        std::atomic<bool> _promoted_value_changed{false};
+    };
+
+}
+
+#endif /* DSPJIT_PARAMETER_BLOCK_H_ */
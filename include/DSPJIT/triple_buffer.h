@@ -0,0 +1,76 @@
+#ifndef DSPJIT_TRIPLE_BUFFER_H_
+#define DSPJIT_TRIPLE_BUFFER_H_
+
+#include <atomic>
+#include <optional>
+
+namespace DSPJIT
+{
+    /*  Lock free ONE Writer - ONE Reader latest value
+     *   write -> [back] <-> [middle] <-> [front] -> read
+     *   The reader only sees the newest written value : the values written since its last read are skipped.
+     */
+
+    template <class T>
+    class triple_buffer
+    {
+        static_assert(std::atomic<unsigned int>::is_always_lock_free);
+
+        static constexpr unsigned int index_mask = 3u;
+        static constexpr unsigned int new_value_flag = 4u;     ///< set in _middle when it holds a value which was not read
+
+    public:
+        triple_buffer() = default;
+        triple_buffer(const triple_buffer<T>&) = delete;
+        triple_buffer(triple_buffer<T>&&) = delete;
+
+        /**
+         * \brief Publish a value (writer thread)
+         * \return the previous value if it was never read. It will never be read
+         */
+        std::optional<T> write(const T&) noexcept;
+
+        /**
+         * \brief Get the newest value, if a value was written since the last read (reader thread)
+         * \return true if a new value was read
+         */
+        bool read(T&) noexcept;
+
+    private:
+        T m_buffers[3]{};
+        std::atomic<unsigned int> m_middle{1u};
+        unsigned int m_back{0u};
+        unsigned int m_front{2u};
+    };
+
+    template <class T>
+    std::optional<T> triple_buffer<T>::write(const T& x) noexcept
+    {
+        m_buffers[m_back] = x;
+
+        //  The previous middle buffer is now owned by the writer
+        const auto previous_middle = m_middle.exchange(m_back | new_value_flag, std::memory_order_acq_rel);
+        m_back = previous_middle & index_mask;
+
+        if (previous_middle & new_value_flag)
+            return m_buffers[m_back];
+        else
+            return std::nullopt;
+    }
+
+    template <class T>
+    bool triple_buffer<T>::read(T& x) noexcept
+    {
+        if ((m_middle.load(std::memory_order_relaxed) & new_value_flag) == 0u)
+            return false;
+
+        //  The flag can only be set by the writer, which is the only other thread
+        m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & index_mask;
+        x = m_buffers[m_front];
+
+        return true;
+    }
+
+} /* namespace DSPJIT */
+
+#endif
@@ -0,0 +1,73 @@
+#include <cstdlib>
+#include <stdexcept>
+
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/IR/LegacyPassManager.h>
+#include <llvm/MC/TargetRegistry.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Program.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <DSPJIT/log.h>
+
+#include "aot_export.h"
+
+namespace DSPJIT {
+
+    std::unique_ptr<llvm::TargetMachine> create_aot_target_machine(const llvm::TargetMachine& jit_target_machine)
+    {
+        //  Shared libraries need position independent code
+        std::unique_ptr<llvm::TargetMachine> target_machine{
+            jit_target_machine.getTarget().createTargetMachine(
+                jit_target_machine.getTargetTriple().str(),
+                jit_target_machine.getTargetCPU(),
+                jit_target_machine.getTargetFeatureString(),
+                jit_target_machine.Options,
+                llvm::Reloc::PIC_,
+                llvm::CodeModel::Small,
+                jit_target_machine.getOptLevel())};
+
+        if (!target_machine)
+            throw std::runtime_error("[aot_export] Failed to create target machine");
+
+        return target_machine;
+    }
+
+    void emit_object_file(llvm::Module& module, llvm::TargetMachine& target_machine, const std::string& path)
+    {
+        std::error_code error{};
+        llvm::raw_fd_ostream stream{path, error, llvm::sys::fs::OF_None};
+
+        if (error)
+            throw std::runtime_error("[aot_export] Failed to open " + path + " : " + error.message());
+
+        llvm::legacy::PassManager pass_manager{};
+        if (target_machine.addPassesToEmitFile(pass_manager, stream, nullptr, llvm::CGFT_ObjectFile))
+            throw std::runtime_error("[aot_export] The target cannot emit object files");
+
+        pass_manager.run(module);
+        stream.flush();
+    }
+
+    void link_shared_library(const std::string& object_path, const std::string& path)
+    {
+        const auto cc_variable = std::getenv("CC");
+        const std::string driver_name{cc_variable != nullptr ? cc_variable : "cc"};
+        auto driver = llvm::sys::findProgramByName(driver_name);
+
+        if (!driver)
+            throw std::runtime_error("[aot_export] Cannot find the C compiler driver " + driver_name + " to link the shared library");
+
+        const llvm::SmallVector<llvm::StringRef, 8u> arguments{
+            driver.get(), "-shared", "-o", path, object_path, "-lm"};
+
+        std::string error_message{};
+        const auto result =
+            llvm::sys::ExecuteAndWait(driver.get(), arguments, llvm::None, {}, 0u, 0u, &error_message);
+
+        if (result != 0)
+            throw std::runtime_error("[aot_export] Failed to link " + path + " : " + (error_message.empty() ? "linker error" : error_message));
+
+        LOG_INFO("[aot_export] Linked shared library %s\n", path.c_str());
+    }
+}
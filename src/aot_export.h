@@ -0,0 +1,29 @@
+#ifndef DSPJIT_AOT_EXPORT_H_
+#define DSPJIT_AOT_EXPORT_H_
+
+#include <memory>
+#include <string>
+
+#include <llvm/IR/Module.h>
+#include <llvm/Target/TargetMachine.h>
+
+namespace DSPJIT {
+
+    /**
+     * \brief Create a target machine generating position independent code, with the same target than a JIT target machine
+     */
+    std::unique_ptr<llvm::TargetMachine> create_aot_target_machine(const llvm::TargetMachine& jit_target_machine);
+
+    /**
+     * \brief Compile a module to an object file
+     */
+    void emit_object_file(llvm::Module& module, llvm::TargetMachine& target_machine, const std::string& path);
+
+    /**
+     * \brief Link an object file into a shared library, using the system C compiler driver (cc, or $CC)
+     */
+    void link_shared_library(const std::string& object_path, const std::string& path);
+
+}
+
+#endif /* DSPJIT_AOT_EXPORT_H_ */
@@ -0,0 +1,182 @@
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Support/MemoryBuffer.h>
+
+#include <chrono>
+
+#include <DSPJIT/background_optimizer.h>
+#include <DSPJIT/log.h>
+
+#include "ir_optimization.h"
+
+namespace DSPJIT {
+
+    background_optimizer::background_optimizer(execution_engine_builder engine_builder)
+    :   _program_queue{256},
+        _ack_queue{256},
+        _llvm_context{std::make_unique<llvm::LLVMContext>()}
+    {
+        //  The engine is created here so that construction errors are reported to the caller
+        _execution_engine = engine_builder(*_llvm_context);
+        _thread = std::thread{[this]() { _thread_main(); }};
+    }
+
+    background_optimizer::~background_optimizer() noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock{_job_mutex};
+            _running = false;
+        }
+        _job_condition.notify_one();
+        _thread.join();
+    }
+
+    void background_optimizer::begin_sequence(compile_sequence_t seq) noexcept
+    {
+        _latest_sequence.store(seq);
+    }
+
+    void background_optimizer::submit(job&& job)
+    {
+        {
+            std::lock_guard<std::mutex> lock{_job_mutex};
+            _pending_job = std::move(job);
+        }
+        _job_condition.notify_one();
+    }
+
+    bool background_optimizer::get_optimized_program(compile_sequence_t running_seq, program& program) noexcept
+    {
+        //  Only keep the latest optimized program
+        background_optimizer::program dequeued_program;
+        while (_program_queue.dequeue(dequeued_program))
+            _available_program = dequeued_program;
+
+        if (!_available_program.has_value()) {
+            return false;
+        }
+        else if (_available_program->seq == running_seq) {
+            program = _available_program.value();
+            _available_program.reset();
+            return true;
+        }
+        else {
+            //  Drop the optimized program if it is outdated, or keep it until its sequence is running
+            if (_available_program->seq < running_seq)
+                _available_program.reset();
+            return false;
+        }
+    }
+
+    void background_optimizer::using_sequence(compile_sequence_t seq) noexcept
+    {
+        //  If the queue is full, the programs will be deleted at the next acknowledgment
+        _ack_queue.enqueue(seq);
+    }
+
+    void background_optimizer::_thread_main()
+    {
+        for (;;) {
+            job job;
+
+            {
+                std::unique_lock<std::mutex> lock{_job_mutex};
+                _job_condition.wait(lock, [this]() { return !_running || _pending_job.has_value(); });
+
+                if (!_running)
+                    break;
+
+                job = std::move(_pending_job.value());
+                _pending_job.reset();
+            }
+
+            //  Delete the programs which are not used anymore
+            compile_sequence_t ack;
+            while (_ack_queue.dequeue(ack)) {
+                for (auto it = _modules.begin(); it != _modules.end() && it->first < ack;) {
+                    _execution_engine->delete_module(it->second);
+                    it = _modules.erase(it);
+                }
+            }
+
+            try {
+                const auto program = _compile(job);
+
+                if (program.has_value()) {
+                    if (_program_queue.enqueue(program.value())) {
+                        LOG_DEBUG("[background_optimizer][background thread] Send optimized program to process thread (seq = %u)\n", job.seq);
+                    }
+                    else {
+                        LOG_ERROR("[background_optimizer][background thread] Cannot send optimized program to process thread : queue is full !\n");
+                    }
+                }
+            }
+            catch (const std::exception& error) {
+                LOG_ERROR("[background_optimizer][background thread] Failed to optimize program (seq = %u) : %s\n", job.seq, error.what());
+            }
+        }
+    }
+
+    std::optional<background_optimizer::program> background_optimizer::_compile(const job& job)
+    {
+        if (_is_cancelled(job))
+            return std::nullopt;
+
+        const auto begin = std::chrono::steady_clock::now();
+
+        auto buffer = llvm::MemoryBuffer::getMemBuffer(job.bitcode, "", false);
+        auto module = llvm::parseBitcodeFile(buffer->getMemBufferRef(), *_llvm_context);
+
+        if (!module)
+            throw std::runtime_error("Failed to load program bitcode : " + llvm::toString(module.takeError()));
+
+        run_optimization(**module, job.pipeline, _execution_engine->get_target_machine());
+
+        if (_is_cancelled(job))
+            return std::nullopt;
+
+        auto& engine = *_execution_engine;
+        const auto module_ptr = module->get();
+        engine.add_module(std::move(*module));
+        _modules.emplace(job.seq, module_ptr);
+
+        //  The optimized program use the same states than the unoptimized one
+        for (const auto& symbol : job.symbols) {
+            if (auto global = module_ptr->getNamedValue(symbol.first))
+                engine.add_global_mapping(global, symbol.second);
+        }
+
+        engine.emit_native_code();
+
+        if (_is_cancelled(job))
+            return std::nullopt;
+
+        const auto get_function_pointer =
+            [&engine, module_ptr](const std::string& symbol) -> void*
+            {
+                if (symbol.empty())
+                    return nullptr;
+                else
+                    return engine.get_function_pointer(module_ptr->getFunction(symbol));
+            };
+
+        const auto end = std::chrono::steady_clock::now();
+        LOG_INFO("[background_optimizer][background thread] program optimization finished (%u ms)\n",
+            static_cast<unsigned int>(std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count()));
+
+        return program{
+            job.seq,
+            get_function_pointer(job.process_symbol),
+            get_function_pointer(job.process_vector_symbol),
+            get_function_pointer(job.initialize_symbol)};
+    }
+
+    bool background_optimizer::_is_cancelled(const job& job) const noexcept
+    {
+        const auto cancelled = (job.seq != _latest_sequence.load());
+
+        if (cancelled)
+            LOG_DEBUG("[background_optimizer][background thread] Cancel program optimization (seq = %u)\n", job.seq);
+
+        return cancelled;
+    }
+}
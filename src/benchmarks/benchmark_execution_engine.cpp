@@ -0,0 +1,206 @@
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <llvm/AsmParser/Parser.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/Support/SourceMgr.h>
+
+#include <DSPJIT/graph_execution_context_factory.h>
+#include <DSPJIT/common_nodes.h>
+
+using namespace llvm;
+using namespace DSPJIT;
+
+/**
+ *
+ *      Execution engines : compile latency and throughput
+ *
+ **/
+
+/**
+ *  A chain of one pole low pass filters : y = x + 0.5 * y[n-1]
+ */
+class one_pole_chain {
+
+public:
+    explicit one_pole_chain(std::size_t stage_count)
+    {
+        compile_node_class *previous = &input;
+
+        for (auto i = 0u; i < stage_count; ++i) {
+            auto& add = _create<add_node>();
+            auto& mul = _create<mul_node>();
+            auto& delay = _create<last_node>();
+            auto& coef = _create<constant_node>(0.5f);
+
+            previous->connect(add, 0u);
+            add.connect(delay, 0u);
+            delay.connect(mul, 0u);
+            coef.connect(mul, 1u);
+            mul.connect(add, 1u);
+
+            previous = &add;
+        }
+
+        previous->connect(output, 0u);
+    }
+
+    compile_node_class input{0u, 1u};
+    compile_node_class output{1u, 0u};
+
+private:
+    template <typename TNode, typename ...TArgs>
+    TNode& _create(TArgs&& ...args)
+    {
+        auto node = std::make_unique<TNode>(std::forward<TArgs>(args)...);
+        auto& ref = *node;
+        _nodes.emplace_back(std::move(node));
+        return ref;
+    }
+
+    std::vector<std::unique_ptr<compile_node_class>> _nodes{};
+};
+
+static void benchmark_context(
+    const std::string& name, const graph_execution_context_options& options,
+    std::size_t stage_count = 64u, std::size_t partition_count = 0u)
+{
+    constexpr auto block_size = 256u;
+
+    LLVMContext llvm_context;
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context, options);
+
+    context.enable_parallel_compilation(partition_count, 0u);
+
+    one_pole_chain graph{stage_count};
+
+    BENCHMARK(name + " : compile latency")
+    {
+        context.compile({graph.input}, {graph.output});
+        context.update_program();
+    };
+
+    std::vector<float> input(block_size, 1.f);
+    std::vector<float> output(block_size);
+
+    BENCHMARK(name + " : process block throughput")
+    {
+        context.process_block(0u, input.data(), output.data(), block_size);
+        return output[0];
+    };
+}
+
+static void benchmark_engine(const char *name, execution_engine_kind engine_kind)
+{
+    graph_execution_context_options options{};
+    options.engine_kind = engine_kind;
+    options.compile_thread_count = engine_kind == execution_engine_kind::orc ? 2u : 0u;
+
+    benchmark_context(name, options);
+}
+
+static void benchmark_pipeline(const char *name, optimization_pipeline::level preset)
+{
+    graph_execution_context_options options{};
+    options.pipeline.preset = preset;
+
+    benchmark_context(name, options);
+}
+
+static void benchmark_state_addressing(const char *name, bool relocatable_states)
+{
+    graph_execution_context_options options{};
+    options.relocatable_states = relocatable_states;
+
+    benchmark_context(name, options);
+}
+
+static void benchmark_parallel_compilation(const char *name, std::size_t partition_count)
+{
+    benchmark_context(name, graph_execution_context_options{}, 2048u, partition_count);
+}
+
+/**
+ *  A library of small functions, as provided by an application to its nodes
+ */
+static std::unique_ptr<Module> create_library(LLVMContext& llvm_context, std::size_t function_count)
+{
+    std::string ir_code{};
+
+    for (auto i = 0u; i < function_count; ++i) {
+        const auto index = std::to_string(i);
+        ir_code +=
+            "define float @library_function_" + index + "(float %x) {\n"
+            "  %y = fmul float %x, " + index + ".0\n"
+            "  %z = fadd float %y, 1.0\n"
+            "  ret float %z\n"
+            "}\n";
+    }
+
+    SMDiagnostic error;
+    auto module = parseAssemblyString(ir_code, error, llvm_context);
+    REQUIRE(module);
+    return module;
+}
+
+static void benchmark_fixed_cost(const char *name, execution_engine_kind engine_kind)
+{
+    LLVMContext llvm_context;
+    graph_execution_context_options options{};
+    options.engine_kind = engine_kind;
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context, options);
+
+    context.add_library_module(create_library(llvm_context, 256u));
+
+    compile_node_class in{0u, 1u}, out{1u, 0u};
+    add_node add;
+
+    in.connect(add, 0u);
+    in.connect(add, 1u);
+    add.connect(out, 0u);
+
+    BENCHMARK(std::string{name} + " : compile a single node graph")
+    {
+        context.compile({in}, {out});
+        context.update_program();
+    };
+}
+
+TEST_CASE("execution engines : compile latency and throughput", "[benchmark]")
+{
+    benchmark_engine("mcjit", execution_engine_kind::llvm_legacy);
+    benchmark_engine("orc", execution_engine_kind::orc);
+}
+
+TEST_CASE("optimization pipelines : compile latency and throughput", "[benchmark]")
+{
+    benchmark_pipeline("O1", optimization_pipeline::level::O1);
+    benchmark_pipeline("O2", optimization_pipeline::level::O2);
+    benchmark_pipeline("O3", optimization_pipeline::level::O3);
+    benchmark_pipeline("Os", optimization_pipeline::level::Os);
+}
+
+TEST_CASE("state addressing : compile latency and throughput", "[benchmark]")
+{
+    benchmark_state_addressing("symbols", false);
+    benchmark_state_addressing("region table", true);
+}
+
+TEST_CASE("parallel compilation : compile latency and throughput", "[benchmark]")
+{
+    benchmark_parallel_compilation("single partition", 0u);
+    benchmark_parallel_compilation("4 partitions", 4u);
+    benchmark_parallel_compilation("16 partitions", 16u);
+}
+
+TEST_CASE("compilation fixed cost", "[benchmark]")
+{
+    benchmark_fixed_cost("mcjit", execution_engine_kind::llvm_legacy);
+    benchmark_fixed_cost("orc", execution_engine_kind::orc);
+}
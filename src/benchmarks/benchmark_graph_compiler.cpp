@@ -0,0 +1,121 @@
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+
+#include <DSPJIT/graph_compiler.h>
+#include <DSPJIT/graph_memory_manager.h>
+#include <DSPJIT/common_nodes.h>
+
+using namespace llvm;
+using namespace DSPJIT;
+
+/**
+ *
+ *      Graph compiler : graph construction, traversal and IR emission time, by graph size
+ *
+ **/
+
+/**
+ *  A large graph : stage n = stage n-1 + stage n/2 + (stage n)[n-1], with a delay every 8 stages
+ */
+class large_graph {
+
+public:
+    explicit large_graph(std::size_t stage_count)
+    {
+        std::vector<compile_node_class*> stages{&input};
+
+        for (auto i = 1u; i <= stage_count; ++i) {
+            auto& add = _create<add_node>();
+            auto& mul = _create<mul_node>();
+
+            stages.back()->connect(add, 0u);
+            stages[i / 2u]->connect(add, 1u);
+            add.connect(mul, 0u);
+
+            if (i % 8u == 0u) {
+                auto& delay = _create<last_node>();
+                mul.connect(delay, 0u);
+                delay.connect(mul, 1u);
+            }
+            else {
+                stages[i / 2u]->connect(mul, 1u);
+            }
+
+            stages.push_back(&mul);
+        }
+
+        stages.back()->connect(output, 0u);
+    }
+
+    compile_node_class input{0u, 1u};
+    compile_node_class output{1u, 0u};
+
+private:
+    template <typename TNode, typename ...TArgs>
+    TNode& _create(TArgs&& ...args)
+    {
+        auto node = std::make_unique<TNode>(std::forward<TArgs>(args)...);
+        auto& ref = *node;
+        _nodes.emplace_back(std::move(node));
+        return ref;
+    }
+
+    std::vector<std::unique_ptr<compile_node_class>> _nodes{};
+};
+
+static void benchmark_graph_size(std::size_t stage_count)
+{
+    LLVMContext llvm_context;
+    graph_memory_manager memory_manager{llvm_context, 1u, 0u};
+    large_graph graph{stage_count};
+    auto sequence = 0u;
+
+    BENCHMARK(std::to_string(stage_count * 2u) + " nodes : graph construction")
+    {
+        large_graph other_graph{stage_count};
+        return other_graph.input.get_user_count();
+    };
+
+    BENCHMARK_ADVANCED(std::to_string(stage_count * 2u) + " nodes : graph compilation")(Catch::Benchmark::Chronometer meter)
+    {
+        //  Modules are created and deleted out of the measure : only the graph compilation is measured
+        std::vector<std::unique_ptr<Module>> modules{};
+        std::vector<Function*> functions{};
+
+        for (auto i = 0; i < meter.runs(); ++i) {
+            modules.push_back(std::make_unique<Module>("benchmark", llvm_context));
+            functions.push_back(
+                Function::Create(
+                    FunctionType::get(Type::getVoidTy(llvm_context), {Type::getInt64Ty(llvm_context)}, false),
+                    Function::ExternalLinkage, "graph__process", modules.back().get()));
+            BasicBlock::Create(llvm_context, "entry", functions.back());
+        }
+
+        meter.measure([&](int run)
+        {
+            const auto function = functions[run];
+            IRBuilder<> builder{&function->getEntryBlock()};
+
+            memory_manager.begin_sequence(++sequence);
+
+            graph_compiler compiler{builder, function->getArg(0u), memory_manager};
+            compiler.assign_values(&graph.input, {compiler.create_constant(1.f)});
+            return compiler.node_value(graph.output.get_input(0u), 0u);
+        });
+    };
+}
+
+TEST_CASE("graph compiler : compile time scaling", "[benchmark]")
+{
+    benchmark_graph_size(1000u);
+    benchmark_graph_size(10000u);
+    benchmark_graph_size(100000u);
+    benchmark_graph_size(300000u);
+}
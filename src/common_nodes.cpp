@@ -1,4 +1,6 @@
 
+#include <cstring>
+
 #include <llvm/IR/Constants.h>
 #include <llvm/IR/IRBuilder.h>
 
@@ -16,8 +18,13 @@ namespace DSPJIT {
         const std::vector<llvm::Value*>& inputs,
         llvm::Value*, llvm::Value*) const
     {
-        using namespace llvm;
-        return {ConstantFP::get(compiler.builder().getContext(), APFloat(_value))};
+        return {compiler.create_constant(_value)};
+    }
+
+    bool constant_node::is_equivalent(const compile_node_class& other) const noexcept
+    {
+        const auto other_constant = dynamic_cast<const constant_node*>(&other);
+        return other_constant != nullptr && std::memcmp(&_value, &other_constant->_value, sizeof(float)) == 0;
     }
 
     // Reference
@@ -31,7 +38,28 @@ namespace DSPJIT {
             llvm::ConstantInt::get(builder.getIntNTy(sizeof(float*)*8), reinterpret_cast<intptr_t>(_ref)),
             llvm::Type::getFloatPtrTy(builder.getContext()));
 
-        return {builder.CreateLoad(builder.getFloatTy(), ptr)};
+        return {compiler.broadcast(builder.CreateLoad(builder.getFloatTy(), ptr))};
+    }
+
+    // Parameter
+    parameter_node::parameter_node(parameter_block& parameters, float value)
+    :   compile_node_class{0u, 1u},
+        _parameters{parameters},
+        _slot{parameters.allocate(value)}
+    {
+    }
+
+    parameter_node::~parameter_node() noexcept
+    {
+        _parameters.release(_slot);
+    }
+
+    std::vector<llvm::Value*> parameter_node::emit_outputs(
+        graph_compiler& compiler,
+        const std::vector<llvm::Value*>& inputs,
+        llvm::Value*, llvm::Value*) const
+    {
+        return {compiler.parameter_value(_parameters, _slot)};
     }
 
     // Reference multiply node
@@ -45,7 +73,7 @@ namespace DSPJIT {
             llvm::ConstantInt::get(builder.getIntNTy(sizeof(float*)*8), reinterpret_cast<intptr_t>(_ref)),
             llvm::Type::getFloatPtrTy(builder.getContext()));
 
-        return {builder.CreateFMul(builder.CreateLoad(builder.getFloatTy(), ptr), inputs[0])};
+        return {builder.CreateFMul(compiler.broadcast(builder.CreateLoad(builder.getFloatTy(), ptr)), inputs[0])};
     }
 
     // Add
@@ -93,9 +121,11 @@ namespace DSPJIT {
         llvm::Value *mutable_state,
         llvm::Value *static_memory) const
     {
+        // Lanes states are contiguous floats
         auto& builder = compiler.builder();
-        auto state_ptr = builder.CreateBitCast(mutable_state, llvm::Type::getFloatPtrTy(builder.getContext()));
-        return {builder.CreateLoad(builder.getFloatTy(), state_ptr)};
+        const auto type = compiler.value_type();
+        auto state_ptr = builder.CreateBitCast(mutable_state, type->getPointerTo());
+        return {builder.CreateAlignedLoad(type, state_ptr, llvm::Align{alignof(float)})};
     }
 
     void last_node::push_input(
@@ -105,8 +135,8 @@ namespace DSPJIT {
         llvm::Value *static_memory) const
     {
         auto& builder = compiler.builder();
-        auto state_ptr = builder.CreateBitCast(mutable_state, llvm::Type::getFloatPtrTy(builder.getContext()));
-        builder.CreateStore(inputs[0], state_ptr);
+        auto state_ptr = builder.CreateBitCast(mutable_state, compiler.value_type()->getPointerTo());
+        builder.CreateAlignedStore(inputs[0], state_ptr, llvm::Align{alignof(float)});
     }
 
     // invert
@@ -116,8 +146,7 @@ namespace DSPJIT {
         llvm::Value*, llvm::Value*) const
     {
         auto& builder = compiler.builder();
-        return {builder.CreateFDiv(
-            llvm::ConstantFP::get(builder.getFloatTy(), 1.), inputs[0])};
+        return {builder.CreateFDiv(compiler.create_constant(1.f), inputs[0])};
     }
 
     // negate
@@ -0,0 +1,121 @@
+#include <iterator>
+
+#include <DSPJIT/compile_service.h>
+#include <DSPJIT/log.h>
+
+namespace DSPJIT {
+
+    compile_service::compile_service(
+        graph_execution_context& context,
+        std::chrono::microseconds debounce_delay)
+    :   _context{context},
+        _debounce_delay{debounce_delay}
+    {
+        _thread = std::thread{[this]() { _thread_main(); }};
+    }
+
+    compile_service::~compile_service() noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock{_request_mutex};
+            _running = false;
+        }
+        _request_condition.notify_one();
+        _thread.join();
+    }
+
+    std::unique_lock<std::mutex> compile_service::lock_graph()
+    {
+        return std::unique_lock<std::mutex>{_graph_mutex};
+    }
+
+    std::future<compile_report> compile_service::request(node_ref_vector input_nodes, node_ref_vector output_nodes)
+    {
+        std::promise<compile_report> promise{};
+        auto future = promise.get_future();
+
+        {
+            std::lock_guard<std::mutex> lock{_request_mutex};
+
+            //  The newest request replaces the pending one, which it covers
+            if (!_pending_request.has_value())
+                _pending_request.emplace();
+
+            _pending_request->id = ++_last_request_id;
+            _pending_request->input_nodes = std::move(input_nodes);
+            _pending_request->output_nodes = std::move(output_nodes);
+            _pending_request->promises.push_back(std::move(promise));
+            _last_request_time = std::chrono::steady_clock::now();
+        }
+
+        _request_condition.notify_one();
+        return future;
+    }
+
+    void compile_service::_thread_main()
+    {
+        for (;;) {
+            pending_request request;
+
+            {
+                std::unique_lock<std::mutex> lock{_request_mutex};
+                _request_condition.wait(lock, [this]() { return !_running || _pending_request.has_value(); });
+
+                //  Wait until the requests stop for the debounce delay
+                while (_running && std::chrono::steady_clock::now() < _last_request_time + _debounce_delay)
+                    _request_condition.wait_until(lock, _last_request_time + _debounce_delay);
+
+                if (!_running)
+                    return;
+
+                request = std::move(*_pending_request);
+                _pending_request.reset();
+            }
+
+            _compile(std::move(request));
+        }
+    }
+
+    void compile_service::_compile(pending_request&& request)
+    {
+        auto graph_lock = lock_graph();
+
+        graph_execution_context::compile_hooks hooks{};
+        hooks.graph_compiled = [&graph_lock]() { graph_lock.unlock(); };
+        hooks.cancelled =
+            [this, id = request.id]()
+            {
+                return !_running || _last_request_id.load() != id;
+            };
+
+        try {
+            const auto report = _context.compile(request.input_nodes, request.output_nodes, hooks);
+
+            if (graph_lock.owns_lock())
+                graph_lock.unlock();
+
+            if (report.cancelled) {
+                LOG_DEBUG("[compile_service] Compilation of request %lu cancelled by a newer request\n", request.id);
+
+                //  The newer request covers the cancelled ones. They are abandoned if the service was stopped
+                std::lock_guard<std::mutex> lock{_request_mutex};
+                if (_pending_request.has_value()) {
+                    auto& promises = _pending_request->promises;
+                    promises.insert(
+                        promises.end(),
+                        std::make_move_iterator(request.promises.begin()),
+                        std::make_move_iterator(request.promises.end()));
+                }
+            }
+            else {
+                LOG_DEBUG("[compile_service] Published request %lu (seq = %u)\n", request.id, report.seq);
+                for (auto& promise : request.promises)
+                    promise.set_value(report);
+            }
+        }
+        catch (...) {
+            for (auto& promise : request.promises)
+                promise.set_exception(std::current_exception());
+        }
+    }
+}
@@ -0,0 +1,218 @@
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/xxhash.h>
+
+#include <DSPJIT/composite_function_cache.h>
+#include <DSPJIT/composite_node.h>
+#include <DSPJIT/graph_compiler.h>
+#include <DSPJIT/ir_helper.h>
+#include <DSPJIT/log.h>
+#include <DSPJIT/object_cache.h>
+
+#include "ir_optimization.h"
+#include "library_linking.h"
+
+namespace DSPJIT {
+
+    composite_function_cache::composite_function_cache(
+        abstract_execution_engine& execution_engine,
+        abstract_graph_memory_manager& memory_manager,
+        const llvm::Module& library,
+        ir_optimizer& optimizer)
+    :   _execution_engine{execution_engine},
+        _memory_manager{memory_manager},
+        _library{library},
+        _optimizer{optimizer}
+    {
+    }
+
+    std::vector<llvm::Value*> composite_function_cache::emit_call(
+        graph_compiler& compiler,
+        const composite_node& node,
+        const std::vector<llvm::Value*>& inputs)
+    {
+        auto& builder = compiler.builder();
+
+        //  Compile the function in its own module. The module name is part of the function hash
+        auto module = declare_library(_library, "composite_function");
+
+        const auto function = _compile_function(compiler, node, *module);
+        const auto function_type = function->getFunctionType();
+        const auto region_table = _memory_manager.pop_memory_region_scope(builder);
+        link_library_dependencies(*module, _library);
+
+        //  Only the composite function is called from outside
+        for (auto& module_function : *module) {
+            if (!module_function.isDeclaration() && &module_function != function)
+                module_function.setLinkage(llvm::GlobalValue::LinkageTypes::InternalLinkage);
+        }
+
+        //  The function native code also depends on the optimization pipeline
+        const auto symbol =
+            "composite__" + llvm::utohexstr(compute_module_hash(*module) ^ llvm::xxHash64(_optimizer.get_pipeline().name()), true);
+        auto function_it = _functions.find(symbol);
+
+        if (function_it == _functions.end()) {
+            LOG_DEBUG("[composite_function_cache][compile thread] Compile function %s\n", symbol.c_str());
+
+            function->setName(symbol);
+
+            std::string error_string;
+            if (check_module(*module, error_string))
+                throw std::runtime_error("[composite_function_cache][Compile Thread] Malformed IR code was detected in composite module: " + error_string);
+
+            //  The execution engine looks up and stores the native code of modules named after a cache key
+            if (_object_cache != nullptr)
+                module->setModuleIdentifier(
+                    object_cache::compute_key(*module, _execution_engine.get_target_machine(), _optimizer.get_pipeline()));
+
+            _optimizer.run(*module);
+
+            const auto module_ptr = module.get();
+            _execution_engine.add_shared_module(std::move(module));
+            function_it = _functions.emplace(symbol, function_entry{module_ptr, _current_sequence}).first;
+        }
+        else {
+            //  The function was already compiled : the new module is dropped
+            function_it->second.last_used_sequence = _current_sequence;
+        }
+
+        //  Pass the I/O values through arrays
+        const auto value_type = compiler.value_type();
+        const auto input_array_type = llvm::ArrayType::get(value_type, inputs.size());
+        const auto output_array_type = llvm::ArrayType::get(value_type, node.get_output_count());
+        const auto input_array = create_entry_block_alloca(builder, input_array_type);
+        const auto output_array = create_entry_block_alloca(builder, output_array_type);
+
+        for (auto i = 0u; i < inputs.size(); ++i)
+            builder.CreateStore(inputs[i], builder.CreateConstInBoundsGEP2_64(input_array_type, input_array, 0u, i));
+
+        const auto callee =
+            builder.GetInsertBlock()->getModule()->getOrInsertFunction(symbol, function_type);
+
+        builder.CreateCall(
+            callee,
+            {
+                compiler.instance_num(),
+                builder.CreateConstInBoundsGEP2_64(input_array_type, input_array, 0u, 0u),
+                builder.CreateConstInBoundsGEP2_64(output_array_type, output_array, 0u, 0u),
+                region_table
+            });
+
+        std::vector<llvm::Value*> output_values(node.get_output_count());
+
+        for (auto i = 0u; i < output_values.size(); ++i)
+            output_values[i] =
+                builder.CreateLoad(value_type, builder.CreateConstInBoundsGEP2_64(output_array_type, output_array, 0u, i));
+
+        return output_values;
+    }
+
+    void *composite_function_cache::get_function_pointer(const std::string& symbol) const
+    {
+        const auto function_it = _functions.find(symbol);
+
+        if (function_it == _functions.end())
+            return nullptr;
+        else
+            return _execution_engine.get_function_pointer(function_it->second.module->getFunction(symbol));
+    }
+
+    bool composite_function_cache::pin_function(const std::string& symbol)
+    {
+        const auto function_it = _functions.find(symbol);
+
+        if (function_it == _functions.end())
+            return false;
+
+        function_it->second.pin_count++;
+        return true;
+    }
+
+    void composite_function_cache::unpin_function(const std::string& symbol)
+    {
+        const auto function_it = _functions.find(symbol);
+
+        if (function_it != _functions.end() && function_it->second.pin_count != 0u)
+            function_it->second.pin_count--;
+    }
+
+    void composite_function_cache::using_sequence(compile_sequence_t seq)
+    {
+        //  Functions which are not used by the running program nor by a newer one, nor pinned, can be deleted
+        for (auto it = _functions.begin(); it != _functions.end();) {
+            if (it->second.last_used_sequence < seq && it->second.pin_count == 0u) {
+                LOG_DEBUG("[composite_function_cache][compile thread] Delete function %s\n", it->first.c_str());
+                _execution_engine.delete_module(it->second.module);
+                it = _functions.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
+    llvm::Function *composite_function_cache::_compile_function(
+        graph_compiler& compiler,
+        const composite_node& node,
+        llvm::Module& module)
+    {
+        auto& llvm_context = module.getContext();
+        const auto value_ptr_type = compiler.value_type()->getPointerTo();
+
+        //  signature = void _(int64 instance_num, value_type *inputs, value_type *outputs, int8 **region_table)
+        const auto function_type =
+            llvm::FunctionType::get(
+                llvm::Type::getVoidTy(llvm_context),
+                {
+                    llvm::Type::getInt64Ty(llvm_context),
+                    value_ptr_type,
+                    value_ptr_type,
+                    llvm::Type::getInt8PtrTy(llvm_context)->getPointerTo()
+                },
+                false);
+        auto function = llvm::Function::Create(function_type, llvm::Function::ExternalLinkage, "composite", &module);
+
+        auto arg_begin = function->arg_begin();
+        auto instance_num_value = arg_begin++;
+        auto inputs_array_value = arg_begin++;
+        auto outputs_array_value = arg_begin++;
+        auto region_table_value = arg_begin++;
+
+        //  The I/O arrays are allocated by the caller, and the region table is not modified
+        for (auto argument : {inputs_array_value, outputs_array_value, region_table_value}) {
+            argument->addAttr(llvm::Attribute::NoAlias);
+            argument->addAttr(llvm::Attribute::NoCapture);
+        }
+
+        llvm::IRBuilder<> builder{llvm::BasicBlock::Create(llvm_context, "entry", function)};
+        graph_compiler function_compiler{
+            builder, instance_num_value, _memory_manager, compiler.vector_width(), this,
+            compiler.parameters(), compiler.constant_parameters()};
+        const auto value_type = function_compiler.value_type();
+
+        //  States and static memory are given by the caller
+        _memory_manager.push_memory_region_scope(region_table_value);
+
+        //  Map function inputs to the internal input node
+        std::vector<llvm::Value*> input_values(node.get_input_count());
+        for (auto i = 0u; i < input_values.size(); ++i)
+            input_values[i] = builder.CreateLoad(value_type, builder.CreateConstInBoundsGEP1_64(value_type, inputs_array_value, i));
+
+        function_compiler.assign_values(&node.input(), std::move(input_values));
+
+        //  Compute the internal output node inputs
+        const auto& output_node = node.output();
+
+        for (auto i = 0u; i < node.get_output_count(); ++i) {
+            unsigned int output_id = 0u;
+            const auto dependency_node = output_node.get_input(i, output_id);
+            builder.CreateStore(
+                function_compiler.node_value(dependency_node, output_id),
+                builder.CreateConstInBoundsGEP1_64(value_type, outputs_array_value, i));
+        }
+
+        builder.CreateRetVoid();
+        annotate_memory_accesses(*function);
+        return function;
+    }
+}
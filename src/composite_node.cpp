@@ -1,6 +1,7 @@
 
 #include <DSPJIT/composite_node.h>
 
+#include <DSPJIT/composite_function_cache.h>
 #include <DSPJIT/graph_compiler.h>
 
 namespace DSPJIT {
@@ -18,6 +19,10 @@ namespace DSPJIT {
         const std::vector<llvm::Value*>& inputs,
         llvm::Value*, llvm::Value*) const
     {
+        //  Compile the internal graph in a separate function if enabled
+        if (const auto composite_functions = compiler.composite_functions())
+            return composite_functions->emit_call(compiler, *this, inputs);
+
         //  Map composite node input value to internal input node
         compiler.assign_values(&_input, std::vector<llvm::Value*>{inputs});
 
@@ -0,0 +1,163 @@
+#include <stdexcept>
+
+#include <llvm/Support/MathExtras.h>
+#include <llvm/Support/Process.h>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#include <DSPJIT/code_memory_pool.h>
+#include <DSPJIT/log.h>
+
+namespace DSPJIT
+{
+    static constexpr auto region_size = std::size_t{256u} * 1024u;
+    static constexpr auto huge_page_size = std::size_t{2u} * 1024u * 1024u;
+
+    code_memory_pool::code_memory_pool(bool use_huge_pages)
+    :   _use_huge_pages{use_huge_pages},
+        _page_size{llvm::sys::Process::getPageSizeEstimate()}
+    {
+#if !defined(__linux__) || !defined(MADV_HUGEPAGE)
+        if (_use_huge_pages)
+            LOG_WARNING("[code_memory_pool] Huge pages are not supported on this platform\n");
+#endif
+    }
+
+    code_memory_pool::~code_memory_pool() noexcept
+    {
+        for (auto& pool : _pools) {
+            for (auto& region : pool.regions)
+                llvm::sys::Memory::releaseMappedMemory(region);
+        }
+    }
+
+    llvm::sys::MemoryBlock code_memory_pool::allocate(section_kind kind, std::size_t size)
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        auto& pool = _pools[static_cast<std::size_t>(kind)];
+        const auto block_size = llvm::alignTo(size, _page_size);
+
+        //  First fit
+        auto it = pool.free_blocks.begin();
+        for (; it != pool.free_blocks.end() && it->second < block_size; ++it);
+
+        if (it == pool.free_blocks.end())
+            it = _reserve_region(kind, block_size);
+
+        const auto address = it->first;
+        const auto free_size = it->second;
+        pool.free_blocks.erase(it);
+
+        if (free_size > block_size)
+            pool.free_blocks.emplace(address + block_size, free_size - block_size);
+
+        _usage.used_size += block_size;
+        return {address, block_size};
+    }
+
+    void code_memory_pool::protect(section_kind kind, const llvm::sys::MemoryBlock& block)
+    {
+        if (_uses_huge_pages(kind))
+            return;
+
+        if (auto error = llvm::sys::Memory::protectMappedMemory(block, _protection_flags(kind)))
+            throw std::runtime_error("[code_memory_pool] Failed to protect memory : " + error.message());
+    }
+
+    void code_memory_pool::release(section_kind kind, const llvm::sys::MemoryBlock& block)
+    {
+        //  Make the block writable again for its next use
+        if (!_uses_huge_pages(kind) && kind != section_kind::read_write_data) {
+            if (auto error = llvm::sys::Memory::protectMappedMemory(
+                    block, llvm::sys::Memory::MF_READ | llvm::sys::Memory::MF_WRITE))
+                LOG_ERROR("[code_memory_pool] Failed to unprotect memory : %s\n", error.message().c_str());
+        }
+
+        std::lock_guard<std::mutex> lock{_mutex};
+        auto& free_blocks = _pools[static_cast<std::size_t>(kind)].free_blocks;
+        auto address = static_cast<std::uint8_t*>(block.base());
+        auto size = block.allocatedSize();
+
+        _usage.used_size -= size;
+
+        //  Merge with the adjacent free blocks. Regions are never merged as they are not contiguous
+        auto next = free_blocks.lower_bound(address);
+        if (next != free_blocks.end() && address + size == next->first) {
+            size += next->second;
+            next = free_blocks.erase(next);
+        }
+
+        if (next != free_blocks.begin()) {
+            auto previous = std::prev(next);
+            if (previous->first + previous->second == address) {
+                previous->second += size;
+                return;
+            }
+        }
+
+        free_blocks.emplace(address, size);
+    }
+
+    code_memory_pool::usage code_memory_pool::get_usage() const
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        return _usage;
+    }
+
+    bool code_memory_pool::_uses_huge_pages(section_kind kind) const noexcept
+    {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+        return _use_huge_pages && kind == section_kind::code;
+#else
+        return false;
+#endif
+    }
+
+    code_memory_pool::free_block_map::iterator code_memory_pool::_reserve_region(section_kind kind, std::size_t min_size)
+    {
+        auto& pool = _pools[static_cast<std::size_t>(kind)];
+        const auto huge_pages = _uses_huge_pages(kind);
+
+        //  A huge page must be aligned on its size : reserve twice as much memory to contain at least one
+        const auto size =
+            huge_pages ?
+                llvm::alignTo(std::max(min_size, 2u * huge_page_size), huge_page_size) :
+                std::max(min_size, region_size);
+        const auto flags =
+            huge_pages ?
+                llvm::sys::Memory::MF_READ | llvm::sys::Memory::MF_WRITE | llvm::sys::Memory::MF_EXEC :
+                llvm::sys::Memory::MF_READ | llvm::sys::Memory::MF_WRITE;
+
+        std::error_code error{};
+        auto region = llvm::sys::Memory::allocateMappedMemory(size, nullptr, flags, error);
+
+        if (error)
+            throw std::runtime_error("[code_memory_pool] Failed to reserve memory : " + error.message());
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+        if (huge_pages && ::madvise(region.base(), region.allocatedSize(), MADV_HUGEPAGE) != 0)
+            LOG_WARNING("[code_memory_pool] Huge pages are not available for code memory\n");
+#endif
+
+        LOG_DEBUG("[code_memory_pool] Reserve a %lu bytes region\n", region.allocatedSize());
+
+        pool.regions.push_back(region);
+        _usage.reserved_size += region.allocatedSize();
+        return pool.free_blocks.emplace(static_cast<std::uint8_t*>(region.base()), region.allocatedSize()).first;
+    }
+
+    unsigned int code_memory_pool::_protection_flags(section_kind kind) noexcept
+    {
+        switch (kind) {
+            case section_kind::code:
+                return llvm::sys::Memory::MF_READ | llvm::sys::Memory::MF_EXEC;
+            case section_kind::read_only_data:
+                return llvm::sys::Memory::MF_READ;
+            case section_kind::read_write_data:
+            default:
+                return llvm::sys::Memory::MF_READ | llvm::sys::Memory::MF_WRITE;
+        }
+    }
+}
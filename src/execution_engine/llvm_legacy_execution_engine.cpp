@@ -1,10 +1,17 @@
 
-#include <llvm/ExecutionEngine/SectionMemoryManager.h>
+#include <algorithm>
+
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Object/ObjectFile.h>
+#include <llvm/Support/Host.h>
 #include <llvm/Support/TargetSelect.h>
 
 #include <DSPJIT/log.h>
 #include <DSPJIT/llvm_legacy_execution_engine.h>
 
+#include "native_code_generator.h"
+#include "native_code_memory_manager.h"
+
 namespace DSPJIT
 {
     static llvm::Triple _choose_native_target_triple()
@@ -20,16 +27,36 @@ namespace DSPJIT
         );
     }
 
+    /**
+     * \brief Return the host cpu features, in the llvm feature string format (+avx2, -avx512f, ...)
+     */
+    static llvm::SmallVector<std::string> _host_cpu_features()
+    {
+        llvm::SmallVector<std::string> features{};
+        llvm::StringMap<bool> host_features{};
+
+        if (llvm::sys::getHostCPUFeatures(host_features)) {
+            for (const auto& feature : host_features)
+                features.push_back((feature.second ? "+" : "-") + feature.first().str());
+        }
+
+        return features;
+    }
+
     llvm_legacy_execution_engine::llvm_legacy_execution_engine(
         std::unique_ptr<llvm::ExecutionEngine>&& execution_engine)
-    :   _execution_engine{std::move(execution_engine)}
+    :   _execution_engine{std::move(execution_engine)},
+        _code_generator{std::make_unique<native_code_generator>(*_execution_engine->getTargetMachine())}
     {
     }
 
     llvm_legacy_execution_engine::llvm_legacy_execution_engine(
         llvm::LLVMContext& llvm_context,
         llvm::CodeGenOpt::Level opt_level,
-        const llvm::TargetOptions &target_options)
+        const llvm::TargetOptions &target_options,
+        std::shared_ptr<code_memory_pool> memory_pool,
+        const std::string& target_cpu)
+    :   _memory_pool{memory_pool ? std::move(memory_pool) : std::make_shared<code_memory_pool>()}
     {
         // Initialize LLVM native target
         static auto llvm_jit_was_init = false;
@@ -42,7 +69,8 @@ namespace DSPJIT
 
         // Initialize the llvm execution engine
         auto memory_mgr =
-            std::unique_ptr<llvm::SectionMemoryManager>();
+            std::make_unique<native_code_memory_manager>(_memory_pool, _native_code_size);
+        _memory_manager = memory_mgr.get();
 
         llvm::EngineBuilder engine_builder
         {
@@ -61,32 +89,88 @@ namespace DSPJIT
                 .create(engine_builder.selectTarget(
                     _choose_native_target_triple(),
                     "" /* MArch" */,
-                    "" /* MCPU */,
-                    llvm::SmallVector<std::string>{}))};
+                    target_cpu.empty() ? llvm::sys::getHostCPUName() : llvm::StringRef{target_cpu},
+                    target_cpu.empty() ? _host_cpu_features() : llvm::SmallVector<std::string>{}))};
 
         if (!_execution_engine)
             throw std::runtime_error("Failed to initialize execution engine :" + error_string);
 
         _execution_engine->DisableLazyCompilation();
+
+        // MCJIT rebuilds its code generation pipeline for each module : the modules are compiled by the engine
+        _code_generator = std::make_unique<native_code_generator>(*_execution_engine->getTargetMachine());
     }
 
+    llvm_legacy_execution_engine::~llvm_legacy_execution_engine() noexcept = default;
+
     void llvm_legacy_execution_engine::add_module(std::unique_ptr<llvm::Module> &&module)
+    {
+        add_compiled_module(std::move(module), {});
+    }
+
+    void llvm_legacy_execution_engine::add_shared_module(std::unique_ptr<llvm::Module> &&module)
+    {
+        // MCJIT resolves symbols accross all its loaded objects
+        add_module(std::move(module));
+    }
+
+    void llvm_legacy_execution_engine::add_compiled_module(
+        std::unique_ptr<llvm::Module>&& module,
+        std::vector<std::unique_ptr<llvm::MemoryBuffer>>&& objects)
     {
         // Set a data layout matching the execution engine
         module->setDataLayout(_execution_engine->getDataLayout());
-        _execution_engine->addModule(std::move(module));
+        _pending_modules.emplace_back(module.get(), std::move(objects));
+        _modules.emplace(module.get(), std::move(module));
     }
 
     void llvm_legacy_execution_engine::delete_module(llvm::Module *module)
     {
-        if (_execution_engine->removeModule(module)) {
-            // removeModule does not delete the module instance
-            delete module;
-        }
+        const auto it = _modules.find(module);
+
+        if (it == _modules.end())
+            return;
+
+        // MCJIT can not unload objects, but their native code memory can be reused
+        if (_memory_manager != nullptr)
+            _memory_manager->release_owner(module);
+
+        _pending_modules.erase(
+            std::remove_if(_pending_modules.begin(), _pending_modules.end(),
+                [module](const auto& pending) { return pending.first == module; }),
+            _pending_modules.end());
+        _modules.erase(it);
     }
 
     void llvm_legacy_execution_engine::emit_native_code()
     {
+        // Objects are loaded as soon as they are added, in the modules order, so that their memory is allocated
+        // on behalf of their module. References to a symbol which is already loaded are bound to it
+        for (auto& pending : _pending_modules) {
+            if (pending.second.empty())
+                pending.second.push_back(_code_generator->generate(*pending.first));
+
+            if (_memory_manager != nullptr)
+                _memory_manager->set_owner(pending.first);
+
+            for (auto& object : pending.second) {
+                auto object_file = llvm::object::ObjectFile::createObjectFile(object->getMemBufferRef());
+                if (!object_file) {
+                    if (_memory_manager != nullptr)
+                        _memory_manager->set_owner(nullptr);
+                    throw std::runtime_error(
+                        "[llvm_legacy_execution_engine] Invalid object file : " + llvm::toString(object_file.takeError()));
+                }
+
+                _execution_engine->addObjectFile(
+                    llvm::object::OwningBinary<llvm::object::ObjectFile>{std::move(*object_file), std::move(object)});
+            }
+        }
+
+        if (_memory_manager != nullptr)
+            _memory_manager->set_owner(nullptr);
+
+        _pending_modules.clear();
         _execution_engine->finalizeObject();
 
         if (_execution_engine->hasError()) {
@@ -99,6 +183,33 @@ namespace DSPJIT
 
     void *llvm_legacy_execution_engine::get_function_pointer(llvm::Function *function)
     {
-        return _execution_engine->getPointerToFunction(function);
+        // The newest definition of the symbol, which is the function one if its module was just emitted
+        return reinterpret_cast<void*>(_execution_engine->getFunctionAddress(function->getName().str()));
+    }
+
+    void llvm_legacy_execution_engine::add_global_mapping(llvm::GlobalValue *global, void *address)
+    {
+        // Symbols names are reused by every sequences : overwrite the previous mapping
+        _execution_engine->updateGlobalMapping(global, address);
+    }
+
+    void llvm_legacy_execution_engine::set_object_cache(llvm::ObjectCache *cache)
+    {
+        _code_generator->set_object_cache(cache);
+    }
+
+    llvm::TargetMachine& llvm_legacy_execution_engine::get_target_machine()
+    {
+        return *_execution_engine->getTargetMachine();
+    }
+
+    std::size_t llvm_legacy_execution_engine::get_native_code_size() const noexcept
+    {
+        return _native_code_size.load();
+    }
+
+    code_memory_pool::usage llvm_legacy_execution_engine::get_native_memory_usage() const
+    {
+        return _memory_pool ? _memory_pool->get_usage() : code_memory_pool::usage{};
     }
 }
\ No newline at end of file
@@ -0,0 +1,45 @@
+
+#include <chrono>
+#include <stdexcept>
+
+#include <DSPJIT/log.h>
+
+#include "native_code_generator.h"
+
+namespace DSPJIT
+{
+
+    native_code_generator::native_code_generator(llvm::TargetMachine& target_machine)
+    :   _stream{_buffer}
+    {
+        if (target_machine.addPassesToEmitFile(_pass_manager, _stream, nullptr, llvm::CGFT_ObjectFile))
+            throw std::runtime_error("[native_code_generator] The target cannot emit object files");
+    }
+
+    std::unique_ptr<llvm::MemoryBuffer> native_code_generator::generate(llvm::Module& module)
+    {
+        if (_object_cache != nullptr) {
+            if (auto object = _object_cache->getObject(&module))
+                return object;
+        }
+
+        const auto begin = std::chrono::steady_clock::now();
+
+        // The stream writes in the buffer, which is emptied once the object is copied
+        _pass_manager.run(module);
+        auto object = llvm::MemoryBuffer::getMemBufferCopy(
+            llvm::StringRef{_buffer.data(), _buffer.size()}, module.getModuleIdentifier());
+        _buffer.clear();
+
+        if (_object_cache != nullptr)
+            _object_cache->notifyObjectCompiled(&module, object->getMemBufferRef());
+
+        const auto end = std::chrono::steady_clock::now();
+        LOG_DEBUG("[native_code_generator] %s native code generated in %u us\n",
+            module.getModuleIdentifier().c_str(),
+            static_cast<unsigned int>(std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count()));
+
+        return object;
+    }
+
+}
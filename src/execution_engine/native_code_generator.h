@@ -0,0 +1,55 @@
+#ifndef DSPJIT_NATIVE_CODE_GENERATOR_H_
+#define DSPJIT_NATIVE_CODE_GENERATOR_H_
+
+#include <memory>
+
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ExecutionEngine/ObjectCache.h>
+#include <llvm/IR/LegacyPassManager.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Target/TargetMachine.h>
+
+namespace DSPJIT
+{
+
+    /**
+     * \class native_code_generator
+     * \brief Compile modules to object files with a code generation pipeline which is built once
+     * \details Building the code generation passes costs about as much as compiling a small module :
+     * the pipeline is kept and run on each module. Modules must be compiled one at a time.
+     */
+    class native_code_generator
+    {
+    public:
+        /**
+         * \param target_machine the target machine generating the code. Must outlive the generator
+         * \throw std::runtime_error if the target cannot emit object files
+         */
+        explicit native_code_generator(llvm::TargetMachine& target_machine);
+
+        native_code_generator(const native_code_generator&) = delete;
+        native_code_generator(native_code_generator&&) = delete;
+
+        /**
+         * \brief Set the cache in which the generated objects are looked up and stored. May be null
+         */
+        void set_object_cache(llvm::ObjectCache *cache) noexcept { _object_cache = cache; }
+
+        /**
+         * \brief Generate a module object file, or take it from the object cache
+         * \param module the module to be compiled, whose data layout match the target machine
+         */
+        std::unique_ptr<llvm::MemoryBuffer> generate(llvm::Module& module);
+
+    private:
+        llvm::SmallVector<char, 0u> _buffer{};
+        llvm::raw_svector_ostream _stream;
+        llvm::legacy::PassManager _pass_manager{};
+        llvm::ObjectCache *_object_cache{nullptr};
+    };
+
+}
+
+#endif /* DSPJIT_NATIVE_CODE_GENERATOR_H_ */
@@ -0,0 +1,135 @@
+#include <llvm/Support/MathExtras.h>
+
+#include <DSPJIT/log.h>
+
+#include "native_code_memory_manager.h"
+
+namespace DSPJIT
+{
+    native_code_memory_manager::native_code_memory_manager(
+        std::shared_ptr<code_memory_pool> pool,
+        std::atomic<std::size_t>& allocated_size)
+    :   _pool{std::move(pool)},
+        _allocated_size{allocated_size}
+    {
+    }
+
+    native_code_memory_manager::~native_code_memory_manager() noexcept
+    {
+        for (auto& owner : _owners)
+            _release(owner.second);
+    }
+
+    void native_code_memory_manager::release_owner(const void *owner)
+    {
+        auto it = _owners.find(owner);
+
+        if (it != _owners.end()) {
+            _release(it->second);
+            _owners.erase(it);
+        }
+    }
+
+    uint8_t *native_code_memory_manager::allocateCodeSection(
+        uintptr_t size, unsigned int alignment, unsigned int, llvm::StringRef)
+    {
+        return _allocate(section_kind::code, size, alignment);
+    }
+
+    uint8_t *native_code_memory_manager::allocateDataSection(
+        uintptr_t size, unsigned int alignment, unsigned int, llvm::StringRef, bool read_only)
+    {
+        return _allocate(read_only ? section_kind::read_only_data : section_kind::read_write_data, size, alignment);
+    }
+
+    bool native_code_memory_manager::finalizeMemory(std::string *error_message)
+    {
+        try {
+            for (auto& owner : _owners) {
+                for (auto& block : owner.second.blocks) {
+                    if (!block.finalized) {
+                        _pool->protect(block.kind, block.memory);
+                        if (block.kind == section_kind::code)
+                            llvm::sys::Memory::InvalidateInstructionCache(block.memory.base(), block.memory.allocatedSize());
+                        block.finalized = true;
+                    }
+                }
+            }
+            return false;
+        }
+        catch (const std::exception& error) {
+            if (error_message != nullptr)
+                *error_message = error.what();
+            return true;
+        }
+    }
+
+    void native_code_memory_manager::registerEHFrames(uint8_t *address, uint64_t, size_t size)
+    {
+        //  The frames are deregistered with the owner of the section containing them
+        for (auto& owner : _owners) {
+            for (const auto& block : owner.second.blocks) {
+                const auto base = static_cast<uint8_t*>(block.memory.base());
+
+                if (address >= base && address < base + block.memory.allocatedSize()) {
+                    llvm::RTDyldMemoryManager::registerEHFramesInProcess(address, size);
+                    owner.second.eh_frames.push_back({address, size});
+                    return;
+                }
+            }
+        }
+
+        LOG_ERROR("[native_code_memory_manager] Cannot register EH frames which were not allocated by this memory manager\n");
+    }
+
+    void native_code_memory_manager::deregisterEHFrames()
+    {
+        for (auto& owner : _owners) {
+            for (const auto& frame : owner.second.eh_frames)
+                llvm::RTDyldMemoryManager::deregisterEHFramesInProcess(frame.address, frame.size);
+            owner.second.eh_frames.clear();
+        }
+    }
+
+    uint8_t *native_code_memory_manager::_allocate(section_kind kind, std::size_t size, unsigned int alignment)
+    {
+        auto& blocks = _owners[_current_owner].blocks;
+        alignment = std::max(alignment, 16u);
+
+        //  Pack the sections of an owner in its last block of the same kind, if it is not finalized
+        for (auto it = blocks.rbegin(); it != blocks.rend(); ++it) {
+            if (it->kind == kind && !it->finalized) {
+                const auto offset = llvm::alignTo(it->used_size, alignment);
+
+                if (offset + size <= it->memory.allocatedSize()) {
+                    it->used_size = offset + size;
+                    _allocated_size += size;
+                    return static_cast<uint8_t*>(it->memory.base()) + offset;
+                }
+
+                break;
+            }
+        }
+
+        //  Blocks are page aligned, which is enough unless a larger alignment is required
+        const auto memory = _pool->allocate(kind, size + alignment);
+        const auto offset = llvm::alignTo(reinterpret_cast<std::uintptr_t>(memory.base()), alignment) -
+            reinterpret_cast<std::uintptr_t>(memory.base());
+
+        blocks.push_back({kind, memory, offset + size, false});
+        _allocated_size += size;
+        return static_cast<uint8_t*>(memory.base()) + offset;
+    }
+
+    void native_code_memory_manager::_release(owner_memory& memory)
+    {
+        for (const auto& frame : memory.eh_frames)
+            llvm::RTDyldMemoryManager::deregisterEHFramesInProcess(frame.address, frame.size);
+
+        for (const auto& block : memory.blocks)
+            _pool->release(block.kind, block.memory);
+
+        memory.eh_frames.clear();
+        memory.blocks.clear();
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef DSPJIT_NATIVE_CODE_MEMORY_MANAGER_H_
+#define DSPJIT_NATIVE_CODE_MEMORY_MANAGER_H_
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <llvm/ExecutionEngine/RTDyldMemoryManager.h>
+
+#include <DSPJIT/code_memory_pool.h>
+
+namespace DSPJIT
+{
+
+    /**
+     * \class native_code_memory_manager
+     * \brief Memory manager allocating the loaded objects sections from a code_memory_pool
+     * \details The sections are allocated on behalf of an owner (a module), and are released to the pool with
+     * the owner, or when the memory manager is destroyed. It also accounts for the size of the loaded sections.
+     */
+    class native_code_memory_manager : public llvm::RTDyldMemoryManager
+    {
+    public:
+        /**
+         * \param pool the pool from which memory is allocated
+         * \param allocated_size incremented by the size of each allocated section. Must outlive the memory manager
+         */
+        native_code_memory_manager(std::shared_ptr<code_memory_pool> pool, std::atomic<std::size_t>& allocated_size);
+        ~native_code_memory_manager() noexcept override;
+
+        /**
+         * \brief Set the owner of the next allocated sections
+         */
+        void set_owner(const void *owner) noexcept { _current_owner = owner; }
+
+        /**
+         * \brief Release the sections allocated for an owner
+         * \note The owner code must not be used anymore
+         */
+        void release_owner(const void *owner);
+
+        uint8_t *allocateCodeSection(
+            uintptr_t size, unsigned int alignment, unsigned int section_id, llvm::StringRef section_name) override;
+
+        uint8_t *allocateDataSection(
+            uintptr_t size, unsigned int alignment, unsigned int section_id, llvm::StringRef section_name, bool read_only) override;
+
+        bool finalizeMemory(std::string *error_message = nullptr) override;
+
+        void registerEHFrames(uint8_t *address, uint64_t load_address, size_t size) override;
+        void deregisterEHFrames() override;
+
+    private:
+        using section_kind = code_memory_pool::section_kind;
+
+        struct block {
+            section_kind kind;
+            llvm::sys::MemoryBlock memory;
+            std::size_t used_size{0u};
+            bool finalized{false};
+        };
+
+        struct eh_frame {
+            uint8_t *address;
+            std::size_t size;
+        };
+
+        struct owner_memory {
+            std::vector<block> blocks{};
+            std::vector<eh_frame> eh_frames{};
+        };
+
+        uint8_t *_allocate(section_kind kind, std::size_t size, unsigned int alignment);
+        void _release(owner_memory& memory);
+
+        std::shared_ptr<code_memory_pool> _pool;
+        std::atomic<std::size_t>& _allocated_size;
+        std::map<const void*, owner_memory> _owners{};
+        const void *_current_owner{nullptr};
+    };
+
+} // namespace DSPJIT
+
+#endif /* DSPJIT_NATIVE_CODE_MEMORY_MANAGER_H_ */
@@ -0,0 +1,112 @@
+
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Support/xxhash.h>
+
+#include <DSPJIT/ir_helper.h>
+#include <DSPJIT/log.h>
+#include <DSPJIT/object_cache.h>
+
+namespace DSPJIT
+{
+    // Must be changed when the code generation changes in a way that is not visible in the IR
+    static constexpr auto cache_format_version = 1u;
+    static constexpr auto key_prefix = "dspjit-";
+
+    object_cache::object_cache(const std::string& directory)
+    :   _directory{directory}
+    {
+        if (auto error = llvm::sys::fs::create_directories(_directory))
+            throw std::runtime_error("[object_cache] Failed to create cache directory " + _directory + " : " + error.message());
+    }
+
+    std::string object_cache::compute_key(
+        const llvm::Module& module,
+        const llvm::TargetMachine& target_machine,
+        const optimization_pipeline& pipeline)
+    {
+        std::string key_data{};
+        llvm::raw_string_ostream stream{key_data};
+
+        // The IR code and everything which change the generated native code from the same IR
+        stream
+            << compute_module_hash(module)
+            << '\0' << cache_format_version
+            << '\0' << target_machine.getTargetTriple().str()
+            << '\0' << target_machine.getTargetCPU()
+            << '\0' << target_machine.getTargetFeatureString()
+            << '\0' << static_cast<int>(target_machine.getOptLevel())
+            << '\0' << pipeline.name();
+        stream.flush();
+
+        return key_prefix + llvm::utohexstr(llvm::xxHash64(key_data), true);
+    }
+
+    bool object_cache::contains(const std::string& key) const
+    {
+        return llvm::sys::fs::exists(_object_path(key));
+    }
+
+    void object_cache::notifyObjectCompiled(const llvm::Module *module, llvm::MemoryBufferRef object)
+    {
+        const auto key = module->getModuleIdentifier();
+
+        if (!_is_key(key))
+            return;
+
+        _miss_count++;
+
+        // Write in a temporary file first so that a partially written object is never loaded
+        const auto path = _object_path(key);
+        const auto temporary_path = path + ".tmp";
+
+        {
+            std::error_code error{};
+            llvm::raw_fd_ostream stream{temporary_path, error};
+
+            if (error) {
+                LOG_WARNING("[object_cache] Failed to open %s : %s\n", temporary_path.c_str(), error.message().c_str());
+                return;
+            }
+
+            stream << object.getBuffer();
+        }
+
+        if (auto error = llvm::sys::fs::rename(temporary_path, path))
+            LOG_WARNING("[object_cache] Failed to store object %s : %s\n", path.c_str(), error.message().c_str());
+        else
+            LOG_DEBUG("[object_cache] Stored object %s\n", key.c_str());
+    }
+
+    std::unique_ptr<llvm::MemoryBuffer> object_cache::getObject(const llvm::Module *module)
+    {
+        const auto key = module->getModuleIdentifier();
+
+        if (!_is_key(key))
+            return nullptr;
+
+        auto buffer = llvm::MemoryBuffer::getFile(_object_path(key));
+
+        if (!buffer)
+            return nullptr;
+
+        LOG_DEBUG("[object_cache] Loaded object %s\n", key.c_str());
+        _hit_count++;
+        return std::move(*buffer);
+    }
+
+    bool object_cache::_is_key(llvm::StringRef identifier)
+    {
+        return identifier.startswith(key_prefix);
+    }
+
+    std::string object_cache::_object_path(llvm::StringRef key) const
+    {
+        llvm::SmallString<256> path{_directory};
+        llvm::sys::path::append(path, key + ".o");
+        return std::string{path.str()};
+    }
+}
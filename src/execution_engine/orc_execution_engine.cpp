@@ -0,0 +1,247 @@
+
+#include <algorithm>
+#include <type_traits>
+
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/RTDyldObjectLinkingLayer.h>
+#include <llvm/Support/TargetSelect.h>
+
+#include <DSPJIT/log.h>
+#include <DSPJIT/orc_execution_engine.h>
+
+#include "native_code_generator.h"
+#include "native_code_memory_manager.h"
+
+namespace DSPJIT
+{
+    static std::runtime_error _to_runtime_error(const char *what, llvm::Error error)
+    {
+        return std::runtime_error{
+            std::string{"[orc_execution_engine] "} + what + " : " + llvm::toString(std::move(error))};
+    }
+
+    template <typename T>
+    static T _unwrap(const char *what, llvm::Expected<T>&& expected)
+    {
+        if (!expected)
+            throw _to_runtime_error(what, expected.takeError());
+
+        if constexpr (std::is_reference_v<T>)
+            return *expected;
+        else
+            return std::move(*expected);
+    }
+
+    orc_execution_engine::orc_execution_engine(
+        llvm::CodeGenOpt::Level opt_level,
+        const llvm::TargetOptions& target_options,
+        unsigned int compile_thread_count,
+        std::shared_ptr<code_memory_pool> memory_pool,
+        const std::string& target_cpu)
+    :   _memory_pool{memory_pool ? std::move(memory_pool) : std::make_shared<code_memory_pool>()}
+    {
+        // Initialize LLVM native target
+        static auto llvm_jit_was_init = false;
+        if (llvm_jit_was_init == false) {
+            llvm::InitializeNativeTarget();
+            llvm::InitializeNativeTargetAsmPrinter();
+            llvm_jit_was_init = true;
+        }
+
+        auto target_machine_builder = _unwrap("Failed to detect host", llvm::orc::JITTargetMachineBuilder::detectHost());
+
+#ifdef _WIN32
+        // Force elf on windows, as COFF relocation seems to cause trouble
+        target_machine_builder.getTargetTriple().setObjectFormat(llvm::Triple::ELF);
+#endif
+
+        //  The host cpu features are only used when targeting the host cpu
+        if (!target_cpu.empty()) {
+            target_machine_builder.setCPU(target_cpu);
+            target_machine_builder.getFeatures() = llvm::SubtargetFeatures{};
+        }
+
+        target_machine_builder
+            .setCodeGenOptLevel(opt_level)
+            .setOptions(target_options);
+
+        // Target machine used to compile modules to objects. The jit compile layer is not used
+        // as it destroys the modules, which are referenced until they are deleted.
+        _target_machine = _unwrap("Failed to create target machine", target_machine_builder.createTargetMachine());
+        _code_generator = std::make_unique<native_code_generator>(*_target_machine);
+
+        _jit = _unwrap("Failed to initialize LLJIT",
+            llvm::orc::LLJITBuilder{}
+                .setJITTargetMachineBuilder(std::move(target_machine_builder))
+                .setNumCompileThreads(compile_thread_count)
+                .setObjectLinkingLayerCreator(
+                    [this](llvm::orc::ExecutionSession& session, const llvm::Triple&)
+                        -> llvm::Expected<std::unique_ptr<llvm::orc::ObjectLayer>>
+                    {
+                        return std::make_unique<llvm::orc::RTDyldObjectLinkingLayer>(
+                            session,
+                            [this]() { return std::make_unique<native_code_memory_manager>(_memory_pool, _native_code_size); });
+                    })
+                .create());
+
+        // Symbols that are not defined by modules are looked up in the current process
+        auto process_symbols = _unwrap("Failed to create process symbol generator",
+            llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
+                _jit->getDataLayout().getGlobalPrefix()));
+        _jit->getMainJITDylib().addGenerator(std::move(process_symbols));
+
+        _shared_dylib = &_unwrap("Failed to create JITDylib",
+            _jit->getExecutionSession().createJITDylib("shared_modules"));
+        _shared_dylib->addToLinkOrder(_jit->getMainJITDylib());
+    }
+
+    orc_execution_engine::~orc_execution_engine() noexcept = default;
+
+    void orc_execution_engine::add_module(std::unique_ptr<llvm::Module>&& module)
+    {
+        _add_module(std::move(module), _create_module_dylib(), false);
+    }
+
+    void orc_execution_engine::add_compiled_module(
+        std::unique_ptr<llvm::Module>&& module,
+        std::vector<std::unique_ptr<llvm::MemoryBuffer>>&& objects)
+    {
+        auto module_ptr = module.get();
+        _add_module(std::move(module), _create_module_dylib(), false);
+        _modules.at(module_ptr).objects = std::move(objects);
+    }
+
+    void orc_execution_engine::add_shared_module(std::unique_ptr<llvm::Module>&& module)
+    {
+        _add_module(std::move(module), *_shared_dylib, true);
+    }
+
+    void orc_execution_engine::delete_module(llvm::Module *module)
+    {
+        auto it = _modules.find(module);
+
+        if (it == _modules.end())
+            return;
+
+        auto& loaded = it->second;
+
+        // Release the native code and data, then the dylib itself unless it is the shared one
+        if (auto error = loaded.tracker->remove())
+            LOG_ERROR("[orc_execution_engine] Failed to release module resources : %s\n", llvm::toString(std::move(error)).c_str());
+        loaded.tracker.reset();
+
+        if (!loaded.shared) {
+            if (auto error = _jit->getExecutionSession().removeJITDylib(*loaded.dylib))
+                LOG_ERROR("[orc_execution_engine] Failed to remove JITDylib : %s\n", llvm::toString(std::move(error)).c_str());
+        }
+
+        _pending_modules.erase(
+            std::remove(_pending_modules.begin(), _pending_modules.end(), module),
+            _pending_modules.end());
+        _modules.erase(it);
+    }
+
+    void orc_execution_engine::emit_native_code()
+    {
+        // Modules share the caller llvm context and are thus compiled one at a time, while
+        // objects linking is dispatched by the jit on its compile threads
+        for (auto module : _pending_modules)
+            _emit_module(_modules.at(module));
+
+        _pending_modules.clear();
+    }
+
+    void *orc_execution_engine::get_function_pointer(llvm::Function *function)
+    {
+        const auto it = _modules.find(function->getParent());
+
+        if (it == _modules.end())
+            return nullptr;
+
+        const auto& functions = it->second.functions;
+        const auto func_it = functions.find(function);
+        return func_it == functions.end() ? nullptr : func_it->second;
+    }
+
+    void orc_execution_engine::add_global_mapping(llvm::GlobalValue *global, void *address)
+    {
+        auto& loaded = _modules.at(global->getParent());
+
+        if (auto error = loaded.dylib->define(
+                llvm::orc::absoluteSymbols({{
+                    _jit->mangleAndIntern(global->getName()),
+                    llvm::JITEvaluatedSymbol::fromPointer(address)}})))
+            throw _to_runtime_error("Failed to define global symbol", std::move(error));
+    }
+
+    void orc_execution_engine::set_object_cache(llvm::ObjectCache *cache)
+    {
+        _code_generator->set_object_cache(cache);
+    }
+
+    llvm::TargetMachine& orc_execution_engine::get_target_machine()
+    {
+        return *_target_machine;
+    }
+
+    std::size_t orc_execution_engine::get_native_code_size() const noexcept
+    {
+        return _native_code_size.load();
+    }
+
+    code_memory_pool::usage orc_execution_engine::get_native_memory_usage() const
+    {
+        return _memory_pool->get_usage();
+    }
+
+    llvm::orc::JITDylib& orc_execution_engine::_create_module_dylib()
+    {
+        // Each module has its own dylib, as the same symbols are defined by every graph modules
+        auto& dylib = _unwrap("Failed to create JITDylib",
+            _jit->getExecutionSession().createJITDylib(
+                "graph_module." + std::to_string(_dylib_count++)));
+        dylib.addToLinkOrder(*_shared_dylib);
+        dylib.addToLinkOrder(_jit->getMainJITDylib());
+
+        return dylib;
+    }
+
+    void orc_execution_engine::_add_module(std::unique_ptr<llvm::Module>&& module, llvm::orc::JITDylib& dylib, bool shared)
+    {
+        // Set a data layout matching the execution engine
+        module->setDataLayout(_jit->getDataLayout());
+        module->setTargetTriple(_jit->getTargetTriple().str());
+
+        auto module_ptr = module.get();
+        auto& loaded = _modules[module_ptr];
+        loaded.module = std::move(module);
+        loaded.dylib = &dylib;
+        loaded.tracker = shared ? dylib.createResourceTracker() : dylib.getDefaultResourceTracker();
+        loaded.shared = shared;
+
+        _pending_modules.push_back(module_ptr);
+    }
+
+    void orc_execution_engine::_emit_module(loaded_module& loaded)
+    {
+        if (loaded.objects.empty())
+            loaded.objects.push_back(_code_generator->generate(*loaded.module));
+
+        for (auto& object : loaded.objects) {
+            if (auto error = _jit->addObjectFile(loaded.tracker, std::move(object)))
+                throw _to_runtime_error("Failed to add object file", std::move(error));
+        }
+
+        loaded.objects.clear();
+
+        // Looking up the symbols materializes the object : the code is ready for execution
+        for (auto& function : *loaded.module) {
+            if (function.isDeclaration() || function.hasLocalLinkage())
+                continue;
+
+            auto symbol = _unwrap("Failed to lookup symbol",
+                _jit->lookup(*loaded.dylib, function.getName()));
+            loaded.functions[&function] = reinterpret_cast<void*>(symbol.getAddress());
+        }
+    }
+}
@@ -1,6 +1,10 @@
 
+#include <algorithm>
 #include <sstream>
 
+#include <llvm/Analysis/ValueTracking.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/IntrinsicInst.h>
 #include <llvm/IRReader/IRReader.h>
 #include <llvm/Support/SourceMgr.h>
 #include <llvm/Transforms/Utils/Cloning.h>
@@ -92,6 +96,14 @@ namespace DSPJIT {
                 {
                     rename_function(_compute_functions_symbols[static_cast<unsigned int>(compute_type::PROCESS)])
                 };
+
+            //  Stateless nodes whose process function has no side effect are pure
+            std::set<const llvm::Function*> visited{};
+            const auto process_function =
+                _module->getFunction(std::get<dependant_process_symbol>(_symbols.compute_symbols).process_symbol);
+            _proc_info.pure =
+                _proc_info.mutable_state_size == 0u && !_proc_info.use_static_memory &&
+                _is_pure_function(*process_function, visited);
         }
         else {
             // Non dependant process
@@ -267,6 +279,71 @@ namespace DSPJIT {
         return ptr_type && ptr_type->getElementType()->isFloatTy();
     }
 
+    bool external_plugin::_is_pure_function(const llvm::Function& function, std::set<const llvm::Function*>& visited) const
+    {
+        //  Recursive calls are assumed to be pure, the function is checked anyway
+        if (!visited.insert(&function).second)
+            return true;
+
+        //  The memory written by the function must be reached through its arguments or be its own stack
+        const auto is_local_memory = [](const llvm::Value *pointer)
+        {
+            const auto object = llvm::getUnderlyingObject(pointer);
+            return llvm::isa<llvm::Argument>(object) || llvm::isa<llvm::AllocaInst>(object);
+        };
+
+        //  The memory read by the function must be local memory or constant globals
+        const auto is_readable_memory = [](const llvm::Value *pointer)
+        {
+            const auto object = llvm::getUnderlyingObject(pointer);
+            const auto global = llvm::dyn_cast<llvm::GlobalVariable>(object);
+            return llvm::isa<llvm::Argument>(object) || llvm::isa<llvm::AllocaInst>(object) ||
+                (global != nullptr && global->isConstant());
+        };
+
+        for (const auto& instruction : llvm::instructions(function)) {
+            if (const auto load = llvm::dyn_cast<llvm::LoadInst>(&instruction)) {
+                if (load->isVolatile() || !is_readable_memory(load->getPointerOperand()))
+                    return false;
+            }
+            else if (const auto store = llvm::dyn_cast<llvm::StoreInst>(&instruction)) {
+                if (store->isVolatile() || !is_local_memory(store->getPointerOperand()))
+                    return false;
+            }
+            else if (const auto mem_intrinsic = llvm::dyn_cast<llvm::MemIntrinsic>(&instruction)) {
+                if (mem_intrinsic->isVolatile() || !is_local_memory(mem_intrinsic->getDest()))
+                    return false;
+
+                const auto transfer = llvm::dyn_cast<llvm::MemTransferInst>(mem_intrinsic);
+                if (transfer != nullptr && !is_readable_memory(transfer->getSource()))
+                    return false;
+            }
+            else if (const auto call = llvm::dyn_cast<llvm::CallBase>(&instruction)) {
+                const auto callee = call->getCalledFunction();
+
+                if (call->doesNotAccessMemory() || (callee != nullptr && callee->doesNotAccessMemory()) ||
+                    llvm::isa<llvm::DbgInfoIntrinsic>(call) || call->isLifetimeStartOrEnd())
+                    continue;
+
+                //  Only defined functions can be analyzed, the pointers they are given must be local
+                if (callee == nullptr || callee->isDeclaration() ||
+                    !std::all_of(call->arg_begin(), call->arg_end(),
+                        [&is_local_memory](const llvm::Use& arg)
+                        {
+                            return !arg->getType()->isPointerTy() || is_local_memory(arg.get());
+                        }) ||
+                    !_is_pure_function(*callee, visited))
+                    return false;
+            }
+            else if (instruction.mayWriteToMemory()) {
+                //  Atomics, fences, ...
+                return false;
+            }
+        }
+
+        return true;
+    }
+
     bool external_plugin::_check_consistency(
         const process_info& proc_info,
         const std::optional<initialization_info>& init_info) const
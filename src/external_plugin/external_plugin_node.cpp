@@ -1,5 +1,6 @@
 
 #include <DSPJIT/graph_compiler.h>
+#include <DSPJIT/ir_helper.h>
 
 #include "external_plugin_node.h"
 
@@ -10,12 +11,22 @@ namespace DSPJIT {
     :   compile_node_class{
             info.input_count, info.output_count,
             info.mutable_state_size, info.use_static_memory, symbols.is_dependant_process()},
-        _symbols{symbols}
+        _symbols{symbols},
+        _pure{info.pure}
     {
         if (info.mutable_state_size != 0u && !symbols.initialize_symbol.has_value())
             throw std::runtime_error("external_plugin_node::external_plugin_node: no initialize function was provided whereas mutable_state_size > 0");
     }
 
+    bool external_plugin_node::is_equivalent(const compile_node_class& other) const noexcept
+    {
+        //  Plugins symbols are unique : the nodes run the same process function
+        const auto other_node = dynamic_cast<const external_plugin_node*>(&other);
+        return other_node != nullptr && other_node->_symbols.is_dependant_process() && _symbols.is_dependant_process() &&
+            std::get<external_plugin::dependant_process_symbol>(other_node->_symbols.compute_symbols).process_symbol ==
+            std::get<external_plugin::dependant_process_symbol>(_symbols.compute_symbols).process_symbol;
+    }
+
     void external_plugin_node::initialize_mutable_state(
             llvm::IRBuilder<>& builder,
         llvm::Value *mutable_state, llvm::Value *static_mem) const
@@ -126,7 +137,7 @@ namespace DSPJIT {
             outputs_ptr.resize(output_count);
             std::generate(
                 outputs_ptr.begin(), outputs_ptr.end(),
-                [&builder]() { return builder.CreateAlloca(builder.getFloatTy()); });
+                [&builder]() { return create_entry_block_alloca(builder, builder.getFloatTy()); });
         }
 
         //  Call process func
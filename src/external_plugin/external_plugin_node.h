@@ -17,6 +17,9 @@ namespace DSPJIT {
             const external_plugin::process_info& info,
             const external_plugin_symbols& symbols);
 
+        bool is_pure() const noexcept override { return _pure; }
+        bool is_equivalent(const compile_node_class& other) const noexcept override;
+
         void initialize_mutable_state(
             llvm::IRBuilder<>& builder,
             llvm::Value *mutable_state, llvm::Value*) const override;
@@ -51,6 +54,7 @@ namespace DSPJIT {
         llvm::Value *_convert_ptr_arg(llvm::IRBuilder<>& builder, const llvm::Function *func, int arg_index, llvm::Value *ptr) const;
 
         const external_plugin_symbols _symbols;
+        const bool _pure;
     };
 
 }
@@ -1,4 +1,9 @@
 
+#include <algorithm>
+#include <stdexcept>
+
+#include <llvm/ADT/Hashing.h>
+
 #include <DSPJIT/log.h>
 
 #include <DSPJIT/graph_compiler.h>
@@ -8,18 +13,34 @@ namespace DSPJIT {
     graph_compiler::graph_compiler(
         llvm::IRBuilder<>& builder,
         llvm::Value *instance_num,
-        abstract_graph_memory_manager& memory_mgr)
+        abstract_graph_memory_manager& memory_mgr,
+        unsigned int vector_width,
+        composite_function_cache *composite_functions,
+        parameter_block *parameters,
+        bool constant_parameters)
     :   _builder{builder},
         _instance_num{instance_num},
-        _memory_mgr{memory_mgr}
+        _memory_mgr{memory_mgr},
+        _vector_width{vector_width},
+        _composite_functions{composite_functions},
+        _parameters{parameters},
+        _constant_parameters{constant_parameters}
     {
+        if (vector_width == 0u)
+            throw std::invalid_argument("graph_compiler: vector width must be greater than zero");
     }
 
     void graph_compiler::assign_values(
         const compile_node_class* node,
         std::vector<llvm::Value*>&& values)
     {
-        _nodes_value.emplace(node, std::move(values));
+        if (_find_node(node) != npos)
+            return;
+
+        const auto index = _add_node(*node);
+        std::copy_n(
+            values.begin(), std::min<std::size_t>(values.size(), node->get_output_count()),
+            _values.begin() + _nodes[index].value_offset);
     }
 
     llvm::Value* graph_compiler::node_value(
@@ -30,128 +51,298 @@ namespace DSPJIT {
             return _create_zero();
         }
 
-        auto node_value_it = _nodes_value.find(node);
-        if (node_value_it != _nodes_value.end()) {
+        auto index = _find_node(node);
+        if (index != npos) {
             // This node should outputs should have been computed
-            auto& output_value = node_value_it->second[output_id];
+            const auto output_value = _node_output(index, output_id);
 
             if (output_value == nullptr)
                 throw std::runtime_error("graph_compiler::node_value node already present in value map with a null value");
 
             return output_value;
         }
+
+        schedule_pass pass{_nodes.size()};
+
+        _schedule(pass, *node);
+
+        //  Push the inputs of the non dependant process nodes, in their visit order. This can discover new nodes
+        for (auto i = 0u; i < pass.deferred_nodes.size(); ++i)
+            _push_deferred_node_inputs(pass, pass.deferred_nodes[i]);
+
+        // Node value must have been computed at this point
+        index = _find_node(node);
+        if (index == npos)
+            throw std::runtime_error("graph_compiler::node_value node is not present in value map after compilation");
+        else
+            return _node_output(index, output_id);
+    }
+
+    std::size_t graph_compiler::_find_node(const compile_node_class *node) const
+    {
+        const auto it = _node_indices.find(node);
+        return it == _node_indices.end() ? npos : it->second;
+    }
+
+    std::size_t graph_compiler::_add_node(const compile_node_class& node)
+    {
+        const auto index = _nodes.size();
+
+        if (!_node_indices.try_emplace(&node, index).second)
+            throw std::runtime_error("graph_compiler::_add_node node values have already been initialized");
+
+        _nodes.push_back({&node, _values.size(), _edges.size()});
+        _values.resize(_values.size() + node.get_output_count(), nullptr);
+        _edges.resize(_edges.size() + node.get_input_count());
+        return index;
+    }
+
+    void graph_compiler::_schedule(schedule_pass& pass, const compile_node_class& root)
+    {
+        _discover(pass, root);
+
+        while (!pass.path.empty()) {
+            if (!_scan_next_input(pass))
+                _finish_node(pass);
+        }
+    }
+
+    std::size_t graph_compiler::_discover(schedule_pass& pass, const compile_node_class& node)
+    {
+        const auto index = _add_node(node);
+        const auto order = pass.discovered_count++;
+
+        //  Nodes visited by other passes (composite nodes internal graphs) get an empty entry
+        pass.entries.resize(_nodes.size() - pass.first_index);
+        pass.entries[index - pass.first_index] = {order, order, true, false};
+        pass.path.push_back({index, 0u});
+
+        // Non dependant process: its outputs do not depend on its inputs, which are pushed
+        // after the current dependencies have been emitted
+        if (!node.dependant_process)
+            pass.deferred_nodes.push_back(index);
+
+        return index;
+    }
+
+    bool graph_compiler::_scan_next_input(schedule_pass& pass)
+    {
+        auto& frame = pass.path.back();
+        const auto index = frame.index;
+        const auto& node = *_nodes[index].node;
+
+        if (!node.dependant_process || frame.next_input == node.get_input_count())
+            return false;
+
+        const auto input_id = frame.next_input++;
+        const auto edge_index = _nodes[index].edge_offset + input_id;
+        unsigned int output_id = 0u;
+        const auto input_node = node.get_input(input_id, output_id);
+
+        if (input_node == nullptr) {
+            // Nothing plugged-in
+            _edges[edge_index] = {npos, 0u, false};
+            return true;
+        }
+
+        auto input_index = _find_node(input_node);
+
+        if (input_index == npos) {
+            // This input node was never visited : scan its own inputs first
+            _edges[edge_index] = {_nodes.size(), output_id, false};
+            _discover(pass, *input_node);
+            return true;
+        }
+
+        const auto input_entry = _schedule_entry(pass, input_index);
+        bool feedback = false;
+
+        if (input_entry != nullptr) {
+            // A back edge : the input node is on the search path and will be emitted after this one
+            feedback = input_entry->on_path;
+
+            // The input node belongs to a component which is not complete yet
+            if (!input_entry->scheduled) {
+                auto& entry = *_schedule_entry(pass, index);
+                entry.lowlink = std::min(entry.lowlink, input_entry->order);
+            }
+        }
         else {
-            std::deque<const compile_node_class*> dependency_stack{node};
+            // The input node was visited by another pass : it is being compiled if its value is not available
+            feedback = (_node_output(input_index, output_id) == nullptr);
+        }
+
+        _edges[edge_index] = {input_index, output_id, feedback};
+        return true;
+    }
+
+    void graph_compiler::_finish_node(schedule_pass& pass)
+    {
+        const auto index = pass.path.back().index;
+        pass.path.pop_back();
 
-            while (!dependency_stack.empty()) {
-                const auto dependency = dependency_stack.back();
+        auto& entry = *_schedule_entry(pass, index);
+        entry.on_path = false;
+        pass.finished.push_back(index);
 
-                if (dependency->dependant_process == true) {
-                    // Dependant process: Record node as visited and compute inputs
+        if (!pass.path.empty()) {
+            auto& parent_entry = *_schedule_entry(pass, pass.path.back().index);
+            parent_entry.lowlink = std::min(parent_entry.lowlink, entry.lowlink);
+        }
 
-                    if (_nodes_value.find(dependency) == _nodes_value.end()) {
-                        // This is the first time we visit this node
-                        _assign_null_values(*dependency);
-                    }
+        if (entry.lowlink == entry.order)
+            _emit_component(pass, index);
+    }
 
-                    // Scan dependency inputs
-                    const auto input_values = _scan_inputs(dependency_stack, *dependency);
+    void graph_compiler::_emit_component(schedule_pass& pass, std::size_t root_index)
+    {
+        //  The component nodes are the nodes finished since the root was discovered
+        //  which do not belong to an already emitted component
+        const auto root_order = _schedule_entry(pass, root_index)->order;
+        auto begin = pass.finished.size();
 
-                    // Do dependency computation if all dependency are computed
-                    if (input_values.has_value()) {
-                        _compute_node_output_values(*dependency, input_values.value());
-                        dependency_stack.pop_back();
-                    }
-                }
-                else {
-                    // Non dependant process:
-
-                    if (_nodes_value.find(dependency) == _nodes_value.end()) {
-                        // First visit: Pull outputs
-                        _compute_node_output_values(*dependency, {});
-                        dependency_stack.pop_back();
-                        // Remember to push the input after the curent cycle have been resolver without delay
-                        dependency_stack.push_front(dependency);
-                    }
-                    else {
-                        // Output already computed: push inputs
-
-                        // Scan dependency inputs
-                        const auto input_values = _scan_inputs(dependency_stack, *dependency);
-
-                        // Do dependency computation if all input are computed
-                        if (input_values.has_value()) {
-                            // Push inputs
-                            _push_node_input_values(*dependency, input_values.value());
-                            dependency_stack.pop_back();
-                        }
-                    }
-                }
+        while (begin > 0u && _schedule_entry(pass, pass.finished[begin - 1u])->order >= root_order)
+            _schedule_entry(pass, pass.finished[--begin])->scheduled = true;
+
+        //  Emitting code can run other passes (composite nodes), which do not use this pass state
+        for (auto i = begin; i < pass.finished.size(); ++i) {
+            const auto index = pass.finished[i];
+
+            if (_nodes[index].node->dependant_process) {
+                _gather_input_values(index, pass.inputs);
+                _compute_node_output_values(index, pass.inputs);
+            }
+            else {
+                _compute_node_output_values(index, {});
             }
         }
 
-        // Node value must have been computed at this point
-        node_value_it = _nodes_value.find(node);
-        if (node_value_it == _nodes_value.end())
-            throw std::runtime_error("graph_compiler::node_value node is not present in value map after compilation");
-        else
-            return node_value_it->second[output_id];
+        pass.finished.resize(begin);
     }
 
-    std::optional<std::vector<llvm::Value*>> graph_compiler::_scan_inputs(
-        std::deque<const compile_node_class*>& dependency_stack,
-        const compile_node_class& node)
+    void graph_compiler::_push_deferred_node_inputs(schedule_pass& pass, std::size_t index)
     {
-        bool all_input_computed = true;
+        const auto& node = *_nodes[index].node;
         const auto input_count = node.get_input_count();
-        std::vector<llvm::Value*> input_values(input_count);
 
-        for (auto i = 0u; i < input_count; ++i) {
-            unsigned int out_id = 0u;
-            const auto input_node = node.get_input(i, out_id);
+        for (auto input_id = 0u; input_id < input_count; ++input_id) {
+            const auto edge_index = _nodes[index].edge_offset + input_id;
+            unsigned int output_id = 0u;
+            const auto input_node = node.get_input(input_id, output_id);
 
             if (input_node == nullptr) {
+                _edges[edge_index] = {npos, 0u, false};
+                continue;
+            }
+
+            auto input_index = _find_node(input_node);
+
+            if (input_index == npos) {
+                //  Emit the input node and its dependencies first
+                _schedule(pass, *input_node);
+                input_index = _find_node(input_node);
+            }
+
+            //  Every node discovered by this pass was emitted : only a node being compiled by another pass can be pending
+            _edges[edge_index] = {input_index, output_id, _node_output(input_index, output_id) == nullptr};
+        }
+
+        _gather_input_values(index, pass.inputs);
+        _push_node_input_values(node, pass.inputs);
+    }
+
+    graph_compiler::schedule_entry *graph_compiler::_schedule_entry(schedule_pass& pass, std::size_t index)
+    {
+        if (index < pass.first_index || index - pass.first_index >= pass.entries.size())
+            return nullptr;
+
+        auto& entry = pass.entries[index - pass.first_index];
+        return entry.order == npos ? nullptr : &entry;
+    }
+
+    void graph_compiler::_gather_input_values(std::size_t index, std::vector<llvm::Value*>& inputs)
+    {
+        const auto& node = *_nodes[index].node;
+        const auto edge_offset = _nodes[index].edge_offset;
+
+        inputs.clear();
+
+        for (auto input_id = 0u; input_id < node.get_input_count(); ++input_id) {
+            const auto edge = _edges[edge_offset + input_id];
+
+            if (edge.index == npos) {
                 // Nothing plugged-in
-                input_values[i] = _create_zero();
+                inputs.push_back(_create_zero());
+                continue;
             }
-            else {
-                // Check if this input have been visited
-                auto input_values_it = _nodes_value.find(input_node);
-                if (input_values_it != _nodes_value.end()) {
-                    const auto input_value = input_values_it->second[out_id];
-
-                    if (input_value == nullptr) {
-                        LOG_DEBUG("[graph_compiler][_scan_input] Resolving a cycle with an additional delay\n");
-
-                        auto& state = _memory_mgr.get_or_create(*input_node);
-                        auto cycle_ptr =
-                            state.get_cycle_state_ptr(_builder, _instance_num, out_id);
-
-                        //  Store temporarily the cycle state value as output value.
-                        //  It will be replaced when this node will be compiled
-                        const auto cycle_value = _builder.CreateLoad(_builder.getFloatTy(), cycle_ptr);
-                        input_values_it->second[out_id] = cycle_value;
-                        input_values[i] = cycle_value;
-                    }
-                    else {
-                        // Input is already computed
-                        input_values[i] = input_value;
-                    }
-                }
-                else {
-                    // This input_node was never visited and is not computed
-                    dependency_stack.push_back(input_node);
-                    all_input_computed = false;
-                    break; // do not push several not at once because we dont want a given node to be pushed twice
-                }
+
+            auto& input_value = _node_output(edge.index, edge.output_id);
+
+            if (input_value == nullptr) {
+                if (!edge.feedback)
+                    throw std::runtime_error("graph_compiler::_gather_input_values input value was not computed");
+
+                LOG_DEBUG("[graph_compiler][_gather_input_values] Resolving a cycle with an additional delay\n");
+
+                auto& state = _memory_mgr.get_or_create(*_nodes[edge.index].node);
+
+                //  Store temporarily the cycle state value as output value.
+                //  It will be replaced when this node will be compiled
+                input_value = _load_cycle_state(state, edge.output_id);
             }
+
+            inputs.push_back(input_value);
         }
+    }
 
-        if (all_input_computed) {
-            return input_values;
+    template <typename TEmitFunc>
+    std::vector<llvm::Value*> graph_compiler::_emit_node_code(
+        const compile_node_class& node,
+        abstract_node_state *state,
+        const std::vector<llvm::Value*>& inputs,
+        llvm::Value *static_memory,
+        TEmitFunc emit)
+    {
+        if (_vector_width == 1u || node.supports_vector_processing()) {
+            llvm::Value *state_ptr = nullptr;
+
+            if (state != nullptr && node.mutable_state_size != 0u)
+                state_ptr = state->get_mutable_state_ptr(_builder, _instance_num);
+
+            return emit(inputs, state_ptr, static_memory);
         }
         else {
-            return std::nullopt;
+            //  Scalarize : emit the node code once per lane, with a scalar view of the compiler
+            const auto vector_width = _vector_width;
+            const auto instance_num = _instance_num;
+            std::vector<llvm::Value*> outputs{};
+
+            _vector_width = 1u;
+
+            for (auto lane = 0u; lane < vector_width; ++lane) {
+                _instance_num = _builder.CreateAdd(instance_num, _builder.getInt64(lane));
+
+                std::vector<llvm::Value*> lane_inputs(inputs.size());
+                std::transform(
+                    inputs.begin(), inputs.end(), lane_inputs.begin(),
+                    [this, lane](llvm::Value *input) { return _builder.CreateExtractElement(input, lane); });
+
+                llvm::Value *state_ptr = nullptr;
+                if (state != nullptr && node.mutable_state_size != 0u)
+                    state_ptr = state->get_mutable_state_ptr(_builder, _instance_num);
+
+                const auto lane_outputs = emit(lane_inputs, state_ptr, static_memory);
+
+                if (lane == 0u)
+                    outputs.assign(lane_outputs.size(), llvm::UndefValue::get(llvm::FixedVectorType::get(_builder.getFloatTy(), vector_width)));
+
+                for (auto i = 0u; i < lane_outputs.size(); ++i)
+                    outputs[i] = _builder.CreateInsertElement(outputs[i], lane_outputs[i], lane);
+            }
+
+            _vector_width = vector_width;
+            _instance_num = instance_num;
+            return outputs;
         }
     }
 
@@ -160,12 +351,8 @@ namespace DSPJIT {
         const std::vector<llvm::Value*>& inputs)
     {
         auto& state = _memory_mgr.get_or_create(node);
-        llvm::Value *state_ptr = nullptr;
         llvm::Value *static_memory_chunk = nullptr;
 
-        if (node.mutable_state_size != 0u)
-            state_ptr = state.get_mutable_state_ptr(_builder, _instance_num);
-
         if (node.use_static_memory) {
             auto memory_chunk = _memory_mgr.get_static_memory_ref(_builder, node);
 
@@ -179,35 +366,55 @@ namespace DSPJIT {
             }
         }
 
-        node.push_input(*this, inputs, state_ptr, static_memory_chunk);
+        _emit_node_code(node, &state, inputs, static_memory_chunk,
+            [this, &node](const auto& lane_inputs, llvm::Value *state_ptr, llvm::Value *static_memory)
+            {
+                node.push_input(*this, lane_inputs, state_ptr, static_memory);
+                return std::vector<llvm::Value*>{};
+            });
     }
 
     void graph_compiler::_compute_node_output_values(
-        const compile_node_class& node,
+        std::size_t index,
         const std::vector<llvm::Value*>& inputs)
     {
+        const auto& node = *_nodes[index].node;
+
+        //  Node values are accessed by index after the node code is emitted,
+        //  as emitting code can compile other nodes (composite nodes)
+        const auto set_output_values =
+            [this, &node, index](const std::vector<llvm::Value*>& output_values)
+            {
+                for (auto i = 0u; i < output_values.size(); ++i) {
+                    auto& output = _node_output(index, i);
+                    // This output was delayed because of a cycle : the state was created when the cycle was found
+                    if (output != nullptr)
+                        _store_cycle_state(_memory_mgr.get_or_create(node), i, output_values[i]);
+                    output = output_values[i];
+                }
+            };
+
+        if (node.is_pure()) {
+            if (node.mutable_state_size != 0u || node.use_static_memory || !node.dependant_process)
+                throw std::logic_error("graph_compiler: a pure node must be a dependant process node without mutable state nor static memory");
+            set_output_values(_compute_pure_node_output_values(index, inputs));
+            return;
+        }
+
         auto& state = _memory_mgr.get_or_create(node);
+        _statistics.compiled_node_count++;
 
-        // get mutable state and static memory ptr if needed
-        llvm::Value *state_ptr = nullptr;
+        // get static memory ptr if needed
         llvm::Value *static_memory_chunk = nullptr;
 
-        if (node.mutable_state_size != 0u)
-            state_ptr = state.get_mutable_state_ptr(_builder, _instance_num);
-
         if (node.use_static_memory) {
             auto memory_chunk = _memory_mgr.get_static_memory_ref(_builder, node);
 
             if (memory_chunk == nullptr) {
                 // No memory chunk was registered for this node : it can't be compiled
                 // => Set output with dummy zeros
-                const auto node_value_it = _nodes_value.find(&node);
-                auto& node_output = node_value_it == _nodes_value.end() ?
-                    _assign_null_values(node) :
-                    node_value_it->second;
-
-                std::vector<llvm::Value*> zeros(node.get_output_count());
-                std::generate(node_output.begin(), node_output.end(), [this]() { return _create_zero();} );
+                for (auto i = 0u; i < node.get_output_count(); ++i)
+                    _node_output(index, i) = _create_zero();
                 return;
             }
             else {
@@ -218,53 +425,162 @@ namespace DSPJIT {
 
         // compile processing
         if (node.dependant_process == true) {
-            const auto node_value_it = _nodes_value.find(&node);
+            set_output_values(
+                _emit_node_code(node, &state, inputs, static_memory_chunk,
+                    [this, &node](const auto& lane_inputs, llvm::Value *state_ptr, llvm::Value *static_memory)
+                    {
+                        return node.emit_outputs(*this, lane_inputs, state_ptr, static_memory);
+                    }));
+        }
+        else {
+            // The node was just visited : no cycle can have been found yet
+            set_output_values(
+                _emit_node_code(node, &state, {}, static_memory_chunk,
+                    [this, &node](const auto&, llvm::Value *state_ptr, llvm::Value *static_memory)
+                    {
+                        return node.pull_output(*this, state_ptr, static_memory);
+                    }));
+        }
+    }
 
-            if (node_value_it == _nodes_value.end())
-                throw std::runtime_error("graph_compiler::node_value node values have not been initialized");
+    llvm::Value *graph_compiler::_load_cycle_state(abstract_node_state& state, unsigned int output_id)
+    {
+        // Lanes cycle states are contiguous
+        const auto type = value_type();
+        const auto cycle_ptr =
+            _builder.CreateBitCast(
+                state.get_cycle_state_ptr(_builder, _instance_num, output_id),
+                type->getPointerTo());
+        return _builder.CreateAlignedLoad(type, cycle_ptr, llvm::Align{alignof(float)});
+    }
 
-            auto &node_output = node_value_it->second;
-            const auto output_values =
-                node.emit_outputs(*this, inputs, state_ptr, static_memory_chunk);
+    void graph_compiler::_store_cycle_state(abstract_node_state& state, unsigned int output_id, llvm::Value *value)
+    {
+        const auto cycle_ptr =
+            _builder.CreateBitCast(
+                state.get_cycle_state_ptr(_builder, _instance_num, output_id),
+                value_type()->getPointerTo());
+        _builder.CreateAlignedStore(value, cycle_ptr, llvm::Align{alignof(float)});
+    }
 
-            for (auto i = 0u; i < output_values.size(); ++i) {
-                // This output was delayed because of a cycle
-                if (node_output[i] != nullptr) {
-                    auto cycle_ptr =
-                        state.get_cycle_state_ptr(_builder, _instance_num, i);
-                    _builder.CreateStore(output_values[i], cycle_ptr);
-                }
-                node_output[i] = output_values[i];
+    std::vector<llvm::Value*> graph_compiler::_compute_pure_node_output_values(
+        std::size_t index,
+        const std::vector<llvm::Value*>& inputs)
+    {
+        const auto& node = *_nodes[index].node;
+
+        //  Look for an equivalent node with the same input values
+        const auto key = _pure_node_key(inputs);
+        const auto first_candidate = _pure_nodes.find(key);
+        auto candidate = (first_candidate == _pure_nodes.end()) ? npos : first_candidate->second;
+
+        for (; candidate != npos; candidate = _nodes[candidate].next_pure_node) {
+            const auto& candidate_entry = _nodes[candidate];
+            const auto candidate_inputs = _pure_inputs.begin() + candidate_entry.pure_input_offset;
+
+            if (candidate_entry.node->get_input_count() == inputs.size() &&
+                std::equal(inputs.begin(), inputs.end(), candidate_inputs) &&
+                node.is_equivalent(*candidate_entry.node)) {
+                const auto output_begin = _values.begin() + candidate_entry.value_offset;
+                _statistics.merged_node_count++;
+                return {output_begin, output_begin + node.get_output_count()};
             }
         }
-        else {
-            // not entry at this point
-            auto success =
-                _nodes_value.emplace(
-                    &node,
-                    node.pull_output(*this, state_ptr, static_memory_chunk)).second;
-
-            if (!success)
-                throw std::runtime_error("graph_compiler::_get_node_output_values: Could not insert output values of a non dependant process node");
-        }
+
+        //  Pure nodes have no mutable state : the state is not needed to emit their code
+        const auto output_values =
+            _emit_node_code(node, nullptr, inputs, nullptr,
+                [this, &node](const auto& lane_inputs, llvm::Value *, llvm::Value *)
+                {
+                    return node.emit_outputs(*this, lane_inputs, nullptr, nullptr);
+                });
+
+        //  Constant inputs are folded by the instruction builder
+        const auto is_constant = [](llvm::Value *value) { return llvm::isa<llvm::Constant>(value); };
+        if (std::all_of(inputs.begin(), inputs.end(), is_constant) &&
+            std::all_of(output_values.begin(), output_values.end(), is_constant))
+            _statistics.folded_node_count++;
+        else
+            _statistics.compiled_node_count++;
+
+        //  Record the node at the head of its key list
+        const auto head = _pure_nodes.try_emplace(key, index);
+        _nodes[index].pure_input_offset = _pure_inputs.size();
+        _nodes[index].next_pure_node = head.second ? npos : head.first->second;
+        head.first->second = index;
+        _pure_inputs.insert(_pure_inputs.end(), inputs.begin(), inputs.end());
+
+        return output_values;
     }
 
-    std::vector<llvm::Value*>& graph_compiler::_assign_null_values(const compile_node_class &node)
+    std::size_t graph_compiler::_pure_node_key(const std::vector<llvm::Value*>& inputs) noexcept
     {
-        const auto result = _nodes_value.emplace(
-            &node,
-            std::vector<llvm::Value *>{node.get_output_count(), nullptr});
+        //  The two largest keys are reserved by llvm::DenseMap
+        return static_cast<std::size_t>(llvm::hash_combine_range(inputs.begin(), inputs.end())) >> 1u;
+    }
 
-        if (result.second == false)
-            throw std::runtime_error("graph_compiler::_assign_null_values node values have already been initialized");
+    llvm::Type *graph_compiler::value_type()
+    {
+        if (_vector_width == 1u)
+            return _builder.getFloatTy();
+        else
+            return llvm::FixedVectorType::get(_builder.getFloatTy(), _vector_width);
+    }
+
+    llvm::Value *graph_compiler::create_constant(float value)
+    {
+        return llvm::ConstantFP::get(value_type(), value);
+    }
+
+    llvm::Value *graph_compiler::broadcast(llvm::Value *scalar)
+    {
+        if (_vector_width == 1u)
+            return scalar;
+        else
+            return _builder.CreateVectorSplat(_vector_width, scalar);
+    }
+
+    llvm::Value *graph_compiler::parameter_value(const parameter_block& parameters, parameter_block::slot_t slot)
+    {
+        if (&parameters != _parameters)
+            throw std::invalid_argument("graph_compiler: the parameter does not belong to the compiled parameters");
+
+        auto& value = _parameter_values[slot];
+
+        if (value != nullptr)
+            return broadcast(value);
+
+        const auto promoted_value =
+            _constant_parameters ? std::optional<float>{_parameters->get(slot)} : _parameters->promote(slot);
+
+        if (promoted_value.has_value()) {
+            value = llvm::ConstantFP::get(_builder.getFloatTy(), *promoted_value);
+        }
+        else {
+            //  Read once per call, before the frame loop. The value can be written by another thread meanwhile
+            auto& entry_block = _builder.GetInsertBlock()->getParent()->getEntryBlock();
+            llvm::IRBuilder<> entry_builder{&entry_block,
+                entry_block.getTerminator() == nullptr ? entry_block.end() : entry_block.getTerminator()->getIterator()};
+
+            //  The block is referenced like the states : the code does not depend on its address
+            const auto block =
+                _memory_mgr.get_memory_region_ref(
+                    entry_builder, _parameters->data(), _parameters->capacity() * sizeof(float));
+            const auto pointer =
+                entry_builder.CreateConstInBoundsGEP1_64(
+                    entry_builder.getFloatTy(),
+                    entry_builder.CreateBitCast(block, entry_builder.getFloatTy()->getPointerTo()),
+                    slot);
+            const auto load = entry_builder.CreateAlignedLoad(entry_builder.getFloatTy(), pointer, llvm::Align{alignof(float)});
+            load->setAtomic(llvm::AtomicOrdering::Monotonic);
+            value = load;
+        }
 
-        return result.first->second;
+        return broadcast(value);
     }
 
     llvm::Value *graph_compiler::_create_zero()
     {
-        return llvm::ConstantFP::get(
-                _builder.getContext(),
-                llvm::APFloat::getZero(llvm::APFloat::IEEEsingle()));
+        return create_constant(0.f);
     }
 }
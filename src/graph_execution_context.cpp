@@ -1,10 +1,13 @@
+#include <llvm/ADT/Hashing.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
 #include <llvm/ExecutionEngine/ExecutionEngine.h>
 #include <llvm/ExecutionEngine/SectionMemoryManager.h>
 #include <llvm/Linker/Linker.h>
+#include <llvm/Support/FileSystem.h>
 #include <llvm/Support/TargetSelect.h>
 #include <llvm/Support/raw_os_ostream.h>
-#include <llvm/Transforms/Utils/Cloning.h>
 
+#include <algorithm>
 #include <chrono>
 
 #include <DSPJIT/graph_compiler.h>
@@ -12,14 +15,31 @@
 #include <DSPJIT/ir_helper.h>
 #include <DSPJIT/log.h>
 
+#include "aot_export.h"
 #include "ir_optimization.h"
+#include "library_linking.h"
+#include "parallel_compilation.h"
+#include "process_variants.h"
 
 
 namespace DSPJIT {
 
+    /**
+     * \brief Return the time elapsed since a time point, and reset it to now
+     */
+    static compile_report::duration lap(std::chrono::steady_clock::time_point& time_point)
+    {
+        const auto now = std::chrono::steady_clock::now();
+        const auto elapsed = std::chrono::duration_cast<compile_report::duration>(now - time_point);
+        time_point = now;
+        return elapsed;
+    }
+
     graph_execution_context::graph_execution_context(
         std::unique_ptr<abstract_execution_engine>&& execution_engine,
-        std::unique_ptr<abstract_graph_memory_manager>&& state_manager)
+        std::unique_ptr<abstract_graph_memory_manager>&& state_manager,
+        const optimization_pipeline& pipeline,
+        background_optimizer::execution_engine_builder optimized_engine_builder)
     :   _llvm_context{state_manager->get_llvm_context()},
         _instance_count{state_manager->get_instance_count()},
         _current_sequence{0u},
@@ -28,52 +48,177 @@ namespace DSPJIT {
         _ack_msg_queue{256},
         _compile_done_msg_queue{256}
     {
-        // Create library module
+        // Create library module, set up once for the target as it is cloned by every compilation
+        const auto& target_machine = _execution_engine->get_target_machine();
         _library = std::make_unique<llvm::Module>("graph_execution_context.library", _llvm_context);
+        _library->setDataLayout(target_machine.createDataLayout());
+        _library->setTargetTriple(target_machine.getTargetTriple().str());
+
+        //  The optimization pipeline is built once and reused by every compilation
+        _ir_optimizer = std::make_unique<ir_optimizer>(pipeline, _execution_engine->get_target_machine());
+        _optimization_pipeline = pipeline;
+
+        if (optimized_engine_builder)
+            _optimizer = std::make_unique<background_optimizer>(std::move(optimized_engine_builder));
     }
 
+    graph_execution_context::~graph_execution_context() noexcept = default;
+
     void graph_execution_context::add_library_module(std::unique_ptr<llvm::Module>&& module)
     {
+        //  The library code is verified once, instead of at every compilation
+        std::string error_string{};
+        if (check_module(*module, error_string))
+            throw std::invalid_argument("graph_execution_context: malformed library module : " + error_string);
+
+        module->setDataLayout(_library->getDataLayout());
+        module->setTargetTriple(_library->getTargetTriple());
         llvm::Linker::linkModules(*_library, std::move(module));
     }
 
-    void graph_execution_context::compile(
+    compile_report graph_execution_context::compile(
             node_ref_list input_nodes,
             node_ref_list output_nodes)
     {
-        auto begin = std::chrono::steady_clock::now();
+        return compile(input_nodes, output_nodes, compile_hooks{});
+    }
+
+    compile_report graph_execution_context::compile(
+            node_ref_range input_nodes,
+            node_ref_range output_nodes,
+            const compile_hooks& hooks)
+    {
+        const auto begin = std::chrono::steady_clock::now();
+        auto phase_begin = begin;
+        compile_report report{};
+
+        const auto cancelled = [&hooks]() { return hooks.cancelled && hooks.cancelled(); };
 
-        // Process acq_msg : Clean unused stuff
+        // Process acq_msg : Clean unused stuff. Only the newest running sequence matters
         ack_msg msg;
-        if (_ack_msg_queue.dequeue(msg))
+        while (_ack_msg_queue.dequeue(msg))
             _process_ack_msg(msg);
+        _free_unused_programs();
+
+        if (cancelled()) {
+            LOG_INFO("[graph_execution_context][compile thread] graph compilation cancelled before it started\n");
+            report.cancelled = true;
+            return report;
+        }
 
         //  Start a new sequence
         _current_sequence++;
         _state_manager->begin_sequence(_current_sequence);
+        if (_composite_functions)
+            _composite_functions->begin_sequence(_current_sequence);
+        if (_optimizer)
+            _optimizer->begin_sequence(_current_sequence);
+        _parameters.begin_compilation();
+        report.seq = _current_sequence;
 
-        //  Create module and link library into it
-        auto module = std::make_unique<llvm::Module>("graph_execution_context.dsp." + std::to_string(_current_sequence), _llvm_context);
-        llvm::Linker::linkModules(*module, llvm::CloneModule(*_library));
+        //  Create module declaring the library symbols
+        //  The module name does not depend on the sequence, as it is part of the object cache key
+        lap(phase_begin);
+        auto module = declare_library(*_library, "graph_execution_context.dsp");
+        report.library_link_time = lap(phase_begin);
 
         //  Compile process function
         auto process_function =
             _compile_process_function(
                 input_nodes,
                 output_nodes,
-                *module);
+                *module,
+                "graph__process",
+                1u,
+                *_state_manager,
+                _composite_functions.get(),
+                &report,
+                true,
+                false);
+
+        //  Compile vector process function if needed
+        llvm::Function *process_vector_function = nullptr;
+        if (_vector_width > 1u) {
+            process_vector_function =
+                _compile_process_function(
+                    input_nodes,
+                    output_nodes,
+                    *module,
+                    "graph__process_vector",
+                    _vector_width,
+                    *_state_manager,
+                    _composite_functions.get(),
+                    nullptr,
+                    true,
+                    false);
+        }
+
+        //  A cached program of the same graph, using the same states, is published again without being compiled
+        std::optional<std::size_t> program_key{};
+        auto cached_program = _cached_programs.end();
+        if (_program_cache_capacity != 0u) {
+            program_key = _compute_program_key(*module);
+            cached_program =
+                std::find_if(_cached_programs.begin(), _cached_programs.end(),
+                    [&program_key](const auto& program) { return program.key == *program_key; });
+        }
+
+        report.graph_compilation_time = lap(phase_begin);
 
         auto initialize_functions =
             _state_manager->finish_sequence(*_execution_engine, *module);
+        const auto sequence_statistics = _state_manager->get_sequence_statistics();
+        report.new_state_count = sequence_statistics.new_state_count;
+        report.deleted_state_count = sequence_statistics.deleted_state_count;
+        report.initialize_compilation_time = lap(phase_begin);
+
+        if (cached_program != _cached_programs.end()) {
+            if (hooks.graph_compiled)
+                hooks.graph_compiled();
+
+            //  The sequence module is dropped
+            _state_manager->release_sequence_module();
+            _publish_cached_program(cached_program);
+
+            report.program_cache_hit = true;
+            report.total_time = std::chrono::duration_cast<compile_report::duration>(std::chrono::steady_clock::now() - begin);
+            LOG_INFO("[graph_execution_context][compile thread] graph program found in program cache (%u us)\n",
+                static_cast<unsigned int>(report.total_time.count()));
+            return report;
+        }
+
+        //  Only the library code used by the program is copied in its module
+        link_library_dependencies(*module, *_library);
+        report.library_link_time += lap(phase_begin);
+
+        //  The module does not reference the graph nodes anymore
+        if (hooks.graph_compiled)
+            hooks.graph_compiled();
+
+        if (cancelled()) {
+            _cancel_sequence(report);
+            report.total_time = std::chrono::duration_cast<compile_report::duration>(std::chrono::steady_clock::now() - begin);
+            return report;
+        }
 
         if (_ir_dump) {
             LOG_INFO("[graph_execution_context][compile thread] IR code before optimization\n");
             log_function(*process_function);
+            if (process_vector_function != nullptr)
+                log_function(*process_vector_function);
             log_function(*initialize_functions.initialize);
             log_function(*initialize_functions.initialize_new_nodes);
         }
 
-        // Make all functions internal except the three that will be directly called
+        //  Run the best process functions variant supported by the host, if any
+        if (_host_process_variant.has_value()) {
+            const auto& cpu = _process_variants[*_host_process_variant];
+            process_function = create_process_variants(*process_function, {cpu}).front();
+            if (process_vector_function != nullptr)
+                process_vector_function = create_process_variants(*process_vector_function, {cpu}).front();
+        }
+
+        // Make all functions internal except the ones that will be directly called
         // This allow to remove all unused global code
         for (auto& function: *module) {
             const auto function_name = function.getName();
@@ -81,6 +226,7 @@ namespace DSPJIT {
             // and the process api functions which will be called directly
             if (!function.isDeclaration() &&
                 !(&function == process_function ||
+                  &function == process_vector_function ||
                   &function == initialize_functions.initialize ||
                   &function == initialize_functions.initialize_new_nodes))
             {
@@ -88,21 +234,234 @@ namespace DSPJIT {
             }
         }
 
-        run_optimization(*module);
+        //  Name the module after its code, so that the same graph reuse the cached native code
+        //  The object is read now : the module is only left unoptimized if its native code is actually available
+        std::unique_ptr<llvm::MemoryBuffer> cached_object_buffer{};
+        if (_object_cache) {
+            module->setModuleIdentifier(
+                object_cache::compute_key(*module, _execution_engine->get_target_machine(), _optimization_pipeline));
+            cached_object_buffer = _object_cache->getObject(module.get());
+        }
+        const auto cached_object = (cached_object_buffer != nullptr);
+
+        //  With tiered compilation, the unoptimized code is published first and optimized in background
+        background_optimizer::job optimization_job{};
+        if (_optimizer)
+            optimization_job = _create_optimization_job(*module, process_function, process_vector_function, initialize_functions);
+
+        //  Large programs are split into partitions which are optimized and compiled in parallel
+        auto process_instruction_count = process_function->getInstructionCount();
+        if (process_vector_function != nullptr)
+            process_instruction_count += process_vector_function->getInstructionCount();
+
+        const auto partitioned =
+            !cached_object && !_optimizer &&
+            _partition_compiler != nullptr &&
+            process_instruction_count >= _parallel_compilation_min_instruction_count;
+
+        //  Optimizing is useless if the native code will be loaded from cache
+        report.instruction_count_before_optimization = module->getInstructionCount();
+        report.object_cache_hit = cached_object;
+        lap(phase_begin);
+
+        //  The native code, if it was not generated by the execution engine
+        std::vector<std::unique_ptr<llvm::MemoryBuffer>> objects{};
+        compiled_partitions partitions{};
+        if (cached_object) {
+            LOG_INFO("[graph_execution_context][compile thread] Found native code in object cache\n");
+            objects.push_back(std::move(cached_object_buffer));
+        }
+        else if (partitioned) {
+            const auto suffix = "part" + std::to_string(_current_sequence);
+            const auto partition_count = _partition_compiler->get_thread_count();
+            outline_partitions(*process_function, partition_count, suffix);
+            if (process_vector_function != nullptr)
+                outline_partitions(*process_vector_function, partition_count, suffix);
+
+            partitions = _partition_compiler->compile(split_module(*module, partition_count));
+            report.partition_count = partitions.objects.size();
+            objects = std::move(partitions.objects);
+        }
+        else if (!_optimizer) {
+            _ir_optimizer->run(*module);
+        }
+
+        report.optimization_time = lap(phase_begin);
+        report.instruction_count_after_optimization =
+            partitioned ? partitions.instruction_count : module->getInstructionCount();
 
         if (_ir_dump) {
             LOG_INFO("[graph_execution_context][compile thread] IR code after optimization\n");
             log_function(*process_function);
+            if (process_vector_function != nullptr)
+                log_function(*process_vector_function);
             log_function(*initialize_functions.initialize);
             log_function(*initialize_functions.initialize_new_nodes);
         }
 
+        if (cancelled()) {
+            _cancel_sequence(report);
+            report.total_time = std::chrono::duration_cast<compile_report::duration>(std::chrono::steady_clock::now() - begin);
+            return report;
+        }
+
+        //  The cached program keeps the composite functions it calls
+        std::vector<std::string> symbols{};
+        if (program_key.has_value()) {
+            for (const auto& function : *module) {
+                if (function.isDeclaration())
+                    symbols.push_back(function.getName().str());
+            }
+        }
+
         //  Compile LLVM IR to native code
-        _emit_native_code(std::move(module), process_function, initialize_functions);
+        const auto module_ptr = module.get();
+        const auto program =
+            _emit_native_code(
+                std::move(module), process_function, process_vector_function, initialize_functions,
+                std::move(objects), report);
 
-        auto end = std::chrono::steady_clock::now();
-        LOG_INFO("[graph_execution_context][compile thread] graph compilation finished (%u ms)\n",
-            std::chrono::duration_cast<std::chrono::milliseconds>(end - begin));
+        if (_optimizer)
+            _resolve_optimization_job_symbols(optimization_job);
+
+        if (program_key.has_value())
+            _cache_program(*program_key, module_ptr, program, symbols, _optimizer ? &optimization_job : nullptr);
+
+        if (_optimizer)
+            _submit_optimization_job(std::move(optimization_job));
+
+        report.total_time = std::chrono::duration_cast<compile_report::duration>(std::chrono::steady_clock::now() - begin);
+
+        LOG_INFO("[graph_execution_context][compile thread] graph compilation finished (%u ms) : "
+            "link %u us, graph %u us, init %u us, optimization %u us, verification %u us, native code %u us, "
+            "%lu nodes (%lu folded, %lu merged), %lu -> %lu instructions, %lu bytes of native code, %lu new states, %lu deleted states\n",
+            static_cast<unsigned int>(std::chrono::duration_cast<std::chrono::milliseconds>(report.total_time).count()),
+            static_cast<unsigned int>(report.library_link_time.count()),
+            static_cast<unsigned int>(report.graph_compilation_time.count()),
+            static_cast<unsigned int>(report.initialize_compilation_time.count()),
+            static_cast<unsigned int>(report.optimization_time.count()),
+            static_cast<unsigned int>(report.verification_time.count()),
+            static_cast<unsigned int>(report.native_code_generation_time.count()),
+            report.compiled_node_count, report.folded_node_count, report.merged_node_count,
+            report.instruction_count_before_optimization, report.instruction_count_after_optimization,
+            report.native_code_size, report.new_state_count, report.deleted_state_count);
+
+        return report;
+    }
+
+    void graph_execution_context::export_program(
+        node_ref_list input_nodes,
+        node_ref_list output_nodes,
+        const std::string& path,
+        export_format format)
+    {
+        //  The program is compiled with its own states, which are then defined in the module.
+        //  The memory manager must not outlive the module
+        auto module = declare_library(*_library, "graph_execution_context.aot");
+        auto memory_manager = _state_manager->clone_without_states();
+
+        memory_manager->begin_sequence(1u);
+
+        //  Composite nodes are inlined, as the cached functions are only available in the JIT
+        auto process_function =
+            _compile_process_function(
+                input_nodes, output_nodes, *module,
+                "graph__process", 1u, *memory_manager, nullptr, nullptr, false, true);
+
+        llvm::Function *process_vector_function = nullptr;
+        if (_vector_width > 1u) {
+            process_vector_function =
+                _compile_process_function(
+                    input_nodes, output_nodes, *module,
+                    "graph__process_vector", _vector_width, *memory_manager, nullptr, nullptr, false, true);
+        }
+
+        const auto initialize_functions = memory_manager->finish_sequence(*_execution_engine, *module);
+        memory_manager->define_sequence_symbols(*module);
+        link_library_dependencies(*module, *_library);
+
+        //  The states are defined in the module : the exported initialize function does not take a region table
+        auto initialize_function =
+            llvm::Function::Create(
+                llvm::FunctionType::get(llvm::Type::getVoidTy(_llvm_context), {llvm::Type::getInt64Ty(_llvm_context)}, false),
+                llvm::Function::ExternalLinkage, "", module.get());
+        {
+            llvm::IRBuilder builder{llvm::BasicBlock::Create(_llvm_context, "entry", initialize_function)};
+            builder.CreateCall(
+                initialize_functions.initialize,
+                {initialize_function->getArg(0u), llvm::ConstantPointerNull::get(builder.getInt8PtrTy()->getPointerTo())});
+            builder.CreateRetVoid();
+            initialize_function->takeName(initialize_functions.initialize);
+        }
+
+        //  Program description helpers
+        std::vector<llvm::Function*> exported_functions{process_function, process_vector_function, initialize_function};
+        for (auto function : {process_function, process_vector_function}) {
+            if (function != nullptr) {
+                const auto variants = create_process_variants(*function, _process_variants);
+                exported_functions.insert(exported_functions.end(), variants.begin(), variants.end());
+            }
+        }
+
+        const std::pair<const char*, std::size_t> constants[] = {
+            {"graph__get_instance_count", _instance_count},
+            {"graph__get_input_count", _io_count(input_nodes, true)},
+            {"graph__get_output_count", _io_count(output_nodes, false)}
+        };
+
+        for (const auto& constant : constants) {
+            auto function =
+                llvm::Function::Create(
+                    llvm::FunctionType::get(llvm::Type::getInt64Ty(_llvm_context), false),
+                    llvm::Function::ExternalLinkage, constant.first, module.get());
+            llvm::IRBuilder builder{llvm::BasicBlock::Create(_llvm_context, "entry", function)};
+            builder.CreateRet(builder.getInt64(constant.second));
+            exported_functions.push_back(function);
+        }
+
+        //  Only the program functions are exported
+        for (auto& function: *module) {
+            if (!function.isDeclaration() &&
+                std::find(exported_functions.begin(), exported_functions.end(), &function) == exported_functions.end())
+                function.setLinkage(llvm::GlobalValue::LinkageTypes::InternalLinkage);
+        }
+
+        for (auto& global : module->globals()) {
+            if (!global.isDeclaration())
+                global.setLinkage(llvm::GlobalValue::LinkageTypes::InternalLinkage);
+        }
+
+        auto target_machine = create_aot_target_machine(_execution_engine->get_target_machine());
+        run_optimization(*module, _optimization_pipeline, *target_machine);
+
+        std::string error_string{};
+        if (check_module(*module, error_string))
+            throw std::runtime_error("graph_execution_context: malformed exported module : " + error_string);
+
+        if (_ir_dump) {
+            LOG_INFO("[graph_execution_context][compile thread] Exported IR code\n");
+            log_module(*module);
+        }
+
+        if (format == export_format::object_file) {
+            emit_object_file(*module, *target_machine, path);
+        }
+        else {
+            const auto object_path = path + ".o";
+            emit_object_file(*module, *target_machine, object_path);
+
+            try {
+                link_shared_library(object_path, path);
+            }
+            catch (...) {
+                llvm::sys::fs::remove(object_path);
+                throw;
+            }
+
+            llvm::sys::fs::remove(object_path);
+        }
+
+        LOG_INFO("[graph_execution_context][compile thread] Exported program to %s\n", path.c_str());
     }
 
     void graph_execution_context::enable_ir_dump(bool enable)
@@ -110,6 +469,84 @@ namespace DSPJIT {
         _ir_dump = enable;
     }
 
+    void graph_execution_context::set_vector_width(std::size_t vector_width)
+    {
+        if (vector_width == 0u || _instance_count % vector_width != 0u)
+            throw std::invalid_argument("graph_execution_context: vector width must divide the instance count");
+
+        _vector_width = vector_width;
+    }
+
+    void graph_execution_context::set_process_variants(const std::vector<std::string>& cpus)
+    {
+        const auto& target_machine = _execution_engine->get_target_machine();
+        std::optional<std::size_t> host_variant{};
+
+        for (auto i = 0u; i < cpus.size(); ++i) {
+            if (!is_valid_cpu(target_machine, cpus[i]))
+                throw std::invalid_argument("graph_execution_context: unknown cpu " + cpus[i]);
+            if (is_cpu_supported_by_host(target_machine, cpus[i]))
+                host_variant = i;
+        }
+
+        _process_variants = cpus;
+        _host_process_variant = host_variant;
+    }
+
+    void graph_execution_context::enable_parallel_compilation(std::size_t thread_count, std::size_t min_instruction_count)
+    {
+        //  The workers are created once, and kept from one compilation to the next
+        if (thread_count < 2u)
+            _partition_compiler.reset();
+        else if (!_partition_compiler || _partition_compiler->get_thread_count() != thread_count)
+            _partition_compiler =
+                std::make_unique<partition_compiler>(
+                    _execution_engine->get_target_machine(), _optimization_pipeline, thread_count);
+
+        _parallel_compilation_min_instruction_count = min_instruction_count;
+    }
+
+    std::size_t graph_execution_context::get_parallel_compilation_thread_count() const noexcept
+    {
+        return _partition_compiler ? _partition_compiler->get_thread_count() : 0u;
+    }
+
+    void graph_execution_context::enable_program_cache(std::size_t capacity)
+    {
+        _program_cache_capacity = capacity;
+        _evict_cached_programs();
+    }
+
+    void graph_execution_context::set_optimization_pipeline(const optimization_pipeline& pipeline)
+    {
+        _ir_optimizer->set_pipeline(pipeline);
+        if (_partition_compiler)
+            _partition_compiler->set_pipeline(pipeline);
+        _optimization_pipeline = pipeline;
+    }
+
+    void graph_execution_context::enable_incremental_compilation(bool enable)
+    {
+        if (enable && !_composite_functions) {
+            _composite_functions =
+                std::make_unique<composite_function_cache>(
+                    *_execution_engine, *_state_manager, *_library, *_ir_optimizer);
+            _composite_functions->set_object_cache(_object_cache.get());
+        }
+        else if (!enable) {
+            //  The functions modules are kept by the execution engine, as they can still be in use
+            _composite_functions.reset();
+        }
+    }
+
+    void graph_execution_context::enable_object_cache(const std::string& directory)
+    {
+        _object_cache = std::make_unique<object_cache>(directory);
+        _execution_engine->set_object_cache(_object_cache.get());
+        if (_composite_functions)
+            _composite_functions->set_object_cache(_object_cache.get());
+    }
+
     void graph_execution_context::set_global_constant(const std::string& name, float value)
     {
         _library->getOrInsertGlobal(name, llvm::Type::getFloatTy(_llvm_context));
@@ -141,6 +578,7 @@ namespace DSPJIT {
     bool graph_execution_context::update_program() noexcept
     {
         compile_done_msg msg;
+        background_optimizer::program optimized_program;
 
         //  Process one compile done msg (if any)
         //  and update native code ptr
@@ -148,6 +586,23 @@ namespace DSPJIT {
             _process_compile_done_msg(msg);
             return true;
         }
+        //  Or jump to the newest program. It can be older than the running one if the publication mode was changed
+        else if (_latest_program.read(msg) && msg.seq > _running_sequence) {
+            _process_compile_done_msg(msg);
+            return true;
+        }
+        //  Else swap in the optimized version of the running program (if any)
+        else if (_optimizer && _optimizer->get_optimized_program(_running_sequence, optimized_program)) {
+            LOG_DEBUG("[graph_execution_context][process thread] Use optimized program (seq = %u)\n", optimized_program.seq);
+
+            _process_func = reinterpret_cast<native_process_func>(optimized_program.process_func);
+            if (optimized_program.process_vector_func != nullptr)
+                _process_vector_func = reinterpret_cast<native_process_func>(optimized_program.process_vector_func);
+            _initialize_func = reinterpret_cast<native_initialize_func>(optimized_program.initialize_func);
+
+            _optimizer->using_sequence(optimized_program.seq);
+            return true;
+        }
         else {
             return false;
         }
@@ -155,64 +610,155 @@ namespace DSPJIT {
 
     void graph_execution_context::process(std::size_t instance_num, const float * inputs, float *outputs) noexcept
     {
-        _process_func(instance_num, inputs, outputs);
+        _process_func(instance_num, inputs, outputs, 1u, _regions);
+    }
+
+    void graph_execution_context::process_block(std::size_t instance_num, const float * inputs, float *outputs, std::size_t frame_count) noexcept
+    {
+        _process_func(instance_num, inputs, outputs, frame_count, _regions);
+    }
+
+    void graph_execution_context::process_vector_block(std::size_t instance_num, const float * inputs, float *outputs, std::size_t frame_count) noexcept
+    {
+        _process_vector_func(instance_num, inputs, outputs, frame_count, _regions);
     }
 
     void graph_execution_context::initialize_state(std::size_t instance_num) noexcept
     {
-        _initialize_func(instance_num);
+        _initialize_func(instance_num, _regions);
     }
 
     llvm::Function * graph_execution_context::_compile_process_function(
-        node_ref_list input_nodes,
-        node_ref_list output_nodes,
-        llvm::Module& graph_module)
+        node_ref_range input_nodes,
+        node_ref_range output_nodes,
+        llvm::Module& graph_module,
+        const std::string& symbol,
+        unsigned int vector_width,
+        abstract_graph_memory_manager& memory_manager,
+        composite_function_cache *composite_functions,
+        compile_report *report,
+        bool region_table_argument,
+        bool constant_parameters)
     {
-        //  Create ir function : signature = void _(int64 instance_num, float *inputs, float *outputs)
+        //  Create ir function : signature = void _(int64 instance_num, float *inputs, float *outputs, int64 frame_count [, int8 **region_table])
         std::vector<llvm::Type*> arg_types{
             llvm::Type::getInt64Ty(_llvm_context),
             llvm::Type::getFloatPtrTy(_llvm_context),
-            llvm::Type::getFloatPtrTy(_llvm_context)};
-
-        auto func_type = llvm::FunctionType::get(llvm::Type::getVoidTy(_llvm_context), arg_types, false /* is_var_arg */);
-        auto function = llvm::Function::Create(func_type, llvm::Function::ExternalLinkage, "graph__process", &graph_module);
+            llvm::Type::getFloatPtrTy(_llvm_context),
+            llvm::Type::getInt64Ty(_llvm_context)};
 
-        //  Create function code block
-        auto basic_block = llvm::BasicBlock::Create(_llvm_context, "", function);
+        if (region_table_argument)
+            arg_types.push_back(llvm::Type::getInt8PtrTy(_llvm_context)->getPointerTo());
 
-        //  Create instruction builder
-        llvm::IRBuilder builder(_llvm_context);
-        builder.SetInsertPoint(basic_block);
+        auto func_type = llvm::FunctionType::get(llvm::Type::getVoidTy(_llvm_context), arg_types, false /* is_var_arg */);
+        auto function = llvm::Function::Create(func_type, llvm::Function::ExternalLinkage, symbol, &graph_module);
 
         //  Get arguments
         auto arg_begin = function->arg_begin();
         auto instance_num_value = arg_begin++;
         auto inputs_array_value = arg_begin++;
         auto outputs_array_value = arg_begin++;
+        auto frame_count_value = arg_begin++;
+
+        //  The I/O arrays are only accessed by the function. They can be the same buffer unless the user promised otherwise
+        for (auto array : {inputs_array_value, outputs_array_value}) {
+            if (_non_overlapping_io)
+                array->addAttr(llvm::Attribute::NoAlias);
+            array->addAttr(llvm::Attribute::NoCapture);
+        }
+        inputs_array_value->addAttr(llvm::Attribute::ReadOnly);
+
+        if (region_table_argument) {
+            auto region_table_value = arg_begin++;
+            region_table_value->addAttr(llvm::Attribute::NoAlias);
+            region_table_value->addAttr(llvm::Attribute::NoCapture);
+            region_table_value->addAttr(llvm::Attribute::ReadOnly);
+            memory_manager.set_sequence_region_table(region_table_value);
+        }
+
+        //  Create function code blocks : the sample loop is emitted inside the function
+        auto entry_block = llvm::BasicBlock::Create(_llvm_context, "entry", function);
+        auto loop_block = llvm::BasicBlock::Create(_llvm_context, "frame_loop", function);
+        auto exit_block = llvm::BasicBlock::Create(_llvm_context, "exit", function);
+
+        //  Create instruction builder
+        llvm::IRBuilder builder(_llvm_context);
+        builder.SetInsertPoint(entry_block);
+
+        //  Do not enter the loop if there is no frame to process
+        builder.CreateCondBr(
+            builder.CreateICmpEQ(frame_count_value, builder.getInt64(0u)),
+            exit_block, loop_block);
+
+        //  Frame index
+        builder.SetInsertPoint(loop_block);
+        auto frame_index = builder.CreatePHI(builder.getInt64Ty(), 2u);
+        frame_index->addIncoming(builder.getInt64(0u), entry_block);
+
+        //  Current frame I/O pointers
+        const auto frame_input_ptr =
+            builder.CreateGEP(
+                builder.getFloatTy(), inputs_array_value,
+                builder.CreateMul(frame_index, builder.getInt64(_io_count(input_nodes, true) * vector_width)));
+        const auto frame_output_ptr =
+            builder.CreateGEP(
+                builder.getFloatTy(), outputs_array_value,
+                builder.CreateMul(frame_index, builder.getInt64(_io_count(output_nodes, false) * vector_width)));
 
         //  Create graph compiler
-        graph_compiler compiler{builder, instance_num_value, *_state_manager};
+        graph_compiler compiler{
+            builder, instance_num_value, memory_manager, vector_width, composite_functions, &_parameters, constant_parameters};
 
         //  generate code that load inputs from input array and
         //  register input_nodes output as value.
         _load_graph_input_values(
-            compiler, input_nodes, inputs_array_value);
+            compiler, input_nodes, frame_input_ptr);
 
         //  Compute output_nodes inputs and store them to output array
         _compile_and_store_graph_output_values(
-            compiler, output_nodes, outputs_array_value, instance_num_value);
+            compiler, output_nodes, frame_output_ptr);
+
+        //  Go to next frame. Nodes could have created new blocks : use the current one as loop latch
+        const auto next_frame_index = builder.CreateAdd(frame_index, builder.getInt64(1u));
+        frame_index->addIncoming(next_frame_index, builder.GetInsertBlock());
+        builder.CreateCondBr(
+            builder.CreateICmpEQ(next_frame_index, frame_count_value),
+            exit_block, loop_block);
 
         //  Finish function by insterting a ret instruction
+        builder.SetInsertPoint(exit_block);
         builder.CreateRetVoid();
+
+        annotate_memory_accesses(*function);
+
+        if (report != nullptr) {
+            const auto& statistics = compiler.get_statistics();
+            report->compiled_node_count = statistics.compiled_node_count;
+            report->folded_node_count = statistics.folded_node_count;
+            report->merged_node_count = statistics.merged_node_count;
+        }
+
         return function;
     }
 
+    std::size_t graph_execution_context::_io_count(node_ref_range nodes, bool input)
+    {
+        std::size_t count = 0u;
+
+        for (const auto& node : nodes)
+            count += input ? node.get().get_output_count() : node.get().get_input_count();
+
+        return count;
+    }
+
     void graph_execution_context::_load_graph_input_values(
         graph_compiler& compiler,
-        node_ref_list input_nodes,
-        llvm::Argument *input_array)
+        node_ref_range input_nodes,
+        llvm::Value *input_array)
     {
         auto& builder = compiler.builder();
+        const auto value_type = compiler.value_type();
+        const auto vector_width = compiler.vector_width();
         auto input_index = 0u;
 
         for (const auto &input_node : input_nodes) {
@@ -220,9 +766,10 @@ namespace DSPJIT {
             std::vector<llvm::Value *> input_values{output_count};
 
             for (auto i = 0u; i < output_count; ++i) {
-                auto index_value = llvm::ConstantInt::get(_llvm_context, llvm::APInt(64, input_index));
+                auto index_value = llvm::ConstantInt::get(_llvm_context, llvm::APInt(64, input_index * vector_width));
                 auto input_ptr = builder.CreateGEP(builder.getFloatTy(), input_array, index_value);
-                input_values[i] = builder.CreateLoad(builder.getFloatTy(), input_ptr);
+                input_values[i] = builder.CreateAlignedLoad(
+                    value_type, builder.CreateBitCast(input_ptr, value_type->getPointerTo()), llvm::Align{alignof(float)});
                 input_index++;
             }
 
@@ -232,11 +779,12 @@ namespace DSPJIT {
 
     void graph_execution_context::_compile_and_store_graph_output_values(
         graph_compiler& compiler,
-        node_ref_list output_nodes,
-        llvm::Argument *output_array,
-        llvm::Value *instance_num)
+        node_ref_range output_nodes,
+        llvm::Value *output_array)
     {
         auto& builder = compiler.builder();
+        const auto value_type = compiler.value_type();
+        const auto vector_width = compiler.vector_width();
 
         auto output_index = 0u;
         for (const auto& output_node : output_nodes) {
@@ -246,67 +794,371 @@ namespace DSPJIT {
                 unsigned int output_id = 0u;
                 const auto dependency_node = output_node.get().get_input(i, output_id);
                 auto value = compiler.node_value(dependency_node, output_id);
-                auto index_value = llvm::ConstantInt::get(_llvm_context, llvm::APInt(64, output_index));
+                auto index_value = llvm::ConstantInt::get(_llvm_context, llvm::APInt(64, output_index * vector_width));
                 auto output_ptr = builder.CreateGEP(builder.getFloatTy(), output_array, index_value);
-                builder.CreateStore(value, output_ptr);
+                builder.CreateAlignedStore(
+                    value, builder.CreateBitCast(output_ptr, value_type->getPointerTo()), llvm::Align{alignof(float)});
                 output_index++;
             }
         }
     }
 
-    void graph_execution_context::_emit_native_code(
+    graph_execution_context::compile_done_msg graph_execution_context::_emit_native_code(
         std::unique_ptr<llvm::Module>&& graph_module,
         llvm::Function *process_func,
-        initialize_functions initialize_funcs)
+        llvm::Function *process_vector_func,
+        initialize_functions initialize_funcs,
+        std::vector<std::unique_ptr<llvm::MemoryBuffer>>&& objects,
+        compile_report& report)
     {
+        auto phase_begin = std::chrono::steady_clock::now();
+
         //  Check generated IR code
         std::string error_string;
-        if (check_module(*graph_module, error_string)) {
+        const auto malformed_code = check_module(*graph_module, error_string);
+        report.verification_time = lap(phase_begin);
+
+        if (malformed_code) {
             //  Do not compile to native code because malformed code could lead to crash
             //  Stay at last process_func.
             throw std::runtime_error("[graph_execution_context][Compile Thread] Malformed IR code was detected in graph module: " + error_string);
         }
 
         //  Compile module to native code
-        _execution_engine->add_module(std::move(graph_module));
+        const auto native_code_size = _execution_engine->get_native_code_size();
+        if (objects.empty())
+            _execution_engine->add_module(std::move(graph_module));
+        else
+            _execution_engine->add_compiled_module(std::move(graph_module), std::move(objects));
+        _state_manager->resolve_sequence_symbols(*_execution_engine);
         _execution_engine->emit_native_code();
 
         // Retrieve pointers to generated native code
         auto process_func_pointer =
             reinterpret_cast<native_process_func>(_execution_engine->get_function_pointer(process_func));
+        auto process_vector_func_pointer =
+            process_vector_func == nullptr ?
+                native_process_func{default_process_func} :
+                reinterpret_cast<native_process_func>(_execution_engine->get_function_pointer(process_vector_func));
         auto initialize_func_pointer =
             reinterpret_cast<native_initialize_func>(_execution_engine->get_function_pointer(initialize_funcs.initialize));
         auto initialize_new_node_func_pointer =
             reinterpret_cast<native_initialize_func>(_execution_engine->get_function_pointer(initialize_funcs.initialize_new_nodes));
 
+        report.native_code_generation_time = lap(phase_begin);
+        report.native_code_size = _execution_engine->get_native_code_size() - native_code_size;
+
+        const auto memory_usage = _execution_engine->get_native_memory_usage();
+        report.native_memory_used = memory_usage.used_size;
+        report.native_memory_reserved = memory_usage.reserved_size;
+
+        //  The region table must live as long as the program can be running
+        const auto regions =
+            _region_tables.insert_or_assign(_current_sequence, _state_manager->get_sequence_region_table()).first->second.data();
+
         //  Initialize every instances for new nodes as there could be running instances now
         for (auto i = 0u; i < _instance_count; i++)
-            initialize_new_node_func_pointer(i);
+            initialize_new_node_func_pointer(i, regions);
 
         //      Notify process thread that new code is ready to be processed
-        if (_compile_done_msg_queue.enqueue({_current_sequence, process_func_pointer, initialize_func_pointer})) {
-            LOG_DEBUG("[graph_execution_context][compile thread] Send compile_done message to process thread (seq = %u)\n", _current_sequence);
+        const compile_done_msg msg{_current_sequence, process_func_pointer, process_vector_func_pointer, initialize_func_pointer, regions};
+        _publish_program(msg);
+
+        return msg;
+    }
+
+    void graph_execution_context::_publish_program(const compile_done_msg& msg)
+    {
+        //  The registered threads always jump to the newest program
+        const auto& published_program = _published_programs.insert_or_assign(msg.seq, msg).first->second;
+        _newest_program.store(&published_program, std::memory_order_release);
+
+        if (_publication_mode == publication_mode::latest) {
+            LOG_DEBUG("[graph_execution_context][compile thread] Publish program to process thread (seq = %u)\n", msg.seq);
+            if (const auto superseded = _latest_program.write(msg)) {
+                //  A registered thread may have loaded the superseded program : it will be deleted once every thread moved past it
+                std::lock_guard lock{_process_threads_mutex};
+                if (_process_threads.empty())
+                    _discard_program(*superseded);
+            }
+        }
+        else if (_compile_done_msg_queue.enqueue(msg)) {
+            LOG_DEBUG("[graph_execution_context][compile thread] Send compile_done message to process thread (seq = %u)\n", msg.seq);
         }
         else {
             throw std::runtime_error("[graph_execution_context][compile thread] Cannot send compile done msg to process thread : queue is full !");
         }
     }
 
+    background_optimizer::job graph_execution_context::_create_optimization_job(
+        const llvm::Module& graph_module,
+        llvm::Function *process_func,
+        llvm::Function *process_vector_func,
+        initialize_functions initialize_funcs)
+    {
+        background_optimizer::job job{};
+
+        job.seq = _current_sequence;
+        job.process_symbol = process_func->getName().str();
+        job.process_vector_symbol = process_vector_func == nullptr ? "" : process_vector_func->getName().str();
+        job.initialize_symbol = initialize_funcs.initialize->getName().str();
+        job.pipeline = _optimization_pipeline;
+
+        llvm::raw_string_ostream stream{job.bitcode};
+        llvm::WriteBitcodeToFile(graph_module, stream);
+        stream.flush();
+
+        //  Composite functions are resolved once their native code was emitted
+        if (_composite_functions) {
+            for (const auto& function : graph_module) {
+                if (function.isDeclaration())
+                    job.symbols.emplace(function.getName().str(), nullptr);
+            }
+        }
+
+        return job;
+    }
+
+    void graph_execution_context::_resolve_optimization_job_symbols(background_optimizer::job& job)
+    {
+        //  The optimized program use the composite functions compiled for the unoptimized one
+        for (auto it = job.symbols.begin(); it != job.symbols.end();) {
+            it->second = _composite_functions->get_function_pointer(it->first);
+            it = (it->second == nullptr) ? job.symbols.erase(it) : std::next(it);
+        }
+
+        //  And the same states
+        job.symbols.merge(_state_manager->get_sequence_symbols());
+    }
+
+    void graph_execution_context::_submit_optimization_job(background_optimizer::job&& job)
+    {
+        LOG_DEBUG("[graph_execution_context][compile thread] Submit program to background optimizer (seq = %u)\n", job.seq);
+        _optimizer->submit(std::move(job));
+    }
+
     void graph_execution_context::_process_compile_done_msg(const compile_done_msg msg)
     {
         LOG_DEBUG("[graph_execution_context][process thread] received compile done from compile thread (seq = %u). Send acknowledgment to compile thread\n", msg.seq);
 
         //  Use the new process and initialize func
         _process_func = msg.process_func;
+        _process_vector_func = msg.process_vector_func;
         _initialize_func = msg.initialize_func;
+        _regions = msg.regions;
+        _running_sequence = msg.seq;
 
         //  Send ack message to notify that old function is not anymore in use
         _ack_msg_queue.enqueue(msg.seq);
+        if (_optimizer)
+            _optimizer->using_sequence(msg.seq);
+    }
+
+    void graph_execution_context::_discard_program(const compile_done_msg& msg)
+    {
+        LOG_DEBUG("[graph_execution_context][compile thread] Discard superseded program (seq = %u)\n", msg.seq);
+        _state_manager->discard_sequence(msg.seq);
+        _region_tables.erase(msg.seq);
+        _published_programs.erase(msg.seq);
+    }
+
+    void graph_execution_context::_cancel_sequence(compile_report& report)
+    {
+        LOG_INFO("[graph_execution_context][compile thread] graph compilation cancelled (seq = %u)\n", _current_sequence);
+        _state_manager->cancel_sequence();
+        report.cancelled = true;
     }
 
     void graph_execution_context::_process_ack_msg(const ack_msg msg)
     {
         LOG_DEBUG("[graph_execution_context][compile thread] received acknowledgment from process thread (seq = %u)\n", msg);
-        _state_manager->using_sequence(msg);
+        _acknowledged_sequence = msg;
+    }
+
+    void graph_execution_context::_free_unused_programs()
+    {
+        auto seq = _acknowledged_sequence;
+
+        {
+            std::lock_guard lock{_process_threads_mutex};
+            for (const auto thread : _process_threads)
+                seq = std::min(seq, thread->_running_sequence.load(std::memory_order_acquire));
+        }
+
+        //  Only the programs older than the oldest running one can be deleted : the newest program is always kept
+        for (auto it = _evicted_programs.begin(); it != _evicted_programs.end();) {
+            if (it->last_used_sequence < seq) {
+                _delete_cached_program(*it);
+                it = _evicted_programs.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+
+        _state_manager->using_sequence(seq);
+        _region_tables.erase(_region_tables.begin(), _region_tables.lower_bound(seq));
+        _published_programs.erase(_published_programs.begin(), _published_programs.lower_bound(seq));
+        if (_composite_functions)
+            _composite_functions->using_sequence(seq);
+    }
+
+    std::size_t graph_execution_context::_compute_program_key(const llvm::Module& graph_module) const
+    {
+        //  The native code also depends on the optimization and on the states addresses, when they are bound to symbols
+        auto key =
+            llvm::hash_combine(
+                compute_module_hash(graph_module),
+                _optimization_pipeline.name(),
+                _host_process_variant.value_or(_process_variants.size()));
+
+        for (const auto& symbol : _state_manager->get_sequence_symbols())
+            key = llvm::hash_combine(key, symbol.first, symbol.second);
+        for (const auto address : _state_manager->get_sequence_region_table())
+            key = llvm::hash_combine(key, address);
+
+        return static_cast<std::size_t>(key);
+    }
+
+    void graph_execution_context::_cache_program(
+        std::size_t key,
+        llvm::Module *graph_module,
+        const compile_done_msg& program,
+        const std::vector<std::string>& symbols,
+        const background_optimizer::job *optimization_job)
+    {
+        cached_program entry{};
+
+        entry.key = key;
+        entry.module = graph_module;
+        entry.process_func = program.process_func;
+        entry.process_vector_func = program.process_vector_func;
+        entry.initialize_func = program.initialize_func;
+        entry.region_table = _region_tables.at(program.seq);
+        entry.last_used_sequence = program.seq;
+        if (optimization_job != nullptr)
+            entry.optimization_job = *optimization_job;
+
+        //  The module, the states and the composite functions are kept while the program is cached
+        _state_manager->release_sequence_module();
+        entry.nodes = _state_manager->pin_sequence_states();
+
+        if (_composite_functions) {
+            for (const auto& symbol : symbols) {
+                if (_composite_functions->pin_function(symbol))
+                    entry.composite_functions.push_back(symbol);
+            }
+        }
+
+        LOG_DEBUG("[graph_execution_context][compile thread] Add program to program cache (seq = %u)\n", program.seq);
+        _cached_programs.push_front(std::move(entry));
+        _evict_cached_programs();
+    }
+
+    void graph_execution_context::_publish_cached_program(std::list<cached_program>::iterator program)
+    {
+        LOG_DEBUG("[graph_execution_context][compile thread] Publish cached program (seq = %u, first published at seq = %u)\n",
+            _current_sequence, program->last_used_sequence);
+
+        program->last_used_sequence = _current_sequence;
+        _cached_programs.splice(_cached_programs.begin(), _cached_programs, program);
+
+        //  The region table must live as long as the program can be running
+        const auto regions =
+            _region_tables.insert_or_assign(_current_sequence, program->region_table).first->second.data();
+
+        _publish_program({_current_sequence, program->process_func, program->process_vector_func, program->initialize_func, regions});
+
+        //  The cached program is the unoptimized one : it is optimized again, as the optimized code of its previous
+        //  publication is deleted once a newer program runs. It uses the same pinned states and composite functions
+        if (program->optimization_job.has_value()) {
+            auto job = *program->optimization_job;
+            job.seq = _current_sequence;
+            _submit_optimization_job(std::move(job));
+        }
+    }
+
+    void graph_execution_context::_evict_cached_programs()
+    {
+        //  The evicted programs can still be running
+        while (_cached_programs.size() > _program_cache_capacity) {
+            _evicted_programs.push_back(std::move(_cached_programs.back()));
+            _cached_programs.pop_back();
+        }
+    }
+
+    void graph_execution_context::_delete_cached_program(cached_program& program)
+    {
+        LOG_DEBUG("[graph_execution_context][compile thread] Delete evicted program (last used at seq = %u)\n", program.last_used_sequence);
+
+        _execution_engine->delete_module(program.module);
+        _state_manager->unpin_states(program.nodes);
+        if (_composite_functions) {
+            for (const auto& symbol : program.composite_functions)
+                _composite_functions->unpin_function(symbol);
+        }
+    }
+
+    /*********************************************
+     *   Additional Process Threads
+     *********************************************/
+
+    std::unique_ptr<graph_execution_context::process_thread> graph_execution_context::register_process_thread()
+    {
+        std::unique_ptr<process_thread> thread{new process_thread{*this}};
+        std::lock_guard lock{_process_threads_mutex};
+
+        //  The thread cannot load a program older than the newest one, which is never deleted
+        const auto newest_program = _newest_program.load(std::memory_order_acquire);
+        thread->_running_sequence.store(newest_program == nullptr ? 0u : newest_program->seq, std::memory_order_release);
+        _process_threads.push_back(thread.get());
+
+        return thread;
+    }
+
+    graph_execution_context::process_thread::process_thread(graph_execution_context& context) noexcept
+    :   _context{context},
+        _running_sequence{0u}
+    {
+    }
+
+    graph_execution_context::process_thread::~process_thread() noexcept
+    {
+        std::lock_guard lock{_context._process_threads_mutex};
+        auto& threads = _context._process_threads;
+        threads.erase(std::find(threads.begin(), threads.end(), this));
+    }
+
+    bool graph_execution_context::process_thread::update_program() noexcept
+    {
+        //  The loaded program is not deleted while it is copied, as it is newer than the one this thread is running
+        const auto newest_program = _context._newest_program.load(std::memory_order_acquire);
+
+        if (newest_program == nullptr || newest_program->seq == _program.seq)
+            return false;
+
+        _program = *newest_program;
+        _running_sequence.store(_program.seq, std::memory_order_release);
+        return true;
+    }
+
+    void graph_execution_context::process_thread::process(std::size_t instance_num, const float *inputs, float *outputs) noexcept
+    {
+        _program.process_func(instance_num, inputs, outputs, 1u, _program.regions);
+    }
+
+    void graph_execution_context::process_thread::process_block(std::size_t instance_num, const float *inputs, float *outputs, std::size_t frame_count) noexcept
+    {
+        _program.process_func(instance_num, inputs, outputs, frame_count, _program.regions);
+    }
+
+    void graph_execution_context::process_thread::process_vector_block(std::size_t instance_num, const float *inputs, float *outputs, std::size_t frame_count) noexcept
+    {
+        _program.process_vector_func(instance_num, inputs, outputs, frame_count, _program.regions);
+    }
+
+    void graph_execution_context::process_thread::initialize_state(std::size_t instance_num) noexcept
+    {
+        _program.initialize_func(instance_num, _program.regions);
     }
 }
\ No newline at end of file
@@ -1,4 +1,3 @@
-
 #include <DSPJIT/graph_execution_context_factory.h>
 
 namespace DSPJIT
@@ -9,21 +8,73 @@ namespace DSPJIT
         const llvm::TargetOptions& target_options,
         const std::size_t instance_count)
     {
-        auto execution_engine =
-            std::make_unique<llvm_legacy_execution_engine>(
-                llvm_context,
-                opt_level,
-                target_options);
+        graph_execution_context_options options{};
+        options.opt_level = opt_level;
+        options.target_options = target_options;
+        options.instance_count = instance_count;
+
+        return build(llvm_context, options);
+    }
 
+    graph_execution_context graph_execution_context_factory::build(
+        llvm::LLVMContext& llvm_context,
+        const graph_execution_context_options& options)
+    {
         auto memory_manager =
             std::make_unique<graph_memory_manager>(
                 llvm_context,
-                instance_count,
-                0u);
+                options.instance_count,
+                0u,
+                options.relocatable_states);
+
+        if (options.tiered_compilation) {
+            //  The first tier is compiled as fast as possible
+            auto fast_options = options;
+            fast_options.opt_level = llvm::CodeGenOpt::Level::None;
+
+            return graph_execution_context{
+                build_execution_engine(llvm_context, fast_options),
+                std::move(memory_manager),
+                options.pipeline,
+                [options](llvm::LLVMContext& optimizer_context)
+                {
+                    return build_execution_engine(optimizer_context, options);
+                }
+            };
+        }
+        else {
+            return graph_execution_context{
+                build_execution_engine(llvm_context, options),
+                std::move(memory_manager),
+                options.pipeline
+            };
+        }
+    }
+
+    std::unique_ptr<abstract_execution_engine> graph_execution_context_factory::build_execution_engine(
+        llvm::LLVMContext& llvm_context,
+        const graph_execution_context_options& options)
+    {
+        auto memory_pool = std::make_shared<code_memory_pool>(options.huge_page_code_memory);
+
+        switch (options.engine_kind)
+        {
+            case execution_engine_kind::orc:
+                return std::make_unique<orc_execution_engine>(
+                    options.opt_level,
+                    options.target_options,
+                    options.compile_thread_count,
+                    std::move(memory_pool),
+                    options.target_cpu);
 
-        return graph_execution_context{
-            std::move(execution_engine),
-            std::move(memory_manager)
-        };
+            case execution_engine_kind::llvm_legacy:
+            default:
+                return std::make_unique<llvm_legacy_execution_engine>(
+                    llvm_context,
+                    options.opt_level,
+                    options.target_options,
+                    std::move(memory_pool),
+                    options.target_cpu);
+        }
     }
-}
\ No newline at end of file
+}
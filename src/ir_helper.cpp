@@ -1,9 +1,16 @@
 
+#include <map>
+#include <tuple>
 #include <sstream>
 #include <iostream>
 
+#include <llvm/Analysis/ValueTracking.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/MDBuilder.h>
 #include <llvm/IR/Verifier.h>
 #include <llvm/Support/raw_os_ostream.h>
+#include <llvm/Support/xxhash.h>
 
 #include <DSPJIT/log.h>
 #include <DSPJIT/ir_helper.h>
@@ -47,4 +54,82 @@ namespace DSPJIT {
         }
     }
 
-}
\ No newline at end of file
+    llvm::AllocaInst *create_entry_block_alloca(llvm::IRBuilder<>& builder, llvm::Type *type)
+    {
+        auto& entry_block = builder.GetInsertBlock()->getParent()->getEntryBlock();
+        llvm::IRBuilder<> entry_builder{&entry_block, entry_block.getFirstInsertionPt()};
+        return entry_builder.CreateAlloca(type);
+    }
+
+    std::uint64_t compute_module_hash(const llvm::Module& module)
+    {
+        llvm::SmallVector<char, 0> buffer{};
+        llvm::raw_svector_ostream stream{buffer};
+        llvm::WriteBitcodeToFile(module, stream);
+        return llvm::xxHash64(llvm::StringRef{buffer.data(), buffer.size()});
+    }
+
+    /**
+     * \brief A memory object : a base value, or the pointer loaded at an offset from a base value
+     */
+    using memory_object = std::tuple<const llvm::Value*, bool /* loaded */, std::int64_t /* offset */>;
+
+    /**
+     * \brief Return the memory object accessed through a pointer, or an object with a null base if it is unknown
+     */
+    static memory_object get_memory_object(const llvm::Value *pointer, const llvm::DataLayout& data_layout)
+    {
+        const auto object = llvm::getUnderlyingObject(pointer, 0u);
+
+        if (llvm::isa<llvm::GlobalVariable>(object))
+            return {object, false, 0};
+
+        if (const auto argument = llvm::dyn_cast<llvm::Argument>(object); argument && argument->hasNoAliasAttr())
+            return {object, false, 0};
+
+        //  Invariant loads are identified by the location they load from
+        if (const auto load = llvm::dyn_cast<llvm::LoadInst>(object);
+            load && load->hasMetadata(llvm::LLVMContext::MD_invariant_load)) {
+            llvm::APInt offset{data_layout.getIndexTypeSizeInBits(load->getPointerOperandType()), 0u};
+            const auto base = load->getPointerOperand()->stripAndAccumulateConstantOffsets(data_layout, offset, true);
+            return {base, true, offset.getSExtValue()};
+        }
+
+        return {nullptr, false, 0};
+    }
+
+    void annotate_memory_accesses(llvm::Function& function)
+    {
+        auto& llvm_context = function.getContext();
+        const auto& data_layout = function.getParent()->getDataLayout();
+        llvm::MDBuilder md_builder{llvm_context};
+        const auto root = md_builder.createTBAARoot("DSPJIT memory");
+        std::map<memory_object, llvm::MDNode*> access_tags{};
+
+        for (auto& instruction : llvm::instructions(function)) {
+            const llvm::Value *pointer = nullptr;
+
+            if (const auto load = llvm::dyn_cast<llvm::LoadInst>(&instruction))
+                pointer = load->getPointerOperand();
+            else if (const auto store = llvm::dyn_cast<llvm::StoreInst>(&instruction))
+                pointer = store->getPointerOperand();
+            else
+                continue;
+
+            const auto object = get_memory_object(pointer, data_layout);
+            if (std::get<0>(object) == nullptr)
+                continue;
+
+            //  Objects are numbered in their order of first access, so that the code stays deterministic
+            auto tag_it = access_tags.find(object);
+            if (tag_it == access_tags.end()) {
+                const auto type =
+                    md_builder.createTBAAScalarTypeNode("object." + std::to_string(access_tags.size()), root);
+                tag_it = access_tags.emplace(object, md_builder.createTBAAStructTagNode(type, type, 0u)).first;
+            }
+
+            instruction.setMetadata(llvm::LLVMContext::MD_tbaa, tag_it->second);
+        }
+    }
+
+}
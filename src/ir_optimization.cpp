@@ -1,28 +1,128 @@
-
 #include <llvm/IR/Module.h>
-#include <llvm/Pass.h>
-#include <llvm/IR/LegacyPassManager.h>
-#include <llvm/Transforms/IPO/PassManagerBuilder.h>
+#include <llvm/Passes/PassBuilder.h>
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
 
-#include <llvm/Transforms/Scalar.h>
-#include <llvm/Transforms/Utils.h>
-#include <llvm/Transforms/IPO.h>
+#include <DSPJIT/log.h>
 
 #include "ir_optimization.h"
 
 namespace DSPJIT {
 
-    void run_optimization(llvm::Module& m)
-    {
-        llvm::legacy::PassManager pm{};
-        pm.add(llvm::createFunctionInliningPass());
-        pm.add(llvm::createEarlyCSEPass());
-        pm.add(llvm::createReassociatePass());
-        pm.add(llvm::createIPSCCPPass());
-        pm.add(llvm::createDeadCodeEliminationPass());
-        pm.add(llvm::createPromoteMemoryToRegisterPass());
-        pm.add(llvm::createAggressiveDCEPass());
-        pm.add(llvm::createGlobalDCEPass());
-        pm.run(m);
+    static llvm::OptimizationLevel to_llvm_optimization_level(optimization_pipeline::level level)
+    {
+        switch (level) {
+            case optimization_pipeline::level::O1:  return llvm::OptimizationLevel::O1;
+            case optimization_pipeline::level::O3:  return llvm::OptimizationLevel::O3;
+            case optimization_pipeline::level::Os:  return llvm::OptimizationLevel::Os;
+            case optimization_pipeline::level::O2:
+            default:                                return llvm::OptimizationLevel::O2;
+        }
+    }
+
+    std::string optimization_pipeline::name() const
+    {
+        if (!custom_pipeline.empty())
+            return custom_pipeline;
+
+        switch (preset) {
+            case level::O1:     return "O1";
+            case level::O3:     return "O3";
+            case level::Os:     return "Os";
+            case level::O2:
+            default:            return "O2";
+        }
+    }
+
+    static llvm::ModulePassManager build_pipeline(llvm::PassBuilder& pass_builder, const optimization_pipeline& pipeline)
+    {
+        if (pipeline.custom_pipeline.empty())
+            return pass_builder.buildPerModuleDefaultPipeline(to_llvm_optimization_level(pipeline.preset));
+
+        llvm::ModulePassManager pass_manager{};
+
+        if (auto error = pass_builder.parsePassPipeline(pass_manager, pipeline.custom_pipeline))
+            throw std::invalid_argument("Invalid optimization pipeline '" + pipeline.name() + "' : " + llvm::toString(std::move(error)));
+
+        return pass_manager;
+    }
+
+    /**
+     * \brief Return the pipeline tuning options : vectorization is enabled as clang does
+     */
+    static llvm::PipelineTuningOptions tuning_options(const optimization_pipeline& pipeline)
+    {
+        const auto vectorize =
+            pipeline.preset == optimization_pipeline::level::O2 ||
+            pipeline.preset == optimization_pipeline::level::O3;
+        llvm::PipelineTuningOptions options{};
+        options.LoopVectorization = vectorize;
+        options.SLPVectorization = vectorize;
+        return options;
+    }
+
+    ir_optimizer::ir_optimizer(const optimization_pipeline& pipeline, llvm::TargetMachine& target_machine)
+    :   _target_machine{target_machine}
+    {
+        set_pipeline(pipeline);
+    }
+
+    void ir_optimizer::set_pipeline(const optimization_pipeline& pipeline)
+    {
+        //  Vectorizers cost models need the target description
+        auto pass_builder = std::make_unique<llvm::PassBuilder>(&_target_machine, tuning_options(pipeline));
+        auto pass_manager = build_pipeline(*pass_builder, pipeline);
+
+        //  The analyses are registered by the pass builder, and must be registered again with the new one
+        _loop_analysis_manager = llvm::LoopAnalysisManager{};
+        _function_analysis_manager = llvm::FunctionAnalysisManager{};
+        _cgscc_analysis_manager = llvm::CGSCCAnalysisManager{};
+        _module_analysis_manager = llvm::ModuleAnalysisManager{};
+
+        pass_builder->registerModuleAnalyses(_module_analysis_manager);
+        pass_builder->registerCGSCCAnalyses(_cgscc_analysis_manager);
+        pass_builder->registerFunctionAnalyses(_function_analysis_manager);
+        pass_builder->registerLoopAnalyses(_loop_analysis_manager);
+        pass_builder->crossRegisterProxies(
+            _loop_analysis_manager, _function_analysis_manager,
+            _cgscc_analysis_manager, _module_analysis_manager);
+
+        _pass_manager = std::move(pass_manager);
+        _pass_builder = std::move(pass_builder);
+        _pipeline = pipeline;
+    }
+
+    void ir_optimizer::run(llvm::Module& m)
+    {
+        const auto begin = std::chrono::steady_clock::now();
+
+        m.setDataLayout(_target_machine.createDataLayout());
+        m.setTargetTriple(_target_machine.getTargetTriple().str());
+
+        _pass_manager.run(m, _module_analysis_manager);
+
+        //  Outer analysis managers first, as their proxies invalidate the inner ones
+        _module_analysis_manager.clear();
+        _cgscc_analysis_manager.clear();
+        _function_analysis_manager.clear();
+        _loop_analysis_manager.clear();
+
+        const auto end = std::chrono::steady_clock::now();
+        LOG_INFO("[ir_optimization] %s optimization pipeline run in %u us\n",
+            _pipeline.name().c_str(),
+            static_cast<unsigned int>(std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count()));
+    }
+
+    void run_optimization(llvm::Module& m, const optimization_pipeline& pipeline, llvm::TargetMachine& target_machine)
+    {
+        ir_optimizer{pipeline, target_machine}.run(m);
+    }
+
+    void check_optimization_pipeline(const optimization_pipeline& pipeline)
+    {
+        llvm::PassBuilder pass_builder{};
+        build_pipeline(pass_builder, pipeline);
     }
 }
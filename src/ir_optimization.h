@@ -2,11 +2,72 @@
 #define JITTEST_IR_OPTIMIZATION_H
 
 #include <llvm/IR/Module.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Target/TargetMachine.h>
+
+#include <DSPJIT/optimization_pipeline.h>
 
 namespace DSPJIT {
 
-    void run_optimization(llvm::Module& m);
+    /**
+     * \class ir_optimizer
+     * \brief Run an optimization pipeline on modules, reusing the pass managers from one module to the next
+     * \details Building the pipeline and registering the analyses cost more than optimizing a small module.
+     * The analysis results are dropped after each run, as they refer to the optimized module.
+     */
+    class ir_optimizer {
+
+    public:
+        /**
+         * \param pipeline the optimization pipeline
+         * \param target_machine the target for which native code will be generated. Must outlive the optimizer
+         * \throw std::invalid_argument if the pipeline is not valid
+         */
+        ir_optimizer(const optimization_pipeline& pipeline, llvm::TargetMachine& target_machine);
+
+        ir_optimizer(const ir_optimizer&) = delete;
+        ir_optimizer(ir_optimizer&&) = delete;
+
+        /**
+         * \brief Replace the optimization pipeline
+         * \throw std::invalid_argument if the pipeline is not valid. The previous pipeline is then kept
+         */
+        void set_pipeline(const optimization_pipeline& pipeline);
+
+        /**
+         * \brief Return the optimization pipeline
+         */
+        const optimization_pipeline& get_pipeline() const noexcept { return _pipeline; }
+
+        /**
+         * \brief Optimize a module, which is set up for the target machine
+         */
+        void run(llvm::Module& m);
+
+    private:
+        llvm::TargetMachine& _target_machine;
+        optimization_pipeline _pipeline{};
+        std::unique_ptr<llvm::PassBuilder> _pass_builder{};
+        llvm::LoopAnalysisManager _loop_analysis_manager{};
+        llvm::FunctionAnalysisManager _function_analysis_manager{};
+        llvm::CGSCCAnalysisManager _cgscc_analysis_manager{};
+        llvm::ModuleAnalysisManager _module_analysis_manager{};
+        llvm::ModulePassManager _pass_manager{};
+    };
+
+    /**
+     * \brief Optimize a module
+     * \param m the module, which is set up for the target machine
+     * \param pipeline the optimization pipeline
+     * \param target_machine the target for which native code will be generated
+     */
+    void run_optimization(llvm::Module& m, const optimization_pipeline& pipeline, llvm::TargetMachine& target_machine);
+
+    /**
+     * \brief Throw std::invalid_argument if the pipeline is not valid
+     */
+    void check_optimization_pipeline(const optimization_pipeline& pipeline);
 
 }
 
-#endif
\ No newline at end of file
+#endif
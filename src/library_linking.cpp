@@ -0,0 +1,137 @@
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/GlobalAlias.h>
+#include <llvm/IR/GlobalIFunc.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/Linker/Linker.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+
+#include <DSPJIT/log.h>
+
+#include "library_linking.h"
+
+namespace DSPJIT {
+
+    /**
+     * \brief Set of library definitions used by a module, with their own dependencies
+     */
+    class library_dependencies {
+
+    public:
+        void add(const llvm::GlobalValue *global)
+        {
+            if (!global->isDeclaration() && _globals.insert(global).second)
+                _worklist.push_back(global);
+        }
+
+        void add_dependencies()
+        {
+            while (!_worklist.empty()) {
+                const auto global = _worklist.back();
+                _worklist.pop_back();
+
+                if (const auto function = llvm::dyn_cast<llvm::Function>(global)) {
+                    if (function->hasPersonalityFn())
+                        _add_uses(function->getPersonalityFn());
+
+                    for (const auto& instruction : llvm::instructions(function)) {
+                        for (const auto& operand : instruction.operands())
+                            _add_uses(operand.get());
+                    }
+                }
+                else if (const auto variable = llvm::dyn_cast<llvm::GlobalVariable>(global)) {
+                    if (variable->hasInitializer())
+                        _add_uses(variable->getInitializer());
+                }
+                else if (const auto alias = llvm::dyn_cast<llvm::GlobalAlias>(global)) {
+                    _add_uses(alias->getAliasee());
+                }
+                else if (const auto ifunc = llvm::dyn_cast<llvm::GlobalIFunc>(global)) {
+                    _add_uses(ifunc->getResolver());
+                }
+            }
+        }
+
+        bool contains(const llvm::GlobalValue *global) const
+        {
+            return _globals.count(global) != 0u;
+        }
+
+        std::size_t size() const noexcept { return _globals.size(); }
+
+    private:
+        void _add_uses(const llvm::Value *value)
+        {
+            if (const auto global = llvm::dyn_cast<llvm::GlobalValue>(value)) {
+                add(global);
+            }
+            else if (const auto constant = llvm::dyn_cast<llvm::Constant>(value)) {
+                //  Constant expressions and aggregates can reference globals
+                if (_constants.insert(constant).second) {
+                    for (const auto& operand : constant->operands())
+                        _add_uses(operand.get());
+                }
+            }
+        }
+
+        std::set<const llvm::GlobalValue*> _globals{};
+        std::set<const llvm::Constant*> _constants{};
+        std::vector<const llvm::GlobalValue*> _worklist{};
+    };
+
+    std::unique_ptr<llvm::Module> declare_library(const llvm::Module& library, const std::string& name)
+    {
+        //  No definitions are copied : every library global is declared with an external linkage
+        llvm::ValueToValueMapTy value_map{};
+        auto module = llvm::CloneModule(library, value_map, [](const llvm::GlobalValue*) { return false; });
+        module->setModuleIdentifier(name);
+        module->setSourceFileName(name);
+
+        //  The library local symbols can not be referenced by the nodes code
+        for (const auto& global : library.global_values()) {
+            if (global.hasLocalLinkage())
+                llvm::cast<llvm::GlobalValue>(value_map.lookup(&global))->eraseFromParent();
+        }
+
+        return module;
+    }
+
+    void link_library_dependencies(llvm::Module& module, const llvm::Module& library)
+    {
+        library_dependencies dependencies{};
+
+        for (auto& global : llvm::make_early_inc_range(module.global_values())) {
+            if (!global.isDeclaration())
+                continue;
+
+            const auto definition = library.getNamedValue(global.getName());
+            if (definition == nullptr)
+                continue;
+
+            if (global.use_empty())
+                global.eraseFromParent();
+            else
+                dependencies.add(definition);
+        }
+
+        dependencies.add_dependencies();
+
+        if (dependencies.size() == 0u)
+            return;
+
+        //  The linker copies the definitions of the module declarations, and the local definitions they use
+        llvm::ValueToValueMapTy value_map{};
+        auto dependencies_module = llvm::CloneModule(library, value_map,
+            [&dependencies](const llvm::GlobalValue *global) { return dependencies.contains(global); });
+
+        if (llvm::Linker::linkModules(module, std::move(dependencies_module), llvm::Linker::LinkOnlyNeeded))
+            throw std::runtime_error("[library_linking] Failed to link library dependencies");
+
+        LOG_DEBUG("[library_linking] Linked %lu library definitions in %s\n",
+            dependencies.size(), module.getModuleIdentifier().c_str());
+    }
+
+}
@@ -0,0 +1,31 @@
+#ifndef DSPJIT_LIBRARY_LINKING_H_
+#define DSPJIT_LIBRARY_LINKING_H_
+
+#include <memory>
+#include <string>
+
+#include <llvm/IR/Module.h>
+
+namespace DSPJIT {
+
+    /**
+     * \brief Create a module declaring the library external functions and variables
+     * \details The nodes code looks up the library symbols in the module it is compiled in, but only the definitions
+     * which are actually used are copied in it, by link_library_dependencies.
+     * \param library the library module
+     * \param name the module identifier and source file name
+     */
+    std::unique_ptr<llvm::Module> declare_library(const llvm::Module& library, const std::string& name);
+
+    /**
+     * \brief Copy in a module the library definitions used by its code
+     * \details The definitions of the used library declarations are copied, together with the library definitions
+     * they depend on. The unused library declarations are removed from the module.
+     * \param module a module created by declare_library
+     * \param library the library module
+     */
+    void link_library_dependencies(llvm::Module& module, const llvm::Module& library);
+
+}
+
+#endif /* DSPJIT_LIBRARY_LINKING_H_ */
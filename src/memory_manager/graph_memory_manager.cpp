@@ -1,4 +1,10 @@
 
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+
+#include <llvm/IR/MDBuilder.h>
+
 #include <DSPJIT/log.h>
 
 #include <DSPJIT/graph_memory_manager.h>
@@ -40,14 +46,42 @@ namespace DSPJIT {
         _static_data_chunks.emplace_back(std::move(data));
     }
 
+    void graph_memory_manager::delete_sequence::take_deleted_data(delete_sequence& other)
+    {
+        std::move(other._node_states.begin(), other._node_states.end(), std::back_inserter(_node_states));
+        std::move(other._static_data_chunks.begin(), other._static_data_chunks.end(), std::back_inserter(_static_data_chunks));
+        other._node_states.clear();
+        other._static_data_chunks.clear();
+    }
+
+    bool graph_memory_manager::cycle_state_order::operator()(
+        const std::pair<node_state*, unsigned int>& a,
+        const std::pair<node_state*, unsigned int>& b) const noexcept
+    {
+        return std::make_pair(a.first->_sequence_rank, a.second) < std::make_pair(b.first->_sequence_rank, b.second);
+    }
+
     // Graph state manager implementation
 
+    /**
+     * \brief Return the alignment of a memory region, as known from its address
+     */
+    static llvm::Align region_alignment(const void *address)
+    {
+        constexpr auto max_alignment = 16u;
+        const auto value = reinterpret_cast<std::uintptr_t>(address);
+        const auto alignment = value & (~value + 1u);
+        return llvm::Align{alignment == 0u || alignment > max_alignment ? max_alignment : alignment};
+    }
+
     graph_memory_manager::graph_memory_manager(
         llvm::LLVMContext& llvm_context,
         std::size_t instance_count,
-        compile_sequence_t initial_sequence_number)
+        compile_sequence_t initial_sequence_number,
+        bool use_region_table)
     :   _llvm_context{llvm_context},
         _instance_count{instance_count},
+        _use_region_table{use_region_table},
         _current_sequence_number{initial_sequence_number}
     {
         _delete_sequence.emplace(initial_sequence_number, delete_sequence{});
@@ -58,13 +92,21 @@ namespace DSPJIT {
         _sequence_new_nodes.clear();
         _sequence_used_nodes.clear();
         _sequence_used_cycle_states.clear();
+        _sequence_memory_regions.clear();
+        _sequence_deleted_state_count = 0u;
+        _memory_region_scopes.clear();
         _current_sequence_number = seq;
+
+        //  The sequence region table is the outermost scope : composite functions tables are slices of it
+        if (_use_region_table)
+            _memory_region_scopes.push_back({nullptr});
     }
 
     abstract_graph_memory_manager::initialize_functions graph_memory_manager::finish_sequence(
         abstract_execution_engine& engine, llvm::Module& module)
     {
         node_list used_nodes{};
+        std::unique_lock<std::mutex> delete_sequence_lock{_delete_sequence_mutex};
 
         //  map must not be empty since (a unused sequence is supposed to be started)
         //  get an iterator on previous sequence
@@ -74,10 +116,11 @@ namespace DSPJIT {
             //  avoid iterator invalidation
             const auto cur_it = state_it++;
             //  Collect unused nodes : this node is not used anymore
-            if (_sequence_used_nodes.count(cur_it->first) == 0)
+            if (_sequence_used_nodes.count(cur_it->first) == 0 && _pinned_nodes.count(cur_it->first) == 0)
             {
                 //  Move the state in the previous delete_sequence in order to make it deleted when the current sequence will be used
                 previous_delete_sequence_it->second.add_deleted_node(std::move(cur_it->second));
+                _sequence_deleted_state_count++;
 
                 //  Remove the coresponding entry in state store
                 _state.erase(cur_it);
@@ -88,8 +131,16 @@ namespace DSPJIT {
             }
         }
 
+        //  Initialize the states in their order of first use, so that the code does not depend on nodes addresses
+        std::sort(used_nodes.begin(), used_nodes.end(),
+            [this](const compile_node_class *a, const compile_node_class *b)
+            {
+                return _state.at(a)._sequence_rank < _state.at(b)._sequence_rank;
+            });
+
         //  Create a delete sequence for the current compilation sequence
         _delete_sequence.emplace(_current_sequence_number, delete_sequence{&engine, &module});
+        delete_sequence_lock.unlock();
 
         LOG_DEBUG("[graph_state_manager][finish_sequence] Compile init func for %lu nodes (%lu news)\n",
             used_nodes.size(), _sequence_new_nodes.size());
@@ -107,9 +158,14 @@ namespace DSPJIT {
         llvm::Module& module)
     {
         //  Create the graph state initialize function
-        auto func_type = llvm::FunctionType::get(llvm::Type::getVoidTy(_llvm_context), { llvm::Type::getInt64Ty(_llvm_context) }, false);
+        auto func_type =
+            llvm::FunctionType::get(
+                llvm::Type::getVoidTy(_llvm_context),
+                { llvm::Type::getInt64Ty(_llvm_context), llvm::Type::getInt8PtrTy(_llvm_context)->getPointerTo() },
+                false);
         auto function = llvm::Function::Create(func_type, llvm::Function::ExternalLinkage, symbol, &module);
-        auto instance_num_value = function->arg_begin();
+        auto instance_num_value = function->getArg(0u);
+        set_sequence_region_table(function->getArg(1u));
         auto basic_block = llvm::BasicBlock::Create(_llvm_context, "", function);
 
         //  Create instruction builder
@@ -166,6 +222,187 @@ namespace DSPJIT {
         return function;
     }
 
+    void graph_memory_manager::resolve_sequence_symbols(abstract_execution_engine& engine)
+    {
+        for (const auto& region : _sequence_memory_regions)
+            engine.add_global_mapping(region.second.symbol, const_cast<void*>(region.first));
+    }
+
+    abstract_graph_memory_manager::symbol_map graph_memory_manager::get_sequence_symbols() const
+    {
+        symbol_map symbols{};
+
+        for (const auto& region : _sequence_memory_regions)
+            symbols.emplace(region.second.symbol->getName().str(), const_cast<void*>(region.first));
+
+        return symbols;
+    }
+
+    std::vector<void*> graph_memory_manager::get_sequence_region_table() const
+    {
+        std::vector<void*> table{};
+
+        if (_use_region_table && !_memory_region_scopes.empty()) {
+            for (const auto& region : _memory_region_scopes.front().regions)
+                table.push_back(const_cast<void*>(region.address));
+        }
+
+        return table;
+    }
+
+    abstract_graph_memory_manager::sequence_statistics graph_memory_manager::get_sequence_statistics() const
+    {
+        return {_sequence_new_nodes.size(), _sequence_deleted_state_count};
+    }
+
+    void graph_memory_manager::define_sequence_symbols(llvm::Module& module)
+    {
+        for (auto& region : _sequence_memory_regions) {
+            if (region.second.symbol == nullptr)
+                continue;
+
+            const auto size = std::max<std::size_t>(region.second.region.size, 1u);
+            const auto type = llvm::ArrayType::get(llvm::Type::getInt8Ty(_llvm_context), size);
+            auto symbol = region.second.symbol;
+
+            const auto initializer =
+                region.second.region.static_memory && region.second.region.size != 0u ?
+                    llvm::ConstantDataArray::get(
+                        _llvm_context,
+                        llvm::ArrayRef<uint8_t>{static_cast<const uint8_t*>(region.first), region.second.region.size}) :
+                    llvm::ConstantAggregateZero::get(type);
+
+            auto definition =
+                new llvm::GlobalVariable(
+                    module, type, false,
+                    llvm::GlobalValue::InternalLinkage,
+                    initializer, "");
+            definition->setAlignment(llvm::Align{16u});
+
+            definition->takeName(symbol);
+            symbol->replaceAllUsesWith(llvm::ConstantExpr::getBitCast(definition, symbol->getType()));
+            symbol->eraseFromParent();
+            region.second.symbol = nullptr;
+        }
+
+        //  The module is self contained and is not compiled by the execution engine
+        std::lock_guard<std::mutex> lock{_delete_sequence_mutex};
+        auto sequence_it = _delete_sequence.find(_current_sequence_number);
+        if (sequence_it != _delete_sequence.end())
+            sequence_it->second.release_module();
+    }
+
+    std::unique_ptr<abstract_graph_memory_manager> graph_memory_manager::clone_without_states() const
+    {
+        auto manager = std::make_unique<graph_memory_manager>(_llvm_context, _instance_count, 0u);
+        manager->_static_memory = _static_memory;
+        return manager;
+    }
+
+    void graph_memory_manager::push_memory_region_scope(llvm::Value *region_table)
+    {
+        _memory_region_scopes.push_back({region_table});
+    }
+
+    void graph_memory_manager::set_sequence_region_table(llvm::Value *region_table)
+    {
+        if (_use_region_table)
+            _memory_region_scopes.front().table = region_table;
+    }
+
+    llvm::Value *graph_memory_manager::pop_memory_region_scope(llvm::IRBuilder<>& builder)
+    {
+        const auto scope = std::move(_memory_region_scopes.back());
+        _memory_region_scopes.pop_back();
+
+        const auto region_ptr_type = builder.getInt8PtrTy();
+
+        if (scope.regions.empty())
+            return llvm::ConstantPointerNull::get(region_ptr_type->getPointerTo());
+
+        if (!_memory_region_scopes.empty()) {
+            //  Nested scope : the table is a contiguous slice of the outer scope table
+            auto& outer_scope = _memory_region_scopes.back();
+            const auto offset = outer_scope.regions.size();
+
+            for (const auto& region : scope.regions) {
+                outer_scope.indexes.emplace(region.address, outer_scope.regions.size());
+                outer_scope.regions.push_back(region);
+            }
+
+            return builder.CreateConstInBoundsGEP1_64(region_ptr_type, outer_scope.table, offset);
+        }
+        else {
+            //  The table is a constant global, initialized with the regions symbols
+            std::vector<llvm::Constant*> region_refs{};
+            for (const auto& region : scope.regions)
+                region_refs.push_back(llvm::cast<llvm::Constant>(_get_memory_region_ref(builder, region)));
+
+            const auto table_type = llvm::ArrayType::get(region_ptr_type, region_refs.size());
+            auto table =
+                new llvm::GlobalVariable(
+                    *builder.GetInsertBlock()->getModule(), table_type, true,
+                    llvm::GlobalValue::PrivateLinkage,
+                    llvm::ConstantArray::get(table_type, region_refs),
+                    "graph__memory_region_table");
+
+            return builder.CreateConstInBoundsGEP2_64(table_type, table, 0u, 0u);
+        }
+    }
+
+    llvm::Value *graph_memory_manager::_get_memory_region_ref(llvm::IRBuilder<>& builder, const memory_region& region)
+    {
+        if (!_memory_region_scopes.empty()) {
+            //  Load the region pointer from the current scope table
+            auto& scope = _memory_region_scopes.back();
+            auto index_it = scope.indexes.find(region.address);
+
+            if (index_it == scope.indexes.end()) {
+                index_it = scope.indexes.emplace(region.address, scope.regions.size()).first;
+                scope.regions.push_back(region);
+            }
+
+            //  The table does not change while the function runs : its loads can be hoisted
+            const auto region_ptr_type = builder.getInt8PtrTy();
+            auto region_ptr =
+                builder.CreateLoad(
+                    region_ptr_type,
+                    builder.CreateConstInBoundsGEP1_64(region_ptr_type, scope.table, index_it->second));
+            llvm::MDBuilder md_builder{_llvm_context};
+            const auto alignment = region_alignment(region.address).value();
+
+            region_ptr->setMetadata(llvm::LLVMContext::MD_invariant_load, llvm::MDNode::get(_llvm_context, {}));
+            region_ptr->setMetadata(
+                llvm::LLVMContext::MD_align,
+                llvm::MDNode::get(_llvm_context, {md_builder.createConstant(builder.getInt64(alignment))}));
+
+            if (region.size != 0u) {
+                region_ptr->setMetadata(llvm::LLVMContext::MD_nonnull, llvm::MDNode::get(_llvm_context, {}));
+                region_ptr->setMetadata(
+                    llvm::LLVMContext::MD_dereferenceable,
+                    llvm::MDNode::get(_llvm_context, {md_builder.createConstant(builder.getInt64(region.size))}));
+            }
+
+            return region_ptr;
+        }
+
+        auto region_it = _sequence_memory_regions.find(region.address);
+
+        if (region_it == _sequence_memory_regions.end()) {
+            //  Declare an external symbol which will be bound to the region address
+            auto& module = *builder.GetInsertBlock()->getModule();
+            const auto symbol = "graph__memory_region." + std::to_string(_sequence_memory_regions.size());
+            auto global =
+                new llvm::GlobalVariable(
+                    module, builder.getInt8Ty(), false,
+                    llvm::GlobalValue::ExternalLinkage, nullptr, symbol);
+            global->setAlignment(region_alignment(region.address));
+            region_it = _sequence_memory_regions.emplace(region.address, memory_region_symbol{region, global}).first;
+        }
+
+        return region_it->second.symbol;
+    }
+
     void graph_memory_manager::_declare_used_cycle_state(node_state* state, unsigned int output_id)
     {
         _sequence_used_cycle_states.emplace(state, output_id);
@@ -174,11 +411,75 @@ namespace DSPJIT {
     void graph_memory_manager::using_sequence(const compile_sequence_t seq)
     {
         //  Erase all delete sequences older than the used sequence
+        std::lock_guard<std::mutex> lock{_delete_sequence_mutex};
         _delete_sequence.erase(
             _delete_sequence.begin(),
             _delete_sequence.lower_bound(seq));
     }
 
+    void graph_memory_manager::discard_sequence(const compile_sequence_t seq)
+    {
+        std::lock_guard<std::mutex> lock{_delete_sequence_mutex};
+        _discard_sequence(seq);
+    }
+
+    void graph_memory_manager::_discard_sequence(const compile_sequence_t seq)
+    {
+        const auto it = _delete_sequence.find(seq);
+
+        //  The oldest delete sequence belongs to the running program
+        if (it == _delete_sequence.end() || it == _delete_sequence.begin())
+            return;
+
+        //  The states deleted after the discarded sequence are removed with the previous one, and its module now
+        std::prev(it)->second.take_deleted_data(it->second);
+        _delete_sequence.erase(it);
+    }
+
+    void graph_memory_manager::cancel_sequence()
+    {
+        //  The new states were never initialized : they are created again if their nodes are used by a next sequence
+        for (const auto node : _sequence_new_nodes)
+            _state.erase(node);
+        _sequence_new_nodes.clear();
+
+        //  The sequence module is not owned by the execution engine
+        std::lock_guard<std::mutex> lock{_delete_sequence_mutex};
+        const auto it = _delete_sequence.find(_current_sequence_number);
+        if (it != _delete_sequence.end()) {
+            it->second.release_module();
+            _discard_sequence(_current_sequence_number);
+        }
+    }
+
+    std::vector<const compile_node_class*> graph_memory_manager::pin_sequence_states()
+    {
+        std::vector<const compile_node_class*> nodes{_sequence_used_nodes.begin(), _sequence_used_nodes.end()};
+
+        for (const auto node : nodes)
+            _pinned_nodes[node]++;
+
+        return nodes;
+    }
+
+    void graph_memory_manager::unpin_states(const std::vector<const compile_node_class*>& nodes)
+    {
+        //  The unpinned states are deleted by the next finish_sequence if they are not used
+        for (const auto node : nodes) {
+            const auto it = _pinned_nodes.find(node);
+            if (it != _pinned_nodes.end() && --(it->second) == 0u)
+                _pinned_nodes.erase(it);
+        }
+    }
+
+    void graph_memory_manager::release_sequence_module()
+    {
+        std::lock_guard<std::mutex> lock{_delete_sequence_mutex};
+        const auto it = _delete_sequence.find(_current_sequence_number);
+        if (it != _delete_sequence.end())
+            it->second.release_module();
+    }
+
     node_state& graph_memory_manager::get_or_create(const compile_node_class& node)
     {
         auto state_it = _state.find(&node);
@@ -198,7 +499,8 @@ namespace DSPJIT {
         }
 
         // Remember that this state is used in the current sequence
-        _sequence_used_nodes.insert(&node);
+        if (_sequence_used_nodes.insert(&node).second)
+            state_it->second._sequence_rank = _sequence_used_nodes.size();
         return state_it->second;
     }
 
@@ -234,14 +536,15 @@ namespace DSPJIT {
             return nullptr;
         }
         else {
-            return builder.CreateIntToPtr(
-                llvm::ConstantInt::get(
-                    builder.getIntNTy(sizeof(float*) * 8),
-                    reinterpret_cast<intptr_t>(it->second.data())),
-                builder.getInt8PtrTy());
+            return _get_memory_region_ref(builder, {it->second.data(), it->second.size(), true});
         }
     }
 
+    llvm::Value *graph_memory_manager::get_memory_region_ref(llvm::IRBuilder<>& builder, const void *address, std::size_t size)
+    {
+        return _get_memory_region_ref(builder, {address, size, false});
+    }
+
     llvm::LLVMContext& graph_memory_manager::get_llvm_context() const noexcept
     {
         return _llvm_context;
@@ -254,6 +557,8 @@ namespace DSPJIT {
 
     void graph_memory_manager::_trash_static_memory_chunk(static_memory_map::iterator chunk_it)
     {
+        //  Can be called while the compile thread publishes a sequence (see compile_service)
+        std::lock_guard<std::mutex> lock{_delete_sequence_mutex};
         auto previous_delete_sequence_it = _delete_sequence.rbegin();
 
         // Move the chunk into the delete sequence
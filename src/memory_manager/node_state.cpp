@@ -31,10 +31,8 @@ namespace DSPJIT
         return
             builder.CreateGEP(
                 builder.getFloatTy(),
-                builder.CreateIntToPtr(
-                    llvm::ConstantInt::get(
-                        builder.getIntNTy(sizeof(float*) * 8),
-                        reinterpret_cast<intptr_t>(pointer)),
+                builder.CreateBitCast(
+                    _manager._get_memory_region_ref(builder, {pointer, _instance_count * sizeof(float), false}),
                     llvm::Type::getFloatPtrTy(_manager.get_llvm_context())),
                 instance_num_value);
     }
@@ -50,11 +48,7 @@ namespace DSPJIT
             return
                 builder.CreateGEP(
                     builder.getInt8Ty(),
-                    builder.CreateIntToPtr(
-                        llvm::ConstantInt::get(
-                            builder.getIntNTy(sizeof(uint8_t*) * 8),
-                            reinterpret_cast<intptr_t>(_data.data())),
-                        builder.getInt8PtrTy()),
+                    _manager._get_memory_region_ref(builder, {_data.data(), _data.size(), false}),
                     builder.CreateMul(
                         instance_num_value,
                         llvm::ConstantInt::get(builder.getInt64Ty(), _size)));
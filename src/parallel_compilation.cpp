@@ -0,0 +1,338 @@
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <map>
+#include <stdexcept>
+#include <utility>
+
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/MC/TargetRegistry.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+#include <llvm/Transforms/Utils/CodeExtractor.h>
+
+#include <DSPJIT/log.h>
+
+#include "execution_engine/native_code_generator.h"
+#include "ir_optimization.h"
+#include "parallel_compilation.h"
+
+namespace DSPJIT {
+
+    std::vector<llvm::Function*> outline_partitions(
+        llvm::Function& function,
+        std::size_t partition_count,
+        const std::string& suffix)
+    {
+        const auto chunk_size = function.getInstructionCount() / std::max<std::size_t>(partition_count, 1u);
+        std::vector<llvm::BasicBlock*> chunks{};
+
+        if (partition_count < 2u || chunk_size == 0u)
+            return {};
+
+        //  Cut the large blocks, the last chunk of each block stays in the function with the block terminator
+        std::vector<llvm::BasicBlock*> blocks{};
+        for (auto& block : function)
+            blocks.push_back(&block);
+
+        for (auto block : blocks) {
+            if (block->size() < 2u * chunk_size)
+                continue;
+
+            auto current = block->splitBasicBlock(block->getFirstNonPHI(), block->getName() + ".part");
+
+            while (current->size() > chunk_size + chunk_size / 2u) {
+                auto next = current->splitBasicBlock(std::next(current->begin(), chunk_size), block->getName() + ".part");
+                chunks.push_back(current);
+                current = next;
+            }
+        }
+
+        //  The values used accross chunks are given as arguments, and the values set in a chunk
+        //  which are used after it are returned through pointers
+        std::vector<llvm::Function*> functions{};
+        for (auto chunk : chunks) {
+            llvm::CodeExtractor extractor{{chunk}};
+            if (!extractor.isEligible())
+                continue;
+
+            const llvm::CodeExtractorAnalysisCache analysis_cache{function};
+            auto outlined_function = extractor.extractCodeRegion(analysis_cache);
+            if (outlined_function == nullptr)
+                continue;
+
+            outlined_function->setName(function.getName() + "." + suffix + "." + std::to_string(functions.size()));
+            outlined_function->setLinkage(llvm::GlobalValue::ExternalLinkage);
+            functions.push_back(outlined_function);
+        }
+
+        return functions;
+    }
+
+    /**
+     * \brief Remove the local definitions which are not used in a module
+     */
+    static void remove_unused_local_definitions(llvm::Module& module)
+    {
+        auto removed = true;
+
+        while (removed) {
+            removed = false;
+
+            for (auto it = module.begin(); it != module.end();) {
+                auto& function = *it++;
+                if (function.hasLocalLinkage() && function.use_empty()) {
+                    function.eraseFromParent();
+                    removed = true;
+                }
+            }
+
+            for (auto it = module.global_begin(); it != module.global_end();) {
+                auto& global = *it++;
+                if (global.hasLocalLinkage() && global.use_empty()) {
+                    global.eraseFromParent();
+                    removed = true;
+                }
+            }
+        }
+    }
+
+    std::vector<std::string> split_module(llvm::Module& module, std::size_t partition_count)
+    {
+        //  Variables must not be duplicated : they are defined by the first partition only
+        for (auto& global : module.globals()) {
+            if (global.hasLocalLinkage() && !global.isConstant()) {
+                if (!global.hasName())
+                    global.setName("graph__global");
+                global.setLinkage(llvm::GlobalValue::ExternalLinkage);
+            }
+        }
+
+        //  Largest functions first, each one in the smallest partition
+        std::vector<llvm::Function*> functions{};
+        for (auto& function : module) {
+            if (!function.isDeclaration() && !function.hasLocalLinkage())
+                functions.push_back(&function);
+        }
+
+        std::stable_sort(functions.begin(), functions.end(),
+            [](const llvm::Function *lhs, const llvm::Function *rhs)
+            {
+                return lhs->getInstructionCount() > rhs->getInstructionCount();
+            });
+
+        std::map<const llvm::Function*, std::size_t> function_partitions{};
+        std::vector<std::size_t> partition_sizes(std::max<std::size_t>(partition_count, 1u), 0u);
+
+        for (auto function : functions) {
+            const auto partition = static_cast<std::size_t>(
+                std::distance(
+                    partition_sizes.begin(),
+                    std::min_element(partition_sizes.begin(), partition_sizes.end())));
+            function_partitions[function] = partition;
+            partition_sizes[partition] += function->getInstructionCount();
+        }
+
+        std::vector<std::string> partitions{};
+        for (auto partition = 0u; partition < partition_sizes.size(); ++partition) {
+            if (partition != 0u && partition_sizes[partition] == 0u)
+                continue;
+
+            const auto clone_definition =
+                [&](const llvm::GlobalValue *global)
+                {
+                    const auto function = llvm::dyn_cast<llvm::Function>(global);
+                    const auto it = function_partitions.find(function);
+
+                    if (it != function_partitions.end())
+                        return it->second == partition;
+                    else if (partition == 0u || global->hasLocalLinkage())
+                        return true;
+                    else    //  Constants are copied, so that they can still be folded
+                        return llvm::isa<llvm::GlobalVariable>(global) && llvm::cast<llvm::GlobalVariable>(global)->isConstant();
+                };
+
+            llvm::ValueToValueMapTy value_map{};
+            auto partition_module = llvm::CloneModule(module, value_map, clone_definition);
+            partition_module->setModuleIdentifier(module.getModuleIdentifier() + ".partition." + std::to_string(partition));
+
+            if (partition != 0u) {
+                for (auto& global : partition_module->globals()) {
+                    if (global.isConstant() && !global.isDeclaration())
+                        global.setLinkage(llvm::GlobalValue::InternalLinkage);
+                }
+            }
+
+            remove_unused_local_definitions(*partition_module);
+
+            std::string bitcode{};
+            llvm::raw_string_ostream stream{bitcode};
+            llvm::WriteBitcodeToFile(*partition_module, stream);
+            stream.flush();
+            partitions.push_back(std::move(bitcode));
+        }
+
+        return partitions;
+    }
+
+    /**
+     * \brief Create a target machine generating the same code than another one, to be used on another thread
+     */
+    static std::unique_ptr<llvm::TargetMachine> clone_target_machine(const llvm::TargetMachine& target_machine)
+    {
+        std::unique_ptr<llvm::TargetMachine> clone{
+            target_machine.getTarget().createTargetMachine(
+                target_machine.getTargetTriple().str(),
+                target_machine.getTargetCPU(),
+                target_machine.getTargetFeatureString(),
+                target_machine.Options,
+                target_machine.getRelocationModel(),
+                target_machine.getCodeModel(),
+                target_machine.getOptLevel(),
+                true /* jit */)};
+
+        if (!clone)
+            throw std::runtime_error("[parallel_compilation] Failed to create target machine");
+
+        return clone;
+    }
+
+    partition_compiler::partition_compiler(
+        const llvm::TargetMachine& target_machine,
+        const optimization_pipeline& pipeline,
+        std::size_t thread_count)
+    {
+        //  Target machines and pipelines are not thread safe : each worker use its own
+        for (auto i = 0u; i < std::max<std::size_t>(thread_count, 1u); ++i) {
+            auto new_worker = std::make_unique<worker>();
+            new_worker->target_machine = clone_target_machine(target_machine);
+            new_worker->optimizer = std::make_unique<ir_optimizer>(pipeline, *new_worker->target_machine);
+            new_worker->code_generator = std::make_unique<native_code_generator>(*new_worker->target_machine);
+            _workers.push_back(std::move(new_worker));
+        }
+
+        for (auto i = 1u; i < _workers.size(); ++i) {
+            auto& current_worker = *_workers[i];
+            current_worker.thread = std::thread{[this, &current_worker]() { _worker_main(current_worker); }};
+        }
+    }
+
+    partition_compiler::~partition_compiler() noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+            _running = false;
+        }
+        _job_condition.notify_all();
+
+        for (auto& current_worker : _workers) {
+            if (current_worker->thread.joinable())
+                current_worker->thread.join();
+        }
+    }
+
+    void partition_compiler::set_pipeline(const optimization_pipeline& pipeline)
+    {
+        for (auto& current_worker : _workers)
+            current_worker->optimizer->set_pipeline(pipeline);
+    }
+
+    compiled_partitions partition_compiler::compile(const std::vector<std::string>& partitions)
+    {
+        _partitions = &partitions;
+        _objects = std::vector<std::unique_ptr<llvm::MemoryBuffer>>(partitions.size());
+        _instruction_counts.assign(partitions.size(), 0u);
+        _next_partition = 0u;
+
+        //  Wake up the workers
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+            _job_epoch++;
+            _pending_workers = _workers.size() - 1u;
+        }
+        _job_condition.notify_all();
+
+        //  The calling thread is the first worker
+        _run_job(*_workers.front());
+
+        {
+            std::unique_lock<std::mutex> lock{_mutex};
+            _done_condition.wait(lock, [this]() { return _pending_workers == 0u; });
+        }
+
+        _partitions = nullptr;
+
+        for (auto& current_worker : _workers) {
+            if (current_worker->error) {
+                const auto error = std::exchange(current_worker->error, nullptr);
+                std::rethrow_exception(error);
+            }
+        }
+
+        LOG_DEBUG("[parallel_compilation] Compiled %lu partitions on %lu threads\n", partitions.size(), _workers.size());
+
+        compiled_partitions result{};
+        result.objects = std::move(_objects);
+        for (const auto count : _instruction_counts)
+            result.instruction_count += count;
+
+        return result;
+    }
+
+    void partition_compiler::_worker_main(worker& worker)
+    {
+        std::size_t epoch = 0u;
+
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock{_mutex};
+                _job_condition.wait(lock, [this, epoch]() { return !_running || _job_epoch != epoch; });
+
+                if (!_running)
+                    return;
+
+                epoch = _job_epoch;
+            }
+
+            _run_job(worker);
+
+            {
+                std::lock_guard<std::mutex> lock{_mutex};
+                _pending_workers--;
+            }
+            _done_condition.notify_one();
+        }
+    }
+
+    void partition_compiler::_run_job(worker& worker) noexcept
+    {
+        try {
+            const auto& partitions = *_partitions;
+
+            for (auto partition = _next_partition++; partition < partitions.size(); partition = _next_partition++)
+                _instruction_counts[partition] = _compile_partition(worker, partitions[partition], _objects[partition]);
+        }
+        catch (...) {
+            worker.error = std::current_exception();
+        }
+    }
+
+    std::size_t partition_compiler::_compile_partition(
+        worker& worker,
+        const std::string& partition,
+        std::unique_ptr<llvm::MemoryBuffer>& object)
+    {
+        auto module = llvm::parseBitcodeFile(llvm::MemoryBufferRef{partition, "partition"}, worker.llvm_context);
+
+        if (!module)
+            throw std::runtime_error("[parallel_compilation] Failed to parse partition : " + llvm::toString(module.takeError()));
+
+        worker.optimizer->run(**module);
+        const auto instruction_count = (*module)->getInstructionCount();
+        object = worker.code_generator->generate(**module);
+
+        return instruction_count;
+    }
+
+}
@@ -0,0 +1,133 @@
+#ifndef DSPJIT_PARALLEL_COMPILATION_H_
+#define DSPJIT_PARALLEL_COMPILATION_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Target/TargetMachine.h>
+
+#include <DSPJIT/optimization_pipeline.h>
+
+namespace DSPJIT {
+
+    /**
+     * \brief Outline a function code into several functions of about the same size
+     * \details The largest blocks, which hold the nodes code in the graph order, are cut into chunks which are
+     * moved to new external functions. The values set in a chunk and used after it are passed through memory.
+     * \param function the function, which calls the outlined functions once done
+     * \param partition_count the number of parts the function is cut into
+     * \param suffix the outlined functions are named function.suffix.N. It must differ between the programs
+     * loaded in an execution engine, as MCJIT binds references to the already loaded symbols of the same name
+     * \return the outlined functions
+     */
+    std::vector<llvm::Function*> outline_partitions(
+        llvm::Function& function,
+        std::size_t partition_count,
+        const std::string& suffix);
+
+    /**
+     * \brief Split a module into partitions which are optimized and compiled independently
+     * \details The external functions are distributed over the partitions by size. The first partition also holds
+     * the variables. Local functions and constants are copied in every partition which uses them.
+     * \param module the module to be split. Its local variables are made external, to be shared by the partitions
+     * \param partition_count the maximum number of partitions
+     * \return the partitions bitcode, the first partition first
+     */
+    std::vector<std::string> split_module(llvm::Module& module, std::size_t partition_count);
+
+    /**
+     * \brief Native code of a split module
+     */
+    struct compiled_partitions {
+        std::vector<std::unique_ptr<llvm::MemoryBuffer>> objects{};    ///< one object file per partition
+        std::size_t instruction_count{0u};                              ///< IR instruction count after optimization
+    };
+
+    class ir_optimizer;
+    class native_code_generator;
+
+    /**
+     * \class partition_compiler
+     * \brief Optimize and compile partitions to object files, on a pool of worker threads
+     * \details The workers are created once. Each one parses the partitions in its own llvm context, and keeps its
+     * own target machine, optimization pipeline and code generation pipeline from one compilation to the next.
+     * The calling thread is one of the workers. Partitions must be compiled by one thread at a time.
+     */
+    class partition_compiler {
+
+    public:
+        /**
+         * \param target_machine the target machine whose configuration is used to generate the native code
+         * \param pipeline the optimization pipeline
+         * \param thread_count the number of threads compiling partitions, including the calling thread
+         * \throw std::runtime_error if the target machine cannot be created
+         */
+        partition_compiler(
+            const llvm::TargetMachine& target_machine,
+            const optimization_pipeline& pipeline,
+            std::size_t thread_count);
+
+        partition_compiler(const partition_compiler&) = delete;
+        partition_compiler(partition_compiler&&) = delete;
+        ~partition_compiler() noexcept;
+
+        /**
+         * \brief Replace the optimization pipeline
+         * \throw std::invalid_argument if the pipeline is not valid
+         */
+        void set_pipeline(const optimization_pipeline& pipeline);
+
+        /**
+         * \brief Return the number of threads compiling partitions, including the calling thread
+         */
+        std::size_t get_thread_count() const noexcept { return _workers.size(); }
+
+        /**
+         * \brief Optimize and compile partitions, and wait for completion
+         * \param partitions the partitions bitcode (see split_module)
+         * \throw std::runtime_error if a partition could not be compiled
+         */
+        compiled_partitions compile(const std::vector<std::string>& partitions);
+
+    private:
+        struct worker {
+            llvm::LLVMContext llvm_context{};
+            std::unique_ptr<llvm::TargetMachine> target_machine{};
+            std::unique_ptr<ir_optimizer> optimizer{};
+            std::unique_ptr<native_code_generator> code_generator{};
+            std::exception_ptr error{};
+            std::thread thread{};
+        };
+
+        void _worker_main(worker& worker);
+        void _run_job(worker& worker) noexcept;
+        std::size_t _compile_partition(worker& worker, const std::string& partition, std::unique_ptr<llvm::MemoryBuffer>& object);
+
+        std::vector<std::unique_ptr<worker>> _workers{};    ///< the first worker is the calling thread
+
+        //  Current job, written by the calling thread before each dispatch
+        const std::vector<std::string> *_partitions{nullptr};
+        std::vector<std::unique_ptr<llvm::MemoryBuffer>> _objects{};
+        std::vector<std::size_t> _instruction_counts{};
+        std::atomic<std::size_t> _next_partition{0u};
+
+        std::mutex _mutex{};
+        std::condition_variable _job_condition{};
+        std::condition_variable _done_condition{};
+        std::size_t _job_epoch{0u};
+        std::size_t _pending_workers{0u};
+        bool _running{true};
+    };
+
+}
+
+#endif /* DSPJIT_PARALLEL_COMPILATION_H_ */
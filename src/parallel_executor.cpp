@@ -0,0 +1,222 @@
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+#if defined(__linux__)
+#include <climits>
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+#include <DSPJIT/log.h>
+#include <DSPJIT/parallel_executor.h>
+
+namespace DSPJIT {
+
+    // Number of idle polling iterations before yielding the cpu
+    static constexpr auto spin_count_before_yield = 1024u;
+
+    // Number of idle polling iterations between two clock reads while waiting for a job
+    static constexpr auto spin_count_per_clock_check = 64u;
+
+    static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t), "The job epoch is waited on as a plain 32 bits word");
+
+    // Tell the cpu that the thread is busy waiting : saves power and the sibling hyper thread resources
+    static inline void _cpu_relax() noexcept
+    {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+        _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+        asm volatile("yield");
+#endif
+    }
+
+    template <typename TCondition>
+    static void _spin_wait(TCondition condition) noexcept
+    {
+        for (auto spin = 0u; !condition(); ++spin) {
+            if (spin >= spin_count_before_yield)
+                std::this_thread::yield();
+            else
+                _cpu_relax();
+        }
+    }
+
+    parallel_executor::parallel_executor(
+        graph_execution_context& context,
+        std::size_t worker_count,
+        bool pin_threads,
+        std::chrono::microseconds spin_duration)
+    :   _context{context},
+        _ranges{std::make_unique<instance_range[]>(worker_count + 1u)},
+        _pin_threads{pin_threads},
+        _spin_duration{spin_duration}
+    {
+        // Workers pin themselves, the calling thread is left to the host
+        _workers.reserve(worker_count);
+        for (auto i = 0u; i < worker_count; ++i)
+            _workers.emplace_back([this, i]() { _worker_main(i); });
+    }
+
+    parallel_executor::~parallel_executor() noexcept
+    {
+        _running.store(false);
+        _job_epoch.fetch_add(1u);
+        _wake_workers();
+
+        for (auto& worker : _workers)
+            worker.join();
+    }
+
+    void parallel_executor::process_block(
+        const float *inputs, std::size_t input_stride,
+        float *outputs, std::size_t output_stride,
+        std::size_t frame_count) noexcept
+    {
+        const auto participant_count = _workers.size() + 1u;
+        const auto instance_count = _context.get_instance_count();
+
+        // Split the instances in contiguous ranges
+        for (auto i = 0u; i < participant_count; ++i) {
+            _ranges[i].next.store(instance_count * i / participant_count, std::memory_order_relaxed);
+            _ranges[i].end = instance_count * (i + 1u) / participant_count;
+        }
+
+        _job = {inputs, input_stride, outputs, output_stride, frame_count};
+        _pending_workers.store(_workers.size(), std::memory_order_relaxed);
+
+        // Publish the job to the workers. Sequentially consistent so that a worker going to sleep either
+        // sees the new epoch or is seen by _wake_workers
+        _job_epoch.fetch_add(1u);
+        _wake_workers();
+
+        // The calling thread is the last participant
+        _run_job(participant_count - 1u);
+
+        // Join
+        _spin_wait([this]() { return _pending_workers.load(std::memory_order_acquire) == 0u; });
+    }
+
+    void parallel_executor::_worker_main(std::size_t participant)
+    {
+        if (_pin_threads)
+            _pin_current_thread(participant + 1u);
+
+        std::uint32_t epoch = 0u;
+
+        for (;;) {
+            // Wait for a new job
+            _wait_for_job(epoch);
+            epoch = _job_epoch.load(std::memory_order_acquire);
+
+            if (!_running.load())
+                return;
+
+            _run_job(participant);
+            _pending_workers.fetch_sub(1u, std::memory_order_release);
+        }
+    }
+
+    void parallel_executor::_wait_for_job(std::uint32_t epoch) noexcept
+    {
+        // Jobs are usually dispatched at a steady rate : spin first to avoid a wake up latency
+        const auto spin_deadline = std::chrono::steady_clock::now() + _spin_duration;
+
+        for (auto spin = 1u;; ++spin) {
+            if (_job_epoch.load(std::memory_order_acquire) != epoch)
+                return;
+            if (spin % spin_count_per_clock_check == 0u && std::chrono::steady_clock::now() >= spin_deadline)
+                break;
+            _cpu_relax();
+        }
+
+        // Then sleep until the next dispatch
+        _sleeping_workers.fetch_add(1u);
+        while (_job_epoch.load() == epoch)
+            _sleep_on_epoch(epoch);
+        _sleeping_workers.fetch_sub(1u);
+    }
+
+    void parallel_executor::_wake_workers() noexcept
+    {
+        // Avoid a system call when every worker is still spinning
+        if (_sleeping_workers.load() != 0u)
+            _notify_epoch();
+    }
+
+    void parallel_executor::_sleep_on_epoch(std::uint32_t epoch) noexcept
+    {
+        // Return immediately if the epoch was already changed. Spurious wake ups are handled by the caller
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&_job_epoch), FUTEX_WAIT_PRIVATE, epoch, nullptr, nullptr, 0);
+#elif defined(_WIN32)
+        WaitOnAddress(&_job_epoch, &epoch, sizeof(epoch), INFINITE);
+#else
+        std::unique_lock<std::mutex> lock{_sleep_mutex};
+        _sleep_condition.wait(lock, [this, epoch]() { return _job_epoch.load() != epoch; });
+#endif
+    }
+
+    void parallel_executor::_notify_epoch() noexcept
+    {
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&_job_epoch), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#elif defined(_WIN32)
+        WakeByAddressAll(&_job_epoch);
+#else
+        //  Taking the lock ensures that a worker is either waiting or will see the new epoch
+        { std::lock_guard<std::mutex> lock{_sleep_mutex}; }
+        _sleep_condition.notify_all();
+#endif
+    }
+
+    void parallel_executor::_run_job(std::size_t participant) noexcept
+    {
+        const auto participant_count = _workers.size() + 1u;
+
+        // Process its own range first, then steal instances from the others
+        for (auto i = 0u; i < participant_count; ++i)
+            _process_range(_ranges[(participant + i) % participant_count]);
+    }
+
+    void parallel_executor::_process_range(instance_range& range) noexcept
+    {
+        for (;;) {
+            const auto instance = range.next.fetch_add(1u, std::memory_order_relaxed);
+
+            if (instance >= range.end)
+                return;
+
+            _context.process_block(
+                instance,
+                _job.inputs + instance * _job.input_stride,
+                _job.outputs + instance * _job.output_stride,
+                _job.frame_count);
+        }
+    }
+
+    void parallel_executor::_pin_current_thread(std::size_t cpu)
+    {
+        const auto cpu_count = std::max(1u, std::thread::hardware_concurrency());
+        const auto core = static_cast<unsigned int>(cpu % cpu_count);
+
+#if defined(__linux__)
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(core, &cpu_set);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) != 0)
+            LOG_WARNING("[parallel_executor] Failed to pin worker thread on cpu %u\n", core);
+#elif defined(_WIN32)
+        if (SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR{1} << core) == 0)
+            LOG_WARNING("[parallel_executor] Failed to pin worker thread on cpu %u\n", core);
+#else
+        (void)core;
+#endif
+    }
+}
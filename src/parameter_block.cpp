@@ -0,0 +1,90 @@
+
+#include <stdexcept>
+
+#include <DSPJIT/parameter_block.h>
+
+namespace DSPJIT {
+
+    static std::chrono::steady_clock::rep now() noexcept
+    {
+        return std::chrono::steady_clock::now().time_since_epoch().count();
+    }
+
+    parameter_block::parameter_block(std::size_t capacity)
+    :   _capacity{capacity},
+        _lines((capacity + values_per_line - 1u) / values_per_line),
+        _states{std::make_unique<slot_state[]>(capacity)}
+    {
+        //  The lowest slots are allocated first
+        _free_slots.resize(capacity);
+        for (auto i = 0u; i < capacity; ++i)
+            _free_slots[i] = capacity - 1u - i;
+    }
+
+    parameter_block::slot_t parameter_block::allocate(float value)
+    {
+        if (_free_slots.empty())
+            throw std::runtime_error("parameter_block: no parameter slot is available");
+
+        const auto slot = _free_slots.back();
+        _free_slots.pop_back();
+
+        auto& state = _states[slot];
+        state.allocated = true;
+        state.promoted.store(false);
+        state.last_change.store(now(), std::memory_order_relaxed);
+        _value(slot).store(value);
+
+        return slot;
+    }
+
+    void parameter_block::release(slot_t slot) noexcept
+    {
+        auto& state = _states[slot];
+
+        if (state.allocated) {
+            state.allocated = false;
+            state.promoted.store(false);
+            _free_slots.push_back(slot);
+        }
+    }
+
+    void parameter_block::set(slot_t slot, float value) noexcept
+    {
+        if (_value(slot).exchange(value) == value)
+            return;
+
+        auto& state = _states[slot];
+        state.last_change.store(now(), std::memory_order_relaxed);
+
+        //  Either the compile thread promotes the new value, or it is notified that the promoted value changed
+        if (state.promoted.load())
+            _promoted_value_changed.store(true);
+    }
+
+    void parameter_block::begin_compilation() noexcept
+    {
+        for (auto slot = 0u; slot < _capacity; ++slot)
+            _states[slot].promoted.store(false);
+
+        _promoted_value_changed.store(false);
+    }
+
+    std::optional<float> parameter_block::promote(slot_t slot) noexcept
+    {
+        const auto promotion_delay = _promotion_delay.load();
+
+        if (promotion_delay == promotion_disabled)
+            return std::nullopt;
+
+        auto& state = _states[slot];
+        const auto last_change = state.last_change.load(std::memory_order_relaxed);
+
+        if (now() - last_change < promotion_delay)
+            return std::nullopt;
+
+        state.promoted.store(true);
+        return _value(slot).load();
+    }
+
+}
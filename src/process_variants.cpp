@@ -0,0 +1,74 @@
+#include <algorithm>
+#include <cctype>
+#include <memory>
+
+#include <llvm/ADT/StringMap.h>
+#include <llvm/MC/MCSubtargetInfo.h>
+#include <llvm/MC/TargetRegistry.h>
+#include <llvm/Support/Host.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+
+#include "process_variants.h"
+
+namespace DSPJIT {
+
+    std::string process_variant_symbol(const std::string& symbol, const std::string& cpu)
+    {
+        std::string suffix{cpu};
+        std::replace_if(suffix.begin(), suffix.end(), [](char c) { return !std::isalnum(static_cast<unsigned char>(c)); }, '_');
+        return symbol + "__" + suffix;
+    }
+
+    std::vector<llvm::Function*> create_process_variants(llvm::Function& function, const std::vector<std::string>& cpus)
+    {
+        std::vector<llvm::Function*> variants{};
+
+        for (const auto& cpu : cpus) {
+            llvm::ValueToValueMapTy value_map{};
+            auto variant = llvm::CloneFunction(&function, value_map);
+
+            variant->setName(process_variant_symbol(function.getName().str(), cpu));
+            variant->setLinkage(function.getLinkage());
+
+            //  An explicit (empty) feature list prevents the target machine features from being used
+            variant->addFnAttr("target-cpu", cpu);
+            variant->addFnAttr("target-features", "");
+            variants.push_back(variant);
+        }
+
+        return variants;
+    }
+
+    bool is_valid_cpu(const llvm::TargetMachine& target_machine, const std::string& cpu)
+    {
+        const auto& target = target_machine.getTarget();
+        const auto triple = target_machine.getTargetTriple().str();
+        const std::unique_ptr<llvm::MCSubtargetInfo> subtarget{
+            target.createMCSubtargetInfo(triple, target_machine.getTargetCPU(), "")};
+
+        return subtarget && subtarget->isCPUStringValid(cpu);
+    }
+
+    bool is_cpu_supported_by_host(const llvm::TargetMachine& target_machine, const std::string& cpu)
+    {
+        llvm::StringMap<bool> host_features{};
+
+        //  The host features can not be detected : only the host cpu itself is known to be supported
+        if (!llvm::sys::getHostCPUFeatures(host_features))
+            return cpu == llvm::sys::getHostCPUName();
+
+        //  The cpu must not have any feature missing on the host
+        std::string missing_features{};
+        for (const auto& feature : host_features) {
+            if (!feature.second)
+                missing_features += (missing_features.empty() ? "-" : ",-") + feature.first().str();
+        }
+
+        const auto& target = target_machine.getTarget();
+        const std::unique_ptr<llvm::MCSubtargetInfo> subtarget{
+            target.createMCSubtargetInfo(target_machine.getTargetTriple().str(), cpu, "")};
+
+        return subtarget && subtarget->checkFeatures(missing_features);
+    }
+
+}
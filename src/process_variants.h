@@ -0,0 +1,37 @@
+#ifndef DSPJIT_PROCESS_VARIANTS_H_
+#define DSPJIT_PROCESS_VARIANTS_H_
+
+#include <string>
+#include <vector>
+
+#include <llvm/IR/Function.h>
+#include <llvm/Target/TargetMachine.h>
+
+namespace DSPJIT {
+
+    /**
+     * \brief Return the symbol of the variant of a function compiled for a given cpu
+     * \details graph__process compiled for x86-64-v3 is graph__process__x86_64_v3
+     */
+    std::string process_variant_symbol(const std::string& symbol, const std::string& cpu);
+
+    /**
+     * \brief Clone a function into variants compiled for other cpus
+     * \return the variants, in the cpus order
+     * \note The variants only use the features of their cpu, whatever the target machine features
+     */
+    std::vector<llvm::Function*> create_process_variants(llvm::Function& function, const std::vector<std::string>& cpus);
+
+    /**
+     * \brief Return true if a cpu name is known for the target machine target
+     */
+    bool is_valid_cpu(const llvm::TargetMachine& target_machine, const std::string& cpu);
+
+    /**
+     * \brief Return true if the host cpu supports all the features of a cpu
+     */
+    bool is_cpu_supported_by_host(const llvm::TargetMachine& target_machine, const std::string& cpu);
+
+}
+
+#endif /* DSPJIT_PROCESS_VARIANTS_H_ */
@@ -0,0 +1,186 @@
+
+#include <cstring>
+
+#include <catch2/catch.hpp>
+
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+
+#include <DSPJIT/aot_program.h>
+#include <DSPJIT/graph_execution_context_factory.h>
+#include <DSPJIT/graph_compiler.h>
+#include <DSPJIT/common_nodes.h>
+
+using namespace llvm;
+using namespace DSPJIT;
+
+/**
+ *
+ *      Ahead Of Time Export
+ *
+ **/
+
+/**
+ *  A node whose output is a constant read from its static memory
+ */
+class static_memory_constant_node : public compile_node_class
+{
+public:
+    static_memory_constant_node()
+        : compile_node_class(0u, 1u, 0u, true)
+    {}
+
+    std::vector<llvm::Value *> emit_outputs(
+        graph_compiler &compiler,
+        const std::vector<llvm::Value *> &,
+        llvm::Value *,
+        llvm::Value *static_memory) const override
+    {
+        auto &builder = compiler.builder();
+        auto float_ptr = builder.CreateBitCast(
+            static_memory, llvm::Type::getFloatPtrTy(builder.getContext()));
+        return { builder.CreateLoad(builder.getFloatTy(), float_ptr) };
+    }
+};
+
+static std::string temporary_directory()
+{
+    SmallString<128> directory;
+    REQUIRE_FALSE(sys::fs::createUniqueDirectory("dspjit-aot-export", directory));
+    return std::string{directory.str()};
+}
+
+TEST_CASE("aot export : exported program matches the jit program")
+{
+    const auto engine_kind =
+        GENERATE(execution_engine_kind::llvm_legacy, execution_engine_kind::orc);
+
+    LLVMContext llvm_context;
+    graph_execution_context_options options{};
+    options.engine_kind = engine_kind;
+    options.instance_count = 2u;
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context, options);
+
+    //  out = integral(in) + static memory constant
+    compile_node_class in{0u, 1u}, out{1u, 0u};
+    add_node integrator, offset;
+    last_node delay;
+    static_memory_constant_node constant;
+
+    in.connect(integrator, 0u);
+    delay.connect(integrator, 1u);
+    integrator.connect(delay, 0u);
+    integrator.connect(offset, 0u);
+    constant.connect(offset, 1u);
+    offset.connect(out, 0u);
+
+    const float constant_value = 10.f;
+    std::vector<uint8_t> chunk(sizeof(float));
+    std::memcpy(chunk.data(), &constant_value, sizeof(float));
+    context.register_static_memory_chunk(constant, std::move(chunk));
+
+    context.compile({in}, {out});
+    context.update_program();
+
+    //  Advance the jit states : the exported program must not depend on them
+    const float one = 1.f;
+    float output = 0.f;
+    context.process(&one, &output);
+
+    const auto directory = temporary_directory();
+    const auto library_path = directory + "/graph.so";
+    const auto object_path = directory + "/graph.o";
+
+    context.export_program({in}, {out}, library_path);
+    context.export_program({in}, {out}, object_path, graph_execution_context::export_format::object_file);
+    REQUIRE(sys::fs::exists(object_path));
+
+    {
+        aot_program program{library_path};
+        REQUIRE(program.get_instance_count() == 2u);
+        REQUIRE(program.get_input_count() == 1u);
+        REQUIRE(program.get_output_count() == 1u);
+
+        context.initialize_state(0u);
+        context.initialize_state(1u);
+
+        const float inputs[] = {1.f, 2.f, 3.f, 4.f};
+        float jit_outputs[4], aot_outputs[4];
+
+        context.process_block(1u, inputs, jit_outputs, 4u);
+        program.process_block(1u, inputs, aot_outputs, 4u);
+
+        for (auto i = 0u; i < 4u; ++i)
+            REQUIRE(aot_outputs[i] == Approx(jit_outputs[i]));
+
+        //  Instances have their own states
+        program.process(0u, &one, &output);
+        REQUIRE(output == Approx(11.f));
+
+        program.initialize_state(1u);
+        program.process(1u, &one, &output);
+        REQUIRE(output == Approx(11.f));
+    }
+
+    sys::fs::remove_directories(directory);
+}
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+TEST_CASE("aot export : process variants match the default program")
+{
+    LLVMContext llvm_context;
+    graph_execution_context_options options{};
+    options.target_cpu = "x86-64";
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context, options);
+
+    REQUIRE_THROWS_AS(context.set_process_variants({"not-a-cpu"}), std::invalid_argument);
+    REQUIRE(context.get_process_variants().empty());
+
+    //  out = integral(in) * in
+    compile_node_class in{0u, 1u}, out{1u, 0u};
+    add_node integrator;
+    mul_node product;
+    last_node delay;
+
+    in.connect(integrator, 0u);
+    delay.connect(integrator, 1u);
+    integrator.connect(delay, 0u);
+    integrator.connect(product, 0u);
+    in.connect(product, 1u);
+    product.connect(out, 0u);
+
+    const float inputs[] = {1.f, 2.f, 3.f, 4.f};
+    float default_outputs[4], variant_outputs[4], aot_outputs[4];
+
+    context.compile({in}, {out});
+    context.update_program();
+    context.process_block(0u, inputs, default_outputs, 4u);
+
+    context.set_process_variants({"x86-64-v2", "x86-64-v3", "x86-64-v4"});
+    context.compile({in}, {out});
+    context.update_program();
+    context.initialize_state();
+    context.process_block(0u, inputs, variant_outputs, 4u);
+
+    const auto directory = temporary_directory();
+    const auto library_path = directory + "/graph.so";
+    context.export_program({in}, {out}, library_path);
+
+    {
+        aot_program program{library_path};
+        program.process_block(0u, inputs, aot_outputs, 4u);
+    }
+
+    for (auto i = 0u; i < 4u; ++i) {
+        REQUIRE(variant_outputs[i] == Approx(default_outputs[i]));
+        REQUIRE(aot_outputs[i] == Approx(default_outputs[i]));
+    }
+
+    sys::fs::remove_directories(directory);
+}
+
+#endif
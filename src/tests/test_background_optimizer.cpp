@@ -0,0 +1,145 @@
+
+#include <chrono>
+#include <thread>
+
+#include <catch2/catch.hpp>
+
+#include <llvm/IR/LLVMContext.h>
+
+#include <DSPJIT/graph_execution_context_factory.h>
+#include <DSPJIT/common_nodes.h>
+#include <DSPJIT/composite_node.h>
+
+using namespace llvm;
+using namespace DSPJIT;
+
+/**
+ *
+ *      Background Optimizer (tiered compilation)
+ *
+ **/
+
+static graph_execution_context_options tiered_options(execution_engine_kind engine_kind)
+{
+    graph_execution_context_options options{};
+    options.engine_kind = engine_kind;
+    options.tiered_compilation = true;
+    return options;
+}
+
+/**
+ *  Poll the context until the optimized program is swapped in
+ */
+static bool wait_optimized_program(graph_execution_context& context)
+{
+    for (auto i = 0u; i < 1000u; ++i) {
+        if (context.update_program())
+            return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});
+    }
+
+    return false;
+}
+
+TEST_CASE("background optimizer : optimized program use the running program states")
+{
+    const auto engine_kind =
+        GENERATE(execution_engine_kind::llvm_legacy, execution_engine_kind::orc);
+
+    LLVMContext llvm_context;
+    auto options = tiered_options(engine_kind);
+    options.relocatable_states = GENERATE(false, true);
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context, options);
+
+    REQUIRE(context.is_tiered_compilation_enabled());
+
+    compile_node_class in{0u, 1u}, out{1u, 0u};
+    add_node add;
+    const float input = 1.0f;
+    float output = 0.0f;
+
+    in.connect(add, 0u);
+    add.connect(add, 1u);
+    add.connect(out, 0u);
+
+    for (auto seq = 0u; seq < 3u; ++seq) {
+        context.compile({in}, {out});
+
+        //  Unoptimized program
+        REQUIRE(context.update_program());
+        context.process(&input, &output);
+        REQUIRE(output == Approx(static_cast<float>(2u * seq + 1u)));
+
+        //  Optimized program
+        REQUIRE(wait_optimized_program(context));
+        context.process(&input, &output);
+        REQUIRE(output == Approx(static_cast<float>(2u * seq + 2u)));
+    }
+}
+
+TEST_CASE("background optimizer : outdated optimized programs are not used")
+{
+    LLVMContext llvm_context;
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context, tiered_options(execution_engine_kind::llvm_legacy));
+
+    compile_node_class in{0u, 1u}, out{1u, 0u};
+    add_node add;
+    mul_node mul;
+    const float input = 2.0f;
+    float output = 0.0f;
+
+    in.connect(add, 0u);
+    in.connect(add, 1u);
+    add.connect(out, 0u);
+
+    context.compile({in}, {out});
+
+    //  The first program is replaced before being used
+    in.connect(mul, 0u);
+    in.connect(mul, 1u);
+    mul.connect(out, 0u);
+    context.compile({in}, {out});
+
+    REQUIRE(context.update_program());
+    REQUIRE(context.update_program());
+
+    //  Only the optimized version of the last program can be swapped in
+    REQUIRE(wait_optimized_program(context));
+    REQUIRE_FALSE(context.update_program());
+
+    context.process(&input, &output);
+    REQUIRE(output == Approx(4.f));
+}
+
+TEST_CASE("background optimizer : composite functions")
+{
+    LLVMContext llvm_context;
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context, tiered_options(execution_engine_kind::orc));
+
+    context.enable_incremental_compilation();
+
+    compile_node_class in{0u, 1u}, out{1u, 0u};
+    composite_node composite{1u, 1u};
+    add_node add;
+    const float input = 1.0f;
+    float output = 0.0f;
+
+    composite.input().connect(add, 0u);
+    add.connect(add, 1u);
+    add.connect(composite.output(), 0u);
+
+    in.connect(composite, 0u);
+    composite.connect(out, 0u);
+
+    context.compile({in}, {out});
+    REQUIRE(context.update_program());
+    context.process(&input, &output);
+    REQUIRE(output == Approx(1.f));
+
+    REQUIRE(wait_optimized_program(context));
+    context.process(&input, &output);
+    REQUIRE(output == Approx(2.f));
+}
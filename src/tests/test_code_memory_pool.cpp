@@ -0,0 +1,94 @@
+
+#include <cstring>
+
+#include <catch2/catch.hpp>
+
+#include <llvm/IR/LLVMContext.h>
+
+#include <DSPJIT/code_memory_pool.h>
+#include <DSPJIT/graph_execution_context_factory.h>
+#include <DSPJIT/common_nodes.h>
+
+using namespace llvm;
+using namespace DSPJIT;
+
+/**
+ *
+ *      Code Memory Pool
+ *
+ **/
+
+TEST_CASE("code memory pool : released blocks are reused")
+{
+    code_memory_pool pool{};
+    const auto kind = code_memory_pool::section_kind::code;
+
+    auto block1 = pool.allocate(kind, 100u);
+    auto block2 = pool.allocate(kind, 5000u);
+    const auto reserved_size = pool.get_usage().reserved_size;
+
+    REQUIRE(block1.allocatedSize() >= 100u);
+    REQUIRE(block2.allocatedSize() >= 5000u);
+    REQUIRE(pool.get_usage().used_size == block1.allocatedSize() + block2.allocatedSize());
+
+    //  Blocks are writable until they are protected
+    std::memset(block1.base(), 0xC3, block1.allocatedSize());
+    pool.protect(kind, block1);
+
+    //  Adjacent free blocks are merged
+    pool.release(kind, block1);
+    pool.release(kind, block2);
+    REQUIRE(pool.get_usage().used_size == 0u);
+
+    auto block3 = pool.allocate(kind, 8000u);
+    REQUIRE(block3.base() == block1.base());
+    REQUIRE(pool.get_usage().reserved_size == reserved_size);
+
+    //  Reused blocks are writable again
+    std::memset(block3.base(), 0, block3.allocatedSize());
+    pool.release(kind, block3);
+}
+
+TEST_CASE("code memory pool : recompilations reuse the native code memory")
+{
+    const auto engine_kind =
+        GENERATE(execution_engine_kind::llvm_legacy, execution_engine_kind::orc);
+    const auto huge_pages = GENERATE(false, true);
+
+    LLVMContext llvm_context;
+    graph_execution_context_options options{};
+    options.engine_kind = engine_kind;
+    options.huge_page_code_memory = huge_pages;
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context, options);
+
+    compile_node_class in{0u, 1u}, out{1u, 0u};
+    add_node add;
+    const float input = 1.0f;
+    float output = 0.0f;
+
+    in.connect(add, 0u);
+    add.connect(add, 1u);
+    add.connect(out, 0u);
+
+    std::size_t reserved_size = 0u;
+    std::size_t used_size = 0u;
+
+    for (auto i = 0u; i < 32u; ++i) {
+        const auto report = context.compile({in}, {out});
+        context.update_program();
+
+        context.process(&input, &output);
+        REQUIRE(output == Approx(static_cast<float>(i + 1u)));
+
+        //  Only the running program and the previous one are kept
+        if (i == 4u) {
+            reserved_size = report.native_memory_reserved;
+            used_size = report.native_memory_used;
+        }
+        else if (i > 4u) {
+            REQUIRE(report.native_memory_reserved == reserved_size);
+            REQUIRE(report.native_memory_used == used_size);
+        }
+    }
+}
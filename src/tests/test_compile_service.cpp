@@ -0,0 +1,205 @@
+#include <cstring>
+#include <future>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/LLVMContext.h>
+
+#include <DSPJIT/compile_service.h>
+#include <DSPJIT/graph_compiler.h>
+#include <DSPJIT/graph_execution_context_factory.h>
+#include <DSPJIT/common_nodes.h>
+
+using namespace llvm;
+using namespace DSPJIT;
+
+/**
+ *
+ *      Compile Service (asynchronous and cancellable compilation)
+ *
+ **/
+
+/**
+ *  A z^-1 whose initial output is not zero, to check that its state is initialized
+ */
+class initialized_last_node : public last_node {
+
+public:
+    void initialize_mutable_state(
+        llvm::IRBuilder<>& builder,
+        llvm::Value *mutable_state, llvm::Value*) const override
+    {
+        auto state_ptr = builder.CreateBitCast(mutable_state, builder.getFloatTy()->getPointerTo());
+        builder.CreateStore(llvm::ConstantFP::get(builder.getFloatTy(), 42.0), state_ptr);
+    }
+};
+
+TEST_CASE("compile hooks : a cancelled compilation does not publish its program")
+{
+    LLVMContext llvm_context;
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context);
+
+    compile_node_class out{1u, 0u};
+    constant_node constant{1.f};
+    initialized_last_node delay;
+
+    constant.connect(delay, 0u);
+    delay.connect(out, 0u);
+
+    //  Cancel once the graph was compiled : the delay state was created but not initialized
+    auto graph_compiled = false;
+    graph_execution_context::compile_hooks hooks{};
+    hooks.graph_compiled = [&graph_compiled]() { graph_compiled = true; };
+    hooks.cancelled = [&graph_compiled]() { return graph_compiled; };
+
+    const auto report = context.compile({}, {out}, hooks);
+    REQUIRE(report.cancelled);
+    REQUIRE_FALSE(context.update_program());
+
+    //  The next compilation initializes the delay state
+    REQUIRE_FALSE(context.compile({}, {out}).cancelled);
+    REQUIRE(context.update_program());
+
+    float output = 0.f;
+    context.process(nullptr, &output);
+    REQUIRE(output == Approx(42.f));
+    context.process(nullptr, &output);
+    REQUIRE(output == Approx(1.f));
+}
+
+TEST_CASE("compile service : requests are coalesced")
+{
+    LLVMContext llvm_context;
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context);
+
+    compile_node_class out{1u, 0u};
+    constant_node constant{0.f};
+
+    constant.connect(out, 0u);
+
+    compile_service service{context, std::chrono::milliseconds{100}};
+    std::vector<std::future<compile_report>> reports{};
+
+    //  A burst of edits
+    for (auto i = 1u; i <= 8u; ++i) {
+        const auto lock = service.lock_graph();
+        constant.set_value(static_cast<float>(i));
+        reports.push_back(service.request({}, {out}));
+    }
+
+    //  Every request is covered by the program of the last one
+    const auto seq = reports.back().get().seq;
+    reports.pop_back();
+    for (auto& report : reports)
+        REQUIRE(report.get().seq == seq);
+
+    REQUIRE(context.update_program());
+    REQUIRE_FALSE(context.update_program());
+
+    float output = 0.f;
+    context.process(nullptr, &output);
+    REQUIRE(output == Approx(8.f));
+}
+
+TEST_CASE("compile service : a newer request supersedes a waiting compilation")
+{
+    LLVMContext llvm_context;
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context);
+
+    compile_node_class out{1u, 0u};
+    constant_node constant{1.f};
+
+    constant.connect(out, 0u);
+
+    compile_service service{context, std::chrono::microseconds{0}};
+    auto lock = service.lock_graph();
+
+    //  The first compilation waits for the graph, which is edited meanwhile
+    auto first_report = service.request({}, {out});
+    constant.set_value(2.f);
+    auto second_report = service.request({}, {out});
+    lock.unlock();
+
+    const auto report = second_report.get();
+    REQUIRE_FALSE(report.cancelled);
+    REQUIRE(first_report.get().seq == report.seq);
+
+    REQUIRE(context.update_program());
+    REQUIRE_FALSE(context.update_program());
+
+    float output = 0.f;
+    context.process(nullptr, &output);
+    REQUIRE(output == Approx(2.f));
+}
+
+/**
+ *  Output the float stored in its static memory chunk
+ */
+class static_memory_node : public compile_node_class {
+
+public:
+    static_memory_node() : compile_node_class{0u, 1u, 0u, true} {}
+
+    std::vector<llvm::Value*> emit_outputs(
+        graph_compiler& compiler,
+        const std::vector<llvm::Value*>&,
+        llvm::Value*, llvm::Value *static_memory) const override
+    {
+        auto& builder = compiler.builder();
+        auto float_ptr = builder.CreateBitCast(static_memory, builder.getFloatTy()->getPointerTo());
+        return {builder.CreateLoad(builder.getFloatTy(), float_ptr)};
+    }
+};
+
+TEST_CASE("compile service : static memory chunks are changed under the graph lock")
+{
+    LLVMContext llvm_context;
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context);
+
+    compile_node_class out{1u, 0u};
+    static_memory_node node;
+
+    node.connect(out, 0u);
+
+    compile_service service{context, std::chrono::microseconds{0}};
+    std::future<compile_report> report{};
+
+    //  Chunks are replaced while the previous requests are being compiled and published
+    for (auto i = 1u; i <= 32u; ++i) {
+        {
+            const auto lock = service.lock_graph();
+            const auto value = static_cast<float>(i);
+            std::vector<uint8_t> chunk(sizeof(float));
+            std::memcpy(chunk.data(), &value, sizeof(float));
+            context.register_static_memory_chunk(node, std::move(chunk));
+            report = service.request({}, {out});
+        }
+        context.update_program();
+    }
+
+    report.get();
+    while (context.update_program());
+
+    float output = 0.f;
+    context.process(nullptr, &output);
+    REQUIRE(output == Approx(32.f));
+
+    {
+        const auto lock = service.lock_graph();
+        context.free_static_memory_chunk(node);
+        report = service.request({}, {out});
+    }
+
+    report.get();
+    while (context.update_program());
+
+    //  Without chunk, the node outputs zero
+    context.process(nullptr, &output);
+    REQUIRE(output == Approx(0.f));
+}
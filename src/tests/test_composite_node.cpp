@@ -50,3 +50,81 @@ TEST_CASE("Composite Compile Node", "composite_node")
     context.process(&input, &output);
     REQUIRE(output == Approx(0.f));
 }
+
+TEST_CASE("Composite Compile Node : incremental compilation", "composite_node")
+{
+    const auto engine_kind =
+        GENERATE(execution_engine_kind::llvm_legacy, execution_engine_kind::orc);
+    const auto relocatable_states = GENERATE(false, true);
+
+    LLVMContext llvm_context;
+    graph_execution_context_options options{};
+    options.engine_kind = engine_kind;
+    options.relocatable_states = relocatable_states;
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context, options);
+    context.enable_incremental_compilation();
+
+    compile_node_class in{0u, 1u}, out{2u, 0u};
+    const float input = 1.f;
+    float output[2];
+
+    //  Two identical integrators in series
+    add_node add1{}, add2{};
+    last_node delay1{}, delay2{};
+    composite_node integrator1{1, 1}, integrator2{1, 1};
+
+    integrator1.input().connect(add1, 0);
+    add1.connect(delay1, 0);
+    delay1.connect(add1, 1);
+    add1.connect(integrator1.output(), 0);
+
+    integrator2.input().connect(add2, 0);
+    add2.connect(delay2, 0);
+    delay2.connect(add2, 1);
+    add2.connect(integrator2.output(), 0);
+
+    in.connect(integrator1, 0);
+    integrator1.connect(integrator2, 0);
+    integrator1.connect(out, 0);
+    integrator2.connect(out, 1);
+
+    context.compile({in}, {out});
+    context.update_program();
+
+    //  Both composites share the same function, but use their own states
+    REQUIRE(context.get_composite_function_cache()->get_function_count() == 1u);
+
+    float expected1 = 0.f, expected2 = 0.f;
+    for (auto i = 0u; i < 4u; ++i) {
+        expected1 += input;
+        expected2 += expected1;
+        context.process(&input, output);
+        REQUIRE(output[0] == Approx(expected1));
+        REQUIRE(output[1] == Approx(expected2));
+    }
+
+    //  Edit integrator2 : it becomes a gain
+    integrator2.input().connect(add2, 1);
+
+    context.compile({in}, {out});
+    context.update_program();
+    REQUIRE(context.get_composite_function_cache()->get_function_count() == 2u);
+
+    context.process(&input, output);
+    REQUIRE(output[0] == Approx(5.f));
+    REQUIRE(output[1] == Approx(10.f));
+
+    //  Edit integrator1 the same way : the integrator function is deleted once the previous program is not used anymore
+    integrator1.input().connect(add1, 1);
+
+    context.compile({in}, {out});
+    context.update_program();
+    context.compile({in}, {out});
+    context.update_program();
+    REQUIRE(context.get_composite_function_cache()->get_function_count() == 1u);
+
+    context.process(&input, output);
+    REQUIRE(output[0] == Approx(2.f));
+    REQUIRE(output[1] == Approx(4.f));
+}
@@ -1,13 +1,21 @@
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 #include <catch2/catch.hpp>
 
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Module.h>
+#include <llvm/AsmParser/Parser.h>
+#include <llvm/Support/SourceMgr.h>
 #include <llvm/Support/raw_os_ostream.h>
 
 #include <DSPJIT/graph_execution_context_factory.h>
 #include <DSPJIT/graph_compiler.h>
+#include <DSPJIT/graph_memory_manager.h>
 #include <DSPJIT/common_nodes.h>
+#include <DSPJIT/external_plugin.h>
 
 using namespace llvm;
 using namespace DSPJIT;
@@ -148,6 +156,121 @@ TEST_CASE("cycle state : integrator")
     REQUIRE(output == Approx(0.f));
 }
 
+TEST_CASE("cycle state : several cycles in a strongly connected component")
+{
+    LLVMContext llvm_context;
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context);
+
+    compile_node_class in{0u, 1u}, out{1u, 0u};
+    add_node add1, add2, add3;
+    const float input = 1.0f;
+    float output = 0.0f;
+
+    //  add1 = in + add2, add2 = add1 + add2 : the two back edges are delayed
+    //  add3 = add1 + add1 only depends on the component : it is not delayed
+    in.connect(add1, 0u);
+    add2.connect(add1, 1u);
+    add1.connect(add2, 0u);
+    add2.connect(add2, 1u);
+    add1.connect(add3, 0u);
+    add1.connect(add3, 1u);
+    add3.connect(out, 0u);
+
+    context.compile({in}, {out});
+    context.update_program();
+
+    //  add2[n] = add1[n-1] + add2[n-1], add1[n] = 1 + add2[n] = 2^n
+    for (auto n = 0u; n < 8u; ++n) {
+        context.process(&input, &output);
+        REQUIRE(output == Approx(2.f * static_cast<float>(1u << n)));
+    }
+}
+
+/**
+ *  Compile an integrator process function : signature = void _(int64 instance_num, float *input, float *output, int8 **region_table)
+ */
+static llvm::Function *compile_integrator(
+    llvm::Module& module, graph_memory_manager& memory_manager,
+    const compile_node_class& in, const compile_node_class& out)
+{
+    auto& llvm_context = module.getContext();
+    const auto float_ptr_type = llvm::Type::getFloatPtrTy(llvm_context);
+    auto func_type =
+        llvm::FunctionType::get(
+            llvm::Type::getVoidTy(llvm_context),
+            {llvm::Type::getInt64Ty(llvm_context), float_ptr_type, float_ptr_type,
+             llvm::Type::getInt8PtrTy(llvm_context)->getPointerTo()},
+            false);
+    auto function = llvm::Function::Create(func_type, llvm::Function::ExternalLinkage, "integrator", &module);
+
+    memory_manager.begin_sequence(1u);
+    memory_manager.set_sequence_region_table(function->getArg(3u));
+
+    llvm::IRBuilder builder(llvm_context);
+    builder.SetInsertPoint(llvm::BasicBlock::Create(llvm_context, "entry", function));
+
+    graph_compiler compiler{builder, function->getArg(0u), memory_manager};
+    compiler.assign_values(&in, {builder.CreateLoad(builder.getFloatTy(), function->getArg(1u))});
+    builder.CreateStore(compiler.node_value(out.get_input(0u), 0u), function->getArg(2u));
+    builder.CreateRetVoid();
+
+    return function;
+}
+
+TEST_CASE("relocatable states : one program runs against the states of several memory managers")
+{
+    using integrator_func = void (*)(std::size_t, const float*, float*, void * const*);
+
+    LLVMContext llvm_context;
+    graph_execution_context_options options{};
+    options.relocatable_states = true;
+    auto engine = graph_execution_context_factory::build_execution_engine(llvm_context, options);
+    auto& target_machine = engine->get_target_machine();
+
+    compile_node_class in{0u, 1u}, out{1u, 0u};
+    add_node add;
+
+    in.connect(add, 0u);
+    add.connect(add, 1u);
+    add.connect(out, 0u);
+
+    //  Only the first module is emitted : the second manager only provides its own states
+    graph_memory_manager first_states{llvm_context, 1u, 0u, true}, second_states{llvm_context, 1u, 0u, true};
+    auto module = std::make_unique<llvm::Module>("first", llvm_context);
+    llvm::Module second_module{"second", llvm_context};
+
+    module->setDataLayout(target_machine.createDataLayout());
+    module->setTargetTriple(target_machine.getTargetTriple().str());
+
+    auto function = compile_integrator(*module, first_states, in, out);
+    compile_integrator(second_module, second_states, in, out);
+
+    engine->add_module(std::move(module));
+    engine->emit_native_code();
+    const auto process = reinterpret_cast<integrator_func>(engine->get_function_pointer(function));
+
+    const auto first_table = first_states.get_sequence_region_table();
+    const auto second_table = second_states.get_sequence_region_table();
+    REQUIRE(first_table.size() == second_table.size());
+    REQUIRE(first_table != second_table);
+
+    const float input = 1.0f;
+    float output = 0.0f;
+
+    //  Each table selects the integrator state used by the same native code
+    process(0u, &input, &output, first_table.data());
+    REQUIRE(output == Approx(1.f));
+    process(0u, &input, &output, first_table.data());
+    REQUIRE(output == Approx(2.f));
+    process(0u, &input, &output, second_table.data());
+    REQUIRE(output == Approx(1.f));
+    process(0u, &input, &output, first_table.data());
+    REQUIRE(output == Approx(3.f));
+    process(0u, &input, &output, second_table.data());
+    REQUIRE(output == Approx(2.f));
+}
+
 TEST_CASE("node state/non dependant process : z-1")
 {
     LLVMContext llvm_context;
@@ -235,6 +358,185 @@ TEST_CASE("node state/non dependant process : z-1 integrator with delayless cycl
     REQUIRE(output == Approx(input));
 }
 
+TEST_CASE("process block : add graph")
+{
+    LLVMContext llvm_context;
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context);
+
+    compile_node_class in1{0u, 1u}, in2{0u, 1u};
+    compile_node_class out{1u, 0u};
+    add_node add;
+
+    in1.connect(add, 0u);
+    in2.connect(add, 1u);
+    add.connect(out, 0u);
+
+    context.compile({in1, in2}, {out});
+    context.update_program();
+
+    const float input[8] = {1.f, 10.f, 2.f, 20.f, 3.f, 30.f, 4.f, 40.f};
+    float output[4] = {0.f, 0.f, 0.f, 0.f};
+
+    context.process_block(0u, input, output, 4u);
+
+    REQUIRE(output[0] == Approx(11.f));
+    REQUIRE(output[1] == Approx(22.f));
+    REQUIRE(output[2] == Approx(33.f));
+    REQUIRE(output[3] == Approx(44.f));
+
+    //  No frame : nothing is written
+    output[0] = 42.f;
+    context.process_block(0u, input, output, 0u);
+    REQUIRE(output[0] == Approx(42.f));
+}
+
+TEST_CASE("process block : in place processing")
+{
+    LLVMContext llvm_context;
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context, llvm::CodeGenOpt::Aggressive);
+
+    REQUIRE_FALSE(context.is_non_overlapping_io_enabled());
+
+    //  out1 = in2, out2 = in1 + in2 : each output overwrites an input which is still needed
+    compile_node_class in1{0u, 1u}, in2{0u, 1u};
+    compile_node_class out1{1u, 0u}, out2{1u, 0u};
+    add_node add;
+
+    in2.connect(out1, 0u);
+    in1.connect(add, 0u);
+    in2.connect(add, 1u);
+    add.connect(out2, 0u);
+
+    context.compile({in1, in2}, {out1, out2});
+    context.update_program();
+
+    float buffer[8] = {1.f, 10.f, 2.f, 20.f, 3.f, 30.f, 4.f, 40.f};
+    context.process_block(0u, buffer, buffer, 4u);
+
+    for (auto frame = 0u; frame < 4u; ++frame) {
+        const auto value = static_cast<float>(frame + 1u);
+        REQUIRE(buffer[frame * 2u] == Approx(10.f * value));
+        REQUIRE(buffer[frame * 2u + 1u] == Approx(11.f * value));
+    }
+
+    context.process(buffer, buffer);
+    REQUIRE(buffer[0] == Approx(11.f));
+    REQUIRE(buffer[1] == Approx(21.f));
+}
+
+TEST_CASE("process block : state is kept across frames and blocks")
+{
+    LLVMContext llvm_context;
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context);
+
+    compile_node_class in{0u, 1u}, out{1u, 0u};
+    add_node add;
+    last_node delay;
+
+    in.connect(add, 0u);
+    add.connect(delay, 0u);
+    delay.connect(add, 1u);
+    add.connect(out, 0u);
+
+    context.compile({in}, {out});
+    context.update_program();
+
+    const float input[4] = {1.f, 1.f, 1.f, 1.f};
+    float output[4];
+
+    context.process_block(0u, input, output, 4u);
+    REQUIRE(output[0] == Approx(1.f));
+    REQUIRE(output[3] == Approx(4.f));
+
+    context.process_block(0u, input, output, 2u);
+    REQUIRE(output[0] == Approx(5.f));
+    REQUIRE(output[1] == Approx(6.f));
+
+    context.process(input, output);
+    REQUIRE(output[0] == Approx(7.f));
+}
+
+/**
+ *  A node which does not support vector processing : output input + state, state = input
+ */
+class scalar_only_test_node : public compile_node_class
+{
+public:
+    scalar_only_test_node()
+        : compile_node_class(1u, 1u, sizeof(float))
+    {}
+
+    std::vector<llvm::Value *> emit_outputs(
+        graph_compiler &compiler,
+        const std::vector<llvm::Value *> &inputs,
+        llvm::Value *mutable_state,
+        llvm::Value *) const override
+    {
+        auto &builder = compiler.builder();
+        auto state_ptr = builder.CreateBitCast(
+            mutable_state, llvm::Type::getFloatPtrTy(builder.getContext()));
+        auto previous = builder.CreateLoad(builder.getFloatTy(), state_ptr);
+        builder.CreateStore(inputs[0], state_ptr);
+        return { builder.CreateFAdd(inputs[0], previous) };
+    }
+};
+
+TEST_CASE("vector processing")
+{
+    LLVMContext llvm_context;
+    graph_execution_context_options options{};
+    options.instance_count = 4u;
+    options.relocatable_states = GENERATE(false, true);
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context, options);
+
+    REQUIRE_THROWS(context.set_vector_width(3u));
+    context.set_vector_width(4u);
+
+    compile_node_class in{0u, 1u}, out{2u, 0u};
+    add_node add;
+    last_node delay;
+    scalar_only_test_node scalar_node;
+
+    //  integrator
+    in.connect(add, 0u);
+    add.connect(delay, 0u);
+    delay.connect(add, 1u);
+    add.connect(out, 0u);
+
+    //  scalarized node
+    in.connect(scalar_node, 0u);
+    scalar_node.connect(out, 1u);
+
+    context.compile({in}, {out});
+    context.update_program();
+
+    //  2 frames, 4 lanes
+    const float input[8] = {1.f, 2.f, 3.f, 4.f, 10.f, 20.f, 30.f, 40.f};
+    float output[16];
+
+    context.process_vector_block(0u, input, output, 2u);
+
+    for (auto lane = 0u; lane < 4u; ++lane) {
+        //  frame 0
+        REQUIRE(output[lane] == Approx(input[lane]));
+        REQUIRE(output[4u + lane] == Approx(input[lane]));
+        //  frame 1
+        REQUIRE(output[8u + lane] == Approx(input[lane] + input[4u + lane]));
+        REQUIRE(output[12u + lane] == Approx(input[lane] + input[4u + lane]));
+    }
+
+    //  Scalar and vector programs share the same states
+    const float scalar_input = 1.f;
+    float scalar_output[2];
+    context.process(2u, &scalar_input, scalar_output);
+    REQUIRE(scalar_output[0] == Approx(34.f));
+    REQUIRE(scalar_output[1] == Approx(31.f));
+}
+
 class static_memory_simple_test : public compile_node_class
 {
 public:
@@ -268,8 +570,10 @@ static std::vector<uint8_t> create_dummy_chunk(float value)
 TEST_CASE("Static memory : simple")
 {
     LLVMContext llvm_context;
+    graph_execution_context_options options{};
+    options.relocatable_states = GENERATE(false, true);
     graph_execution_context context =
-        graph_execution_context_factory::build(llvm_context);
+        graph_execution_context_factory::build(llvm_context, options);
     compile_node_class out{1u, 0u};
     static_memory_simple_test node;
 
@@ -334,3 +638,440 @@ TEST_CASE("Static memory : simple")
     context.process(nullptr, &output);
     REQUIRE(output == Approx(45.f));
 }
+
+TEST_CASE("compile report")
+{
+    const auto engine_kind =
+        GENERATE(execution_engine_kind::llvm_legacy, execution_engine_kind::orc);
+
+    LLVMContext llvm_context;
+    graph_execution_context_options options{};
+    options.engine_kind = engine_kind;
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context, options);
+
+    compile_node_class in{0u, 1u}, out{1u, 0u};
+    last_node delay;
+
+    in.connect(delay, 0u);
+    delay.connect(out, 0u);
+
+    const auto first_report = context.compile({in}, {out});
+    context.update_program();
+
+    REQUIRE(first_report.seq == 1u);
+    REQUIRE(first_report.new_state_count == 1u);
+    REQUIRE(first_report.deleted_state_count == 0u);
+    REQUIRE(first_report.instruction_count_before_optimization > 0u);
+    REQUIRE(first_report.instruction_count_after_optimization > 0u);
+    REQUIRE(first_report.native_code_size > 0u);
+    REQUIRE_FALSE(first_report.object_cache_hit);
+    REQUIRE(first_report.total_time >=
+        first_report.library_link_time + first_report.graph_compilation_time +
+        first_report.initialize_compilation_time + first_report.optimization_time +
+        first_report.verification_time + first_report.native_code_generation_time);
+
+    //  Remove the delay
+    in.connect(out, 0u);
+
+    const auto second_report = context.compile({in}, {out});
+
+    REQUIRE(second_report.seq == 2u);
+    REQUIRE(second_report.new_state_count == 0u);
+    REQUIRE(second_report.deleted_state_count == 1u);
+}
+
+TEST_CASE("graph optimization : constant folding and merging of equivalent nodes")
+{
+    LLVMContext llvm_context;
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context);
+
+    //  out = in * (2 + 3) + in * (2 + 3), the second product being a duplicate of the first one
+    compile_node_class in{0u, 1u}, out{1u, 0u};
+    constant_node two{2.f}, three{3.f}, other_two{2.f}, other_three{3.f};
+    add_node sum, other_sum, result;
+    mul_node product, other_product;
+
+    two.connect(sum, 0u);
+    three.connect(sum, 1u);
+    other_two.connect(other_sum, 0u);
+    other_three.connect(other_sum, 1u);
+    in.connect(product, 0u);
+    sum.connect(product, 1u);
+    in.connect(other_product, 0u);
+    other_sum.connect(other_product, 1u);
+    product.connect(result, 0u);
+    other_product.connect(result, 1u);
+    result.connect(out, 0u);
+
+    const auto report = context.compile({in}, {out});
+    context.update_program();
+
+    REQUIRE(report.folded_node_count == 3u);    // two, three, sum
+    REQUIRE(report.merged_node_count == 4u);    // other_two, other_three, other_sum, other_product
+    REQUIRE(report.compiled_node_count == 2u);  // product, result
+    REQUIRE(report.new_state_count == 0u);      // pure nodes do not need states
+
+    const float input = 3.f;
+    float output = 0.f;
+    context.process(&input, &output);
+    REQUIRE(output == Approx(30.f));
+}
+
+TEST_CASE("graph optimization : pure nodes in a cycle keep their state")
+{
+    LLVMContext llvm_context;
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context);
+
+    //  Two equivalent integrators : the merged one must not share the other one cycle state
+    compile_node_class in{0u, 1u}, out{2u, 0u};
+    add_node integrator, other_integrator;
+
+    in.connect(integrator, 0u);
+    integrator.connect(integrator, 1u);
+    in.connect(other_integrator, 0u);
+    other_integrator.connect(other_integrator, 1u);
+    integrator.connect(out, 0u);
+    other_integrator.connect(out, 1u);
+
+    const auto report = context.compile({in}, {out});
+    context.update_program();
+
+    REQUIRE(report.new_state_count == 2u);
+    REQUIRE(report.merged_node_count == 0u);
+
+    const float input = 1.f;
+    float output[2] = {0.f, 0.f};
+
+    for (auto i = 1u; i < 4u; ++i) {
+        context.process(&input, output);
+        REQUIRE(output[0] == Approx(static_cast<float>(i)));
+        REQUIRE(output[1] == Approx(static_cast<float>(i)));
+    }
+}
+
+TEST_CASE("graph optimization : a pure node with a mutable state is rejected")
+{
+    class stateful_pure_node : public compile_node_class {
+    public:
+        stateful_pure_node() : compile_node_class{1u, 1u, sizeof(float)} {}
+        bool is_pure() const noexcept override { return true; }
+    };
+
+    LLVMContext llvm_context;
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context);
+
+    compile_node_class in{0u, 1u}, out{1u, 0u};
+    stateful_pure_node node;
+
+    in.connect(node, 0u);
+    node.connect(out, 0u);
+
+    REQUIRE_THROWS_AS(context.compile({in}, {out}), std::logic_error);
+}
+
+//  Output a global variable chosen by the input sign
+static const char *select_global_plugin_code =
+    "@positive = global float 1.0\n"
+    "@negative = global float -1.0\n"
+    "define void @node_process(float %in, float* %out) {\n"
+    "  %c = fcmp olt float %in, 0.0\n"
+    "  %p = select i1 %c, float* @negative, float* @positive\n"
+    "  %x = load float, float* %p\n"
+    "  store float %x, float* %out\n"
+    "  ret void\n"
+    "}\n";
+
+static bool is_pure_plugin(LLVMContext& llvm_context, const char *ir_code)
+{
+    SMDiagnostic error;
+    auto module = parseAssemblyString(ir_code, error, llvm_context);
+    REQUIRE(module);
+
+    external_plugin plugin{std::move(module)};
+    return plugin.create_node()->is_pure();
+}
+
+TEST_CASE("graph optimization : external plugin purity analysis")
+{
+    LLVMContext llvm_context;
+
+    //  Writes its output only
+    REQUIRE(is_pure_plugin(llvm_context,
+        "define void @node_process(float %in, float* %out) {\n"
+        "  %x = fmul float %in, 2.0\n"
+        "  store float %x, float* %out\n"
+        "  ret void\n"
+        "}\n"));
+
+    //  Writes a global variable
+    REQUIRE_FALSE(is_pure_plugin(llvm_context,
+        "@counter = global float 0.0\n"
+        "define void @node_process(float %in, float* %out) {\n"
+        "  store float %in, float* @counter\n"
+        "  store float %in, float* %out\n"
+        "  ret void\n"
+        "}\n"));
+
+    //  Calls an unknown function
+    REQUIRE_FALSE(is_pure_plugin(llvm_context,
+        "declare float @unknown(float)\n"
+        "define void @node_process(float %in, float* %out) {\n"
+        "  %x = call float @unknown(float %in)\n"
+        "  store float %x, float* %out\n"
+        "  ret void\n"
+        "}\n"));
+
+    //  Reads a constant global
+    REQUIRE(is_pure_plugin(llvm_context,
+        "@scale = constant float 2.0\n"
+        "define void @node_process(float %in, float* %out) {\n"
+        "  %s = load float, float* @scale\n"
+        "  %x = fmul float %in, %s\n"
+        "  store float %x, float* %out\n"
+        "  ret void\n"
+        "}\n"));
+
+    //  Reads a global variable through a select
+    REQUIRE_FALSE(is_pure_plugin(llvm_context, select_global_plugin_code));
+
+    //  Reads a global variable through a loaded pointer
+    REQUIRE_FALSE(is_pure_plugin(llvm_context,
+        "@value = global float 0.0\n"
+        "@pointer = constant float* @value\n"
+        "define void @node_process(float %in, float* %out) {\n"
+        "  %p = load float*, float** @pointer\n"
+        "  %x = load float, float* %p\n"
+        "  store float %x, float* %out\n"
+        "  ret void\n"
+        "}\n"));
+
+    //  Reads host memory
+    REQUIRE_FALSE(is_pure_plugin(llvm_context,
+        "define void @node_process(float %in, float* %out) {\n"
+        "  %p = inttoptr i64 4096 to float*\n"
+        "  %x = load float, float* %p\n"
+        "  store float %x, float* %out\n"
+        "  ret void\n"
+        "}\n"));
+}
+
+TEST_CASE("graph optimization : plugins reading global variables are not merged")
+{
+    LLVMContext llvm_context;
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context);
+
+    SMDiagnostic error;
+    auto module = parseAssemblyString(select_global_plugin_code, error, llvm_context);
+    REQUIRE(module);
+
+    external_plugin plugin{std::move(module)};
+    context.add_library_module(plugin.create_module());
+
+    compile_node_class in{0u, 1u}, out{2u, 0u};
+    auto node = plugin.create_node();
+    auto other_node = plugin.create_node();
+
+    in.connect(*node, 0u);
+    in.connect(*other_node, 0u);
+    node->connect(out, 0u);
+    other_node->connect(out, 1u);
+
+    const auto report = context.compile({in}, {out});
+    REQUIRE(report.merged_node_count == 0u);
+    REQUIRE(report.compiled_node_count == 2u);
+}
+
+TEST_CASE("library : only the code used by the program is linked")
+{
+    const auto engine_kind =
+        GENERATE(execution_engine_kind::llvm_legacy, execution_engine_kind::orc);
+
+    LLVMContext llvm_context;
+    graph_execution_context_options options{};
+    options.engine_kind = engine_kind;
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context, options);
+
+    //  The node calls a local helper, which calls another library function
+    std::string ir_code =
+        "define float @library_scale(float %x) {\n"
+        "  %y = fmul float %x, 3.0\n"
+        "  ret float %y\n"
+        "}\n"
+        "define internal float @helper(float %x) {\n"
+        "  %y = call float @library_scale(float %x)\n"
+        "  %z = fadd float %y, 1.0\n"
+        "  ret float %z\n"
+        "}\n"
+        "define void @node_process(float %in, float* %out) {\n"
+        "  %x = call float @helper(float %in)\n"
+        "  store float %x, float* %out\n"
+        "  ret void\n"
+        "}\n"
+        "define float @unused(float %x0) {\n";
+
+    constexpr auto unused_instruction_count = 512u;
+    for (auto i = 1u; i < unused_instruction_count; ++i)
+        ir_code += "  %x" + std::to_string(i) + " = fadd float %x" + std::to_string(i - 1u) + ", 1.0\n";
+    ir_code += "  ret float %x" + std::to_string(unused_instruction_count - 1u) + "\n}\n";
+
+    SMDiagnostic error;
+    auto module = parseAssemblyString(ir_code, error, llvm_context);
+    REQUIRE(module);
+
+    external_plugin plugin{std::move(module)};
+    context.add_library_module(plugin.create_module());
+
+    compile_node_class in{0u, 1u}, out{1u, 0u};
+    auto node = plugin.create_node();
+
+    in.connect(*node, 0u);
+    node->connect(out, 0u);
+
+    const auto report = context.compile({in}, {out});
+    REQUIRE(report.instruction_count_before_optimization < unused_instruction_count);
+    REQUIRE(context.update_program());
+
+    const float input = 2.f;
+    float output = 0.f;
+    context.process(&input, &output);
+    REQUIRE(output == Approx(7.f));
+}
+
+TEST_CASE("latest program publication")
+{
+    const auto engine_kind =
+        GENERATE(execution_engine_kind::llvm_legacy, execution_engine_kind::orc);
+
+    LLVMContext llvm_context;
+    graph_execution_context_options options{};
+    options.engine_kind = engine_kind;
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context, options);
+
+    context.set_publication_mode(graph_execution_context::publication_mode::latest);
+
+    compile_node_class out{1u, 0u};
+    constant_node constant{0.f};
+    last_node delay;
+
+    constant.connect(delay, 0u);
+    delay.connect(out, 0u);
+
+    //  A burst of compilations : the superseded programs are deleted without being run
+    std::vector<compile_report> reports{};
+    for (auto i = 1u; i <= 16u; ++i) {
+        constant.set_value(static_cast<float>(i));
+        reports.push_back(context.compile({}, {out}));
+    }
+
+    REQUIRE(reports.back().native_memory_used <= reports[1].native_memory_used);
+
+    //  The process thread jumps to the newest program
+    REQUIRE(context.update_program());
+    REQUIRE_FALSE(context.update_program());
+
+    float output = 0.f;
+    context.process(nullptr, &output);
+    context.process(nullptr, &output);
+    REQUIRE(output == Approx(16.f));
+}
+
+TEST_CASE("registered process threads : programs are deleted once every thread moved past them")
+{
+    LLVMContext llvm_context;
+    graph_execution_context_options options{};
+    options.instance_count = 2u;
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context, options);
+
+    compile_node_class out{1u, 0u};
+    constant_node constant{1.f};
+
+    constant.connect(out, 0u);
+
+    auto thread = context.register_process_thread();
+    float output = 0.f;
+
+    //  No program yet
+    REQUIRE_FALSE(thread->update_program());
+
+    context.compile({}, {out});
+    REQUIRE(thread->update_program());
+    REQUIRE_FALSE(thread->update_program());
+    REQUIRE(context.update_program());
+
+    //  The context process thread moves on, the registered thread keeps running the first program
+    for (auto i = 2u; i <= 8u; ++i) {
+        constant.set_value(static_cast<float>(i));
+        context.compile({}, {out});
+        REQUIRE(context.update_program());
+    }
+
+    const auto memory_used = context.compile({}, {out}).native_memory_used;
+    thread->process(1u, nullptr, &output);
+    REQUIRE(output == Approx(1.f));
+
+    //  The registered thread jumps to the newest program : the programs in between can be deleted
+    REQUIRE(thread->update_program());
+    REQUIRE(context.update_program());
+    thread->process(1u, nullptr, &output);
+    REQUIRE(output == Approx(8.f));
+
+    REQUIRE(context.compile({}, {out}).native_memory_used < memory_used);
+}
+
+TEST_CASE("registered process threads : concurrent processing")
+{
+    constexpr auto thread_count = 2u;
+    constexpr auto compile_count = 32u;
+
+    LLVMContext llvm_context;
+    graph_execution_context_options options{};
+    options.instance_count = thread_count + 1u;
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context, options);
+
+    compile_node_class out{1u, 0u};
+    constant_node constant{1.f};
+    last_node delay;
+
+    constant.connect(delay, 0u);
+    delay.connect(out, 0u);
+    context.compile({}, {out});
+
+    std::atomic<bool> done{false};
+    std::atomic<std::size_t> error_count{0u};
+    std::vector<std::thread> threads{};
+
+    for (auto i = 1u; i <= thread_count; ++i) {
+        threads.emplace_back(
+            [&, thread = context.register_process_thread(), instance = i]()
+            {
+                float output = 0.f;
+                while (!done) {
+                    thread->update_program();
+                    thread->process(instance, nullptr, &output);
+                    if (output < 0.f || output > static_cast<float>(compile_count))
+                        error_count++;
+                }
+            });
+    }
+
+    for (auto i = 1u; i <= compile_count; ++i) {
+        constant.set_value(static_cast<float>(i));
+        context.compile({}, {out});
+        context.update_program();
+    }
+
+    done = true;
+    for (auto& thread : threads)
+        thread.join();
+
+    REQUIRE(error_count == 0u);
+}
@@ -0,0 +1,143 @@
+
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <llvm/AsmParser/Parser.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/Support/SourceMgr.h>
+
+#include <DSPJIT/graph_execution_context_factory.h>
+#include <DSPJIT/common_nodes.h>
+#include <DSPJIT/ir_helper.h>
+
+using namespace llvm;
+using namespace DSPJIT;
+
+/**
+ *
+ *      IR Optimization Pipeline
+ *
+ **/
+
+/**
+ *  Process a block with a feedback loop : y = x + 0.5 * y[n-1]
+ */
+static std::vector<float> run_one_pole(const optimization_pipeline& pipeline)
+{
+    LLVMContext llvm_context;
+    graph_execution_context_options options{};
+    options.pipeline = pipeline;
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context, options);
+
+    compile_node_class in{0u, 1u}, out{1u, 0u};
+    add_node add;
+    mul_node mul;
+    last_node delay;
+    constant_node coef{0.5f};
+
+    in.connect(add, 0u);
+    add.connect(delay, 0u);
+    delay.connect(mul, 0u);
+    coef.connect(mul, 1u);
+    mul.connect(add, 1u);
+    add.connect(out, 0u);
+
+    context.compile({in}, {out});
+    context.update_program();
+
+    std::vector<float> input(64u, 1.f);
+    std::vector<float> output(input.size());
+    context.process_block(0u, input.data(), output.data(), input.size());
+
+    return output;
+}
+
+TEST_CASE("ir optimization : presets and custom pipelines lead to the same results")
+{
+    optimization_pipeline reference_pipeline{};
+    reference_pipeline.preset = optimization_pipeline::level::O1;
+    const auto reference = run_one_pole(reference_pipeline);
+
+    REQUIRE(reference[0] == Approx(1.f));
+    REQUIRE(reference[1] == Approx(1.5f));
+    REQUIRE(reference.back() == Approx(2.f));
+
+    optimization_pipeline pipeline{};
+
+    SECTION("O2") { pipeline.preset = optimization_pipeline::level::O2; }
+    SECTION("O3") { pipeline.preset = optimization_pipeline::level::O3; }
+    SECTION("Os") { pipeline.preset = optimization_pipeline::level::Os; }
+    SECTION("custom") { pipeline.custom_pipeline = "function(sroa,instcombine,gvn,slp-vectorizer),globaldce"; }
+
+    REQUIRE(run_one_pole(pipeline) == reference);
+}
+
+TEST_CASE("ir optimization : invalid custom pipelines are rejected")
+{
+    LLVMContext llvm_context;
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context);
+
+    optimization_pipeline pipeline{};
+    pipeline.custom_pipeline = "function(not-a-pass)";
+
+    REQUIRE_THROWS_AS(context.set_optimization_pipeline(pipeline), std::invalid_argument);
+    REQUIRE(context.get_optimization_pipeline().name() == "O2");
+}
+
+TEST_CASE("ir optimization : memory accesses are tagged by memory object")
+{
+    LLVMContext llvm_context;
+    SMDiagnostic error;
+    auto module = parseAssemblyString(R"(
+        @state = external global i8
+
+        define void @process(float* noalias %inputs, float* noalias %outputs, i8** noalias %regions, float* %unknown) {
+            %input = load float, float* %inputs
+            %state = bitcast i8* @state to float*
+            store float %input, float* %state
+            %region0 = load i8*, i8** %regions, !invariant.load !0
+            %region0_float = bitcast i8* %region0 to float*
+            %region1_ptr = getelementptr i8*, i8** %regions, i64 1
+            %region1 = load i8*, i8** %region1_ptr, !invariant.load !0
+            %region1_float = bitcast i8* %region1 to float*
+            %value0 = load float, float* %region0_float
+            store float %value0, float* %region1_float
+            %region0_again = load i8*, i8** %regions, !invariant.load !0
+            %region0_again_float = bitcast i8* %region0_again to float*
+            store float %value0, float* %region0_again_float
+            store float %value0, float* %outputs
+            store float %value0, float* %unknown
+            ret void
+        }
+
+        !0 = !{}
+    )", error, llvm_context);
+    REQUIRE(module);
+
+    auto& function = *module->getFunction("process");
+    annotate_memory_accesses(function);
+
+    std::vector<const MDNode*> tags{};
+    for (const auto& instruction : instructions(function)) {
+        if (isa<LoadInst>(instruction) || isa<StoreInst>(instruction))
+            tags.push_back(instruction.getMetadata(LLVMContext::MD_tbaa));
+    }
+
+    //  input, state, region table (x2), region 0, region 1, region table, region 0, output, unknown
+    REQUIRE(tags.size() == 10u);
+    REQUIRE(tags[2] == tags[3]);    //  The table itself
+    REQUIRE(tags[2] == tags[6]);
+    REQUIRE(tags[4] == tags[7]);    //  The same table entry
+    REQUIRE(tags[9] == nullptr);
+
+    const std::vector<const MDNode*> objects{tags[0], tags[1], tags[2], tags[4], tags[5], tags[8]};
+    for (auto i = 0u; i < objects.size(); ++i) {
+        REQUIRE(objects[i] != nullptr);
+        for (auto j = i + 1u; j < objects.size(); ++j)
+            REQUIRE(objects[i] != objects[j]);
+    }
+}
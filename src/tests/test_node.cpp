@@ -1,4 +1,6 @@
 
+#include <type_traits>
+
 #include <catch2/catch.hpp>
 
 #include <llvm/IR/LLVMContext.h>
@@ -20,6 +22,10 @@ class test_node : public node<test_node> {
         {}
 };
 
+//  Nodes are linked to their users : they can not be copied
+static_assert(!std::is_copy_constructible_v<test_node>);
+static_assert(!std::is_copy_assignable_v<test_node>);
+
 TEST_CASE("Node initial state", "node_initial_state")
 {
     test_node n{2u};
@@ -45,3 +51,70 @@ TEST_CASE("Node Conection", "node_connection")
     REQUIRE(n3.get_input(0u) == &n1);
     REQUIRE(n3.get_input(1u) == nullptr);
 }
+
+TEST_CASE("Node users", "node_users")
+{
+    test_node source{0u}, other_source{0u}, n1{2u}, n2{1u};
+
+    source.connect(n1, 0u);
+    source.connect(n1, 1u);
+    source.connect(n2, 0u);
+    REQUIRE(source.get_user_count() == 3u);
+
+    //  Reconnecting an input unplugs it from its previous source
+    other_source.connect(n1, 1u);
+    REQUIRE(source.get_user_count() == 2u);
+    REQUIRE(other_source.get_user_count() == 1u);
+
+    n2.disconnect(0u);
+    REQUIRE(source.get_user_count() == 1u);
+    REQUIRE(n2.get_input(0u) == nullptr);
+
+    //  Inputs stay connected when the inputs storage grows
+    for (auto i = 0u; i < 16u; ++i) {
+        n2.add_input();
+        source.connect(n2, n2.get_input_count() - 1u);
+    }
+
+    REQUIRE(source.get_user_count() == 17u);
+    for (auto i = 1u; i < n2.get_input_count(); ++i)
+        REQUIRE(n2.get_input(i) == &source);
+
+    n2.disconnect_inputs();
+    REQUIRE(source.get_user_count() == 1u);
+}
+
+TEST_CASE("Node bulk edits", "node_bulk_edits")
+{
+    test_node source{0u}, replacement{0u}, n1{2u}, n2{1u};
+
+    source.connect(n1, 0u);
+    source.connect(n1, 1u);
+    source.connect(n2, 0u);
+
+    source.replace_users(replacement);
+    REQUIRE(source.get_user_count() == 0u);
+    REQUIRE(replacement.get_user_count() == 3u);
+    REQUIRE(n1.get_input(0u) == &replacement);
+    REQUIRE(n1.get_input(1u) == &replacement);
+    REQUIRE(n2.get_input(0u) == &replacement);
+
+    replacement.disconnect_users();
+    REQUIRE(replacement.get_user_count() == 0u);
+    REQUIRE(n1.get_input(0u) == nullptr);
+    REQUIRE(n2.get_input(0u) == nullptr);
+
+    //  Users of a removed output are disconnected
+    source.add_output();
+    source.connect(0u, n1, 0u);
+    source.connect(1u, n1, 1u);
+    source.remove_output();
+    REQUIRE(n1.get_input(0u) == &source);
+    REQUIRE(n1.get_input(1u) == nullptr);
+
+    //  Users of an output which does not exist on the replacement are not moved
+    source.add_output();
+    source.connect(1u, n1, 1u);
+    REQUIRE_THROWS(source.replace_users(replacement));
+    REQUIRE(source.get_user_count() == 2u);
+}
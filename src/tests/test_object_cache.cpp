@@ -0,0 +1,138 @@
+
+#include <catch2/catch.hpp>
+
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/Support/FileSystem.h>
+
+#include <DSPJIT/composite_node.h>
+#include <DSPJIT/graph_execution_context_factory.h>
+#include <DSPJIT/common_nodes.h>
+
+using namespace llvm;
+using namespace DSPJIT;
+
+/**
+ *
+ *      Object Cache
+ *
+ **/
+
+/**
+ *  Compile an integrator followed by a gain parameter in a new context and process a few frames
+ */
+static void run_integrator(
+    const std::string& cache_directory, execution_engine_kind engine_kind, bool relocatable_states, bool warm_cache)
+{
+    LLVMContext llvm_context;
+    graph_execution_context_options options{};
+    options.engine_kind = engine_kind;
+    options.relocatable_states = relocatable_states;
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context, options);
+
+    context.enable_object_cache(cache_directory);
+
+    compile_node_class in{0u, 1u}, out{1u, 0u};
+    add_node add;
+    last_node delay;
+    parameter_node gain{context.get_parameter_block(), 1.f};
+    mul_node product;
+    const float input = 1.0f;
+    float output = 0.0f;
+
+    in.connect(add, 0u);
+    add.connect(delay, 0u);
+    delay.connect(add, 1u);
+    add.connect(product, 0u);
+    gain.connect(product, 1u);
+    product.connect(out, 0u);
+
+    context.compile({in}, {out});
+    context.update_program();
+    REQUIRE(context.get_object_cache()->get_hit_count() == (warm_cache ? 1u : 0u));
+
+    //  The cached code must use this context states
+    for (auto i = 1u; i < 4u; ++i) {
+        context.process(&input, &output);
+        REQUIRE(output == Approx(static_cast<float>(i)));
+    }
+
+    //  Once all states exist (no new node to initialize), recompiling the same graph lead to the same code
+    context.compile({in}, {out});
+    context.update_program();
+    context.compile({in}, {out});
+    context.update_program();
+    REQUIRE(context.get_object_cache()->get_hit_count() == (warm_cache ? 3u : 1u));
+
+    context.process(&input, &output);
+    REQUIRE(output == Approx(4.f));
+
+    //  The cached code must read this context parameters
+    gain.set_value(2.f);
+    context.process(&input, &output);
+    REQUIRE(output == Approx(10.f));
+}
+
+TEST_CASE("object cache : code is reused across contexts")
+{
+    const auto engine_kind =
+        GENERATE(execution_engine_kind::llvm_legacy, execution_engine_kind::orc);
+    const auto relocatable_states = GENERATE(false, true);
+
+    SmallString<128> cache_directory;
+    REQUIRE_FALSE(sys::fs::createUniqueDirectory("dspjit-object-cache", cache_directory));
+    const std::string directory{cache_directory.str()};
+
+    run_integrator(directory, engine_kind, relocatable_states, false);
+    run_integrator(directory, engine_kind, relocatable_states, true);
+
+    sys::fs::remove_directories(directory);
+}
+
+/**
+ *  Compile a graph calling a composite function in a new context and process a frame
+ */
+static void run_composite(const std::string& cache_directory, bool warm_cache)
+{
+    LLVMContext llvm_context;
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context);
+
+    context.enable_incremental_compilation();
+    context.enable_object_cache(cache_directory);
+
+    compile_node_class in{0u, 1u}, out{1u, 0u};
+    add_node add;
+    composite_node composite{1u, 1u};
+    const float input = 3.0f;
+    float output = 0.0f;
+
+    composite.input().connect(add, 0u);
+    composite.input().connect(add, 1u);
+    add.connect(composite.output(), 0u);
+    in.connect(composite, 0u);
+    composite.connect(out, 0u);
+
+    context.compile({in}, {out});
+    context.update_program();
+
+    //  Both the graph and the composite function native code are cached
+    const auto object_cache = context.get_object_cache();
+    REQUIRE(object_cache->get_hit_count() == (warm_cache ? 2u : 0u));
+    REQUIRE(object_cache->get_miss_count() == (warm_cache ? 0u : 2u));
+
+    context.process(&input, &output);
+    REQUIRE(output == Approx(6.f));
+}
+
+TEST_CASE("object cache : composite functions code is reused across contexts")
+{
+    SmallString<128> cache_directory;
+    REQUIRE_FALSE(sys::fs::createUniqueDirectory("dspjit-object-cache", cache_directory));
+    const std::string directory{cache_directory.str()};
+
+    run_composite(directory, false);
+    run_composite(directory, true);
+
+    sys::fs::remove_directories(directory);
+}
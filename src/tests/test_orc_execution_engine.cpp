@@ -0,0 +1,99 @@
+
+#include <cmath>
+
+#include <catch2/catch.hpp>
+
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+
+#include <DSPJIT/graph_execution_context_factory.h>
+#include <DSPJIT/graph_compiler.h>
+#include <DSPJIT/common_nodes.h>
+
+using namespace llvm;
+using namespace DSPJIT;
+
+/**
+ *
+ *      Orc Execution Engine
+ *
+ **/
+
+static graph_execution_context_options orc_options()
+{
+    graph_execution_context_options options{};
+    options.engine_kind = execution_engine_kind::orc;
+    options.compile_thread_count = 2u;
+    return options;
+}
+
+TEST_CASE("orc execution engine : integrator with recompilations")
+{
+    LLVMContext llvm_context;
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context, orc_options());
+
+    compile_node_class in{0u, 1u}, out{1u, 0u};
+    add_node add;
+    const float input = 1.0f;
+    float output = 0.0f;
+
+    in.connect(add, 0u);
+    add.connect(add, 1u);
+    add.connect(out, 0u);
+
+    //  Each compilation releases the module of the previous-previous one
+    for (auto i = 0u; i < 8u; ++i) {
+        context.compile({in}, {out});
+        context.update_program();
+
+        context.process(&input, &output);
+        REQUIRE(output == Approx(static_cast<float>(i + 1u)));
+    }
+}
+
+/**
+ *  A node calling a function from the current process : output sinf(input)
+ */
+class sinf_test_node : public compile_node_class
+{
+public:
+    sinf_test_node()
+        : compile_node_class(1u, 1u)
+    {}
+
+    std::vector<llvm::Value *> emit_outputs(
+        graph_compiler &compiler,
+        const std::vector<llvm::Value *> &inputs,
+        llvm::Value *,
+        llvm::Value *) const override
+    {
+        auto &builder = compiler.builder();
+        auto module = builder.GetInsertBlock()->getModule();
+        auto sinf_func = module->getOrInsertFunction(
+            "sinf", builder.getFloatTy(), builder.getFloatTy());
+        return { builder.CreateCall(sinf_func, {inputs[0]}) };
+    }
+};
+
+TEST_CASE("orc execution engine : process symbol resolution")
+{
+    LLVMContext llvm_context;
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context, orc_options());
+
+    compile_node_class in{0u, 1u}, out{1u, 0u};
+    sinf_test_node node;
+
+    in.connect(node, 0u);
+    node.connect(out, 0u);
+
+    context.compile({in}, {out});
+    context.update_program();
+
+    const float input = 0.5f;
+    float output = 0.0f;
+
+    context.process(&input, &output);
+    REQUIRE(output == Approx(std::sin(input)));
+}
@@ -0,0 +1,137 @@
+
+#include <memory>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <llvm/IR/LLVMContext.h>
+
+#include <DSPJIT/graph_execution_context_factory.h>
+#include <DSPJIT/common_nodes.h>
+
+using namespace llvm;
+using namespace DSPJIT;
+
+/**
+ *
+ *      Parallel compilation (split programs)
+ *
+ **/
+
+/**
+ *  A chain of one pole low pass filters, whose output is taken after a given stage
+ */
+class filter_chain {
+
+public:
+    explicit filter_chain(std::size_t stage_count)
+    {
+        compile_node_class *previous = &input;
+
+        for (auto i = 0u; i < stage_count; ++i) {
+            auto& add = _create<add_node>();
+            auto& mul = _create<mul_node>();
+            auto& delay = _create<last_node>();
+            auto& coef = _create<constant_node>(0.5f / static_cast<float>(i + 1u));
+
+            previous->connect(add, 0u);
+            add.connect(delay, 0u);
+            delay.connect(mul, 0u);
+            coef.connect(mul, 1u);
+            mul.connect(add, 1u);
+
+            _stages.push_back(&add);
+            previous = &add;
+        }
+    }
+
+    void set_output_stage(std::size_t stage)
+    {
+        _stages[stage]->connect(output, 0u);
+    }
+
+    compile_node_class input{0u, 1u};
+    compile_node_class output{1u, 0u};
+
+private:
+    template <typename TNode, typename ...TArgs>
+    TNode& _create(TArgs&& ...args)
+    {
+        auto node = std::make_unique<TNode>(std::forward<TArgs>(args)...);
+        auto& ref = *node;
+        _nodes.emplace_back(std::move(node));
+        return ref;
+    }
+
+    std::vector<std::unique_ptr<compile_node_class>> _nodes{};
+    std::vector<compile_node_class*> _stages{};
+};
+
+TEST_CASE("parallel compilation : split programs compute the same outputs")
+{
+    constexpr auto stage_count = 64u;
+    constexpr auto block_size = 32u;
+
+    const auto engine_kind =
+        GENERATE(execution_engine_kind::llvm_legacy, execution_engine_kind::orc);
+
+    graph_execution_context_options options{};
+    options.engine_kind = engine_kind;
+    options.relocatable_states = GENERATE(false, true);
+
+    LLVMContext reference_llvm_context, llvm_context;
+    graph_execution_context reference_context =
+        graph_execution_context_factory::build(reference_llvm_context, options);
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context, options);
+
+    context.enable_parallel_compilation(4u, 0u);
+    REQUIRE(context.get_parallel_compilation_thread_count() == 4u);
+
+    filter_chain graph{stage_count};
+    std::vector<float> input(block_size), reference_output(block_size), output(block_size);
+
+    for (auto i = 0u; i < block_size; ++i)
+        input[i] = (i % 7u == 0u) ? 1.f : 0.f;
+
+    //  Each compilation replaces the previous split program, whose symbols have the same names
+    for (const auto output_stage : {stage_count - 1u, stage_count / 2u, stage_count - 1u}) {
+        graph.set_output_stage(output_stage);
+
+        reference_context.compile({graph.input}, {graph.output});
+        const auto report = context.compile({graph.input}, {graph.output});
+        REQUIRE(report.partition_count > 1u);
+        REQUIRE(report.partition_count <= 4u);
+
+        REQUIRE(reference_context.update_program());
+        REQUIRE(context.update_program());
+
+        reference_context.process_block(0u, input.data(), reference_output.data(), block_size);
+        context.process_block(0u, input.data(), output.data(), block_size);
+
+        for (auto i = 0u; i < block_size; ++i)
+            REQUIRE(output[i] == Approx(reference_output[i]));
+    }
+}
+
+TEST_CASE("parallel compilation : small programs are not split")
+{
+    LLVMContext llvm_context;
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context);
+
+    context.enable_parallel_compilation(4u);
+
+    filter_chain graph{2u};
+    const float input = 1.f;
+    float output = 0.f;
+
+    graph.set_output_stage(1u);
+
+    const auto report = context.compile({graph.input}, {graph.output});
+    REQUIRE(report.partition_count == 0u);
+
+    REQUIRE(context.update_program());
+    context.process(&input, &output);
+    REQUIRE(output == Approx(1.f));
+}
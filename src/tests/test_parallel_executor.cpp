@@ -0,0 +1,99 @@
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <ctime>
+#include <thread>
+
+#include <llvm/IR/LLVMContext.h>
+
+#include <DSPJIT/graph_execution_context_factory.h>
+#include <DSPJIT/parallel_executor.h>
+#include <DSPJIT/common_nodes.h>
+
+using namespace llvm;
+using namespace DSPJIT;
+
+/**
+ *
+ *      Parallel Executor
+ *
+ **/
+
+TEST_CASE("parallel executor : integrators")
+{
+    constexpr auto instance_count = 13u;
+    constexpr auto frame_count = 4u;
+
+    LLVMContext llvm_context;
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context, llvm::CodeGenOpt::Default, {}, instance_count);
+
+    compile_node_class in{0u, 1u}, out{1u, 0u};
+    add_node add;
+    last_node delay;
+
+    in.connect(add, 0u);
+    add.connect(delay, 0u);
+    delay.connect(add, 1u);
+    add.connect(out, 0u);
+
+    context.compile({in}, {out});
+    context.update_program();
+
+    parallel_executor executor{context, 3u, false};
+    REQUIRE(executor.get_worker_count() == 3u);
+
+    std::vector<float> inputs(instance_count * frame_count);
+    std::vector<float> outputs(instance_count * frame_count);
+
+    for (auto instance = 0u; instance < instance_count; ++instance)
+        std::fill_n(inputs.begin() + instance * frame_count, frame_count, static_cast<float>(instance));
+
+    for (auto block = 0u; block < 10u; ++block) {
+        executor.process_block(inputs.data(), frame_count, outputs.data(), frame_count, frame_count);
+
+        for (auto instance = 0u; instance < instance_count; ++instance) {
+            for (auto frame = 0u; frame < frame_count; ++frame) {
+                const auto expected = static_cast<float>(instance * (block * frame_count + frame + 1u));
+                REQUIRE(outputs[instance * frame_count + frame] == Approx(expected));
+            }
+        }
+    }
+}
+
+TEST_CASE("parallel executor : idle workers sleep")
+{
+    constexpr auto instance_count = 4u;
+    constexpr auto frame_count = 4u;
+
+    LLVMContext llvm_context;
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context, llvm::CodeGenOpt::Default, {}, instance_count);
+
+    compile_node_class in{0u, 1u}, out{1u, 0u};
+    in.connect(out, 0u);
+
+    context.compile({in}, {out});
+    context.update_program();
+
+    parallel_executor executor{context, 2u, false};
+
+    std::vector<float> inputs(instance_count * frame_count, 1.f);
+    std::vector<float> outputs(instance_count * frame_count, 0.f);
+
+    executor.process_block(inputs.data(), frame_count, outputs.data(), frame_count, frame_count);
+
+    // Spinning workers would consume about twice the elapsed time
+    const auto cpu_begin = std::clock();
+    std::this_thread::sleep_for(std::chrono::milliseconds{200});
+    const auto cpu_time = static_cast<double>(std::clock() - cpu_begin) / CLOCKS_PER_SEC;
+    REQUIRE(cpu_time < 0.1);
+
+    // The workers are woken up by the next dispatch
+    std::fill(inputs.begin(), inputs.end(), 2.f);
+    executor.process_block(inputs.data(), frame_count, outputs.data(), frame_count, frame_count);
+
+    for (const auto value : outputs)
+        REQUIRE(value == Approx(2.f));
+}
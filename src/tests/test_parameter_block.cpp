@@ -0,0 +1,124 @@
+
+#include <chrono>
+#include <stdexcept>
+
+#include <catch2/catch.hpp>
+
+#include <llvm/IR/LLVMContext.h>
+
+#include <DSPJIT/graph_execution_context_factory.h>
+#include <DSPJIT/common_nodes.h>
+
+using namespace llvm;
+using namespace DSPJIT;
+
+/**
+ *
+ *      Parameters
+ *
+ **/
+
+TEST_CASE("parameters : slots allocation")
+{
+    parameter_block parameters{2u};
+
+    const auto first = parameters.allocate(1.f);
+    const auto second = parameters.allocate(2.f);
+
+    REQUIRE(first != second);
+    REQUIRE(parameters.get(first) == 1.f);
+    REQUIRE(parameters.get(second) == 2.f);
+    REQUIRE_THROWS_AS(parameters.allocate(3.f), std::runtime_error);
+
+    parameters.release(first);
+    REQUIRE(parameters.allocate(4.f) == first);
+    REQUIRE(parameters.get(first) == 4.f);
+}
+
+TEST_CASE("parameters : values are changed without compiling the program")
+{
+    const auto engine_kind =
+        GENERATE(execution_engine_kind::llvm_legacy, execution_engine_kind::orc);
+
+    LLVMContext llvm_context;
+    graph_execution_context_options options{};
+    options.engine_kind = engine_kind;
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context, options);
+
+    compile_node_class in{0u, 1u}, out{1u, 0u};
+    parameter_node gain{context.get_parameter_block(), 2.f};
+    mul_node mul;
+
+    in.connect(mul, 0u);
+    gain.connect(mul, 1u);
+    mul.connect(out, 0u);
+
+    context.compile({in}, {out});
+    REQUIRE(context.update_program());
+
+    const float input[4] = {1.f, 2.f, 3.f, 4.f};
+    float output[4] = {0.f, 0.f, 0.f, 0.f};
+
+    context.process(input, output);
+    REQUIRE(output[0] == Approx(2.f));
+
+    gain.set_value(3.f);
+    REQUIRE(gain.get_value() == 3.f);
+
+    context.process_block(0u, input, output, 4u);
+    for (auto i = 0u; i < 4u; ++i)
+        REQUIRE(output[i] == Approx(3.f * input[i]));
+
+    REQUIRE_FALSE(context.get_parameter_block().promoted_value_changed());
+}
+
+TEST_CASE("parameters : unchanged values are promoted to constants")
+{
+    LLVMContext llvm_context;
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context);
+    auto& parameters = context.get_parameter_block();
+
+    //  out = in * (gain + offset) : the sum is folded once the parameters are constants
+    compile_node_class in{0u, 1u}, out{1u, 0u};
+    parameter_node gain{parameters, 2.f}, offset{parameters, 1.f};
+    add_node add;
+    mul_node mul;
+
+    gain.connect(add, 0u);
+    offset.connect(add, 1u);
+    in.connect(mul, 0u);
+    add.connect(mul, 1u);
+    mul.connect(out, 0u);
+
+    parameters.enable_promotion(std::chrono::hours{1});
+    auto report = context.compile({in}, {out});
+    REQUIRE(report.folded_node_count == 0u);
+    REQUIRE(context.update_program());
+
+    parameters.enable_promotion(std::chrono::steady_clock::duration::zero());
+    report = context.compile({in}, {out});
+    REQUIRE(report.folded_node_count == 1u);
+    REQUIRE(context.update_program());
+
+    const float input = 2.f;
+    float output = 0.f;
+
+    context.process(&input, &output);
+    REQUIRE(output == Approx(6.f));
+
+    //  The promoted value is used until the program is compiled again
+    gain.set_value(4.f);
+    REQUIRE(parameters.promoted_value_changed());
+
+    context.process(&input, &output);
+    REQUIRE(output == Approx(6.f));
+
+    context.compile({in}, {out});
+    REQUIRE(context.update_program());
+    REQUIRE_FALSE(parameters.promoted_value_changed());
+
+    context.process(&input, &output);
+    REQUIRE(output == Approx(10.f));
+}
@@ -0,0 +1,190 @@
+
+#include <chrono>
+#include <thread>
+
+#include <catch2/catch.hpp>
+
+#include <llvm/IR/LLVMContext.h>
+
+#include <DSPJIT/graph_execution_context_factory.h>
+#include <DSPJIT/common_nodes.h>
+
+using namespace llvm;
+using namespace DSPJIT;
+
+/**
+ *
+ *      Program Cache
+ *
+ **/
+
+/**
+ *  Two variants of a patch : a delayed constant (a) or another constant (b)
+ */
+class patch_variants {
+
+public:
+    patch_variants()
+    {
+        constant_a.connect(delay_a, 0u);
+    }
+
+    void select_a() { delay_a.connect(output, 0u); }
+    void select_b() { constant_b.connect(output, 0u); }
+
+    compile_node_class output{1u, 0u};
+    constant_node constant_a{1.f};
+    last_node delay_a;
+    constant_node constant_b{2.f};
+};
+
+static float process(graph_execution_context& context)
+{
+    float output = 0.f;
+    context.process(nullptr, &output);
+    return output;
+}
+
+TEST_CASE("program cache : switching back to a cached graph does not compile it")
+{
+    const auto engine_kind =
+        GENERATE(execution_engine_kind::llvm_legacy, execution_engine_kind::orc);
+
+    LLVMContext llvm_context;
+    graph_execution_context_options options{};
+    options.engine_kind = engine_kind;
+    options.relocatable_states = GENERATE(false, true);
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context, options);
+
+    context.enable_program_cache(4u);
+    REQUIRE(context.get_program_cache_capacity() == 4u);
+
+    patch_variants patch{};
+
+    patch.select_a();
+    REQUIRE_FALSE(context.compile({}, {patch.output}).program_cache_hit);
+    REQUIRE(context.update_program());
+    REQUIRE(process(context) == Approx(0.f));
+    REQUIRE(process(context) == Approx(1.f));
+
+    patch.select_b();
+    REQUIRE_FALSE(context.compile({}, {patch.output}).program_cache_hit);
+    REQUIRE(context.update_program());
+    REQUIRE(process(context) == Approx(2.f));
+
+    //  The cached program of a kept its delay state
+    for (auto i = 0u; i < 4u; ++i) {
+        patch.select_a();
+        const auto report_a = context.compile({}, {patch.output});
+        REQUIRE(report_a.program_cache_hit);
+        REQUIRE(context.update_program());
+        REQUIRE(process(context) == Approx(1.f));
+
+        patch.select_b();
+        const auto report_b = context.compile({}, {patch.output});
+        REQUIRE(report_b.program_cache_hit);
+        REQUIRE(report_b.seq > report_a.seq);
+        REQUIRE(context.update_program());
+        REQUIRE(process(context) == Approx(2.f));
+    }
+
+    //  A graph whose code changed is compiled
+    patch.constant_b.set_value(3.f);
+    REQUIRE_FALSE(context.compile({}, {patch.output}).program_cache_hit);
+    REQUIRE(context.update_program());
+    REQUIRE(process(context) == Approx(3.f));
+}
+
+/**
+ *  Poll the context until the optimized program is swapped in
+ */
+static bool wait_optimized_program(graph_execution_context& context)
+{
+    for (auto i = 0u; i < 1000u; ++i) {
+        if (context.update_program())
+            return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});
+    }
+
+    return false;
+}
+
+TEST_CASE("program cache : cached programs are optimized again with tiered compilation")
+{
+    LLVMContext llvm_context;
+    graph_execution_context_options options{};
+    options.tiered_compilation = true;
+    options.relocatable_states = GENERATE(false, true);
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context, options);
+
+    context.enable_program_cache(4u);
+
+    patch_variants patch{};
+
+    patch.select_a();
+    REQUIRE_FALSE(context.compile({}, {patch.output}).program_cache_hit);
+    REQUIRE(context.update_program());
+    REQUIRE(wait_optimized_program(context));
+    REQUIRE(process(context) == Approx(0.f));
+
+    patch.select_b();
+    REQUIRE_FALSE(context.compile({}, {patch.output}).program_cache_hit);
+    REQUIRE(context.update_program());
+    REQUIRE(wait_optimized_program(context));
+    REQUIRE(process(context) == Approx(2.f));
+
+    //  Each cache hit publishes the unoptimized program, which is then replaced by its optimized version
+    for (auto i = 0u; i < 3u; ++i) {
+        patch.select_a();
+        REQUIRE(context.compile({}, {patch.output}).program_cache_hit);
+        REQUIRE(context.update_program());
+        REQUIRE(wait_optimized_program(context));
+        REQUIRE(process(context) == Approx(1.f));
+
+        patch.select_b();
+        REQUIRE(context.compile({}, {patch.output}).program_cache_hit);
+        REQUIRE(context.update_program());
+        REQUIRE(wait_optimized_program(context));
+        REQUIRE(process(context) == Approx(2.f));
+    }
+
+    REQUIRE_FALSE(context.update_program());
+}
+
+TEST_CASE("program cache : least recently used programs are evicted")
+{
+    LLVMContext llvm_context;
+    graph_execution_context context =
+        graph_execution_context_factory::build(llvm_context);
+
+    context.enable_program_cache(1u);
+
+    patch_variants patch{};
+
+    patch.select_a();
+    context.compile({}, {patch.output});
+    REQUIRE(context.update_program());
+    REQUIRE(process(context) == Approx(0.f));
+    REQUIRE(process(context) == Approx(1.f));
+
+    //  The program of b replaces the program of a
+    patch.select_b();
+    context.compile({}, {patch.output});
+    REQUIRE(context.update_program());
+
+    patch.select_a();
+    REQUIRE_FALSE(context.compile({}, {patch.output}).program_cache_hit);
+    REQUIRE(context.update_program());
+
+    //  Disabling the cache deletes the cached programs
+    context.enable_program_cache(0u);
+    patch.select_b();
+    context.compile({}, {patch.output});
+    REQUIRE(context.update_program());
+
+    patch.select_a();
+    REQUIRE_FALSE(context.compile({}, {patch.output}).program_cache_hit);
+    REQUIRE(context.update_program());
+}